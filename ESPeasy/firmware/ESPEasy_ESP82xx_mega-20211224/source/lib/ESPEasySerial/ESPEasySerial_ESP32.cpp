@@ -291,6 +291,16 @@ int ESPeasySerial::available(void) {
   return getHW()->available();
 }
 
+int ESPeasySerial::availableForWrite(void) {
+  if (!isValid()) {
+    return 0;
+  }
+  if (isI2Cserial()) {
+    return -1;
+  }
+  return getHW()->availableForWrite();
+}
+
 void ESPeasySerial::flush(void) {
   if (!isValid()) {
     return;
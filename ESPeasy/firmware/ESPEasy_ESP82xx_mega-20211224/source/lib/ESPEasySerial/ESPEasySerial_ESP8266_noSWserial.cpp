@@ -141,6 +141,13 @@ int ESPeasySerial::available(void) {
   return getHW()->available();
 }
 
+int ESPeasySerial::availableForWrite(void) {
+  if (!isValid()) {
+    return 0;
+  }
+  return getHW()->availableForWrite();
+}
+
 void ESPeasySerial::flush(void) {
   if (!isValid()) {
     return;
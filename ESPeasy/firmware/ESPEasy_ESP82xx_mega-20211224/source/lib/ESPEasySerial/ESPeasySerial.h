@@ -265,6 +265,10 @@ public:
   int    available(void) override;
   void   flush(void) override;
 
+  // Number of bytes which can be written without blocking.
+  // Return -1 when not known (software serial and SC16IS752), a write may then block until sent.
+  int    availableForWrite(void);
+
 #if defined(ESP8266)
   bool   overflow();       // SoftwareSerial ESP8266
   bool   hasOverrun(void); // HardwareSerial ESP8266
@@ -313,6 +313,17 @@ int ESPeasySerial::available(void) {
   }
 }
 
+int ESPeasySerial::availableForWrite(void) {
+  if (!isValid()) {
+    return 0;
+  }
+
+  if (isSWserial() || isI2Cserial()) {
+    return -1;
+  }
+  return getHW()->availableForWrite();
+}
+
 void ESPeasySerial::flush(void) {
   if (!isValid()) {
     return;
@@ -44,14 +44,26 @@ void SDM::begin(void) {
 }
 
 float SDM::readVal(uint16_t reg, uint8_t node) {
+  float res = NAN;
+
+  readValues(reg, 1, &res, node);
+  return (res);
+}
+
+uint16_t SDM::readValues(uint16_t reg, uint8_t nrValues, float *values, uint8_t node) {
   uint16_t temp;
   unsigned long resptime;
-  uint8_t sdmarr[FRAMESIZE] = {node, SDM_B_02, 0, 0, SDM_B_05, SDM_B_06, 0, 0, 0};
-  float res = NAN;
+  const uint8_t replySize = 5 + 4 * nrValues;                                   //node, function code, byte count, values, crc
+  uint8_t sdmarr[5 + 4 * SDM_MAX_READ_VALUES] = {node, SDM_B_02, 0, 0, 0, 0, 0, 0, 0};
   uint16_t readErr = SDM_ERR_NO_ERROR;
 
+  if (nrValues == 0 || nrValues > SDM_MAX_READ_VALUES) {
+    return SDM_ERR_WRONG_BYTES;
+  }
+
   sdmarr[2] = highByte(reg);
   sdmarr[3] = lowByte(reg);
+  sdmarr[5] = 2 * nrValues;                                                     //number of registers, 2 per value
 
   temp = calculateCRC(sdmarr, FRAMESIZE - 3);                                   //calculate out crc only from first 6 bytes
 
@@ -80,7 +92,7 @@ float SDM::readVal(uint16_t reg, uint8_t node) {
 
   resptime = millis() + MAX_MILLIS_TO_WAIT;
 
-  while (sdmSer.available() < FRAMESIZE) {
+  while (sdmSer.available() < replySize) {
     if (resptime < millis()) {
       readErr = SDM_ERR_TIMEOUT;                                                //err debug (4)
       break;
@@ -90,19 +102,22 @@ float SDM::readVal(uint16_t reg, uint8_t node) {
 
   if (readErr == SDM_ERR_NO_ERROR) {                                            //if no timeout...
 
-    if(sdmSer.available() >= FRAMESIZE) {
+    if(sdmSer.available() >= replySize) {
 
-      for(int n=0; n<FRAMESIZE; n++) {
+      for(int n=0; n<replySize; n++) {
         sdmarr[n] = sdmSer.read();
       }
 
-      if (sdmarr[0] == node && sdmarr[1] == SDM_B_02 && sdmarr[2] == SDM_REPLY_BYTE_COUNT) {
+      if (sdmarr[0] == node && sdmarr[1] == SDM_B_02 && sdmarr[2] == SDM_REPLY_BYTE_COUNT * nrValues) {
 
-        if ((calculateCRC(sdmarr, FRAMESIZE - 2)) == ((sdmarr[8] << 8) | sdmarr[7])) {  //calculate crc from first 7 bytes and compare with received crc (bytes 7 & 8)
-          ((uint8_t*)&res)[3]= sdmarr[3];
-          ((uint8_t*)&res)[2]= sdmarr[4];
-          ((uint8_t*)&res)[1]= sdmarr[5];
-          ((uint8_t*)&res)[0]= sdmarr[6];
+        if ((calculateCRC(sdmarr, replySize - 2)) == ((sdmarr[replySize - 1] << 8) | sdmarr[replySize - 2])) {  //calculate crc and compare with received crc (last 2 bytes)
+          for (uint8_t i = 0; i < nrValues; i++) {
+            const uint8_t pos = 3 + 4 * i;
+            ((uint8_t*)&values[i])[3]= sdmarr[pos];
+            ((uint8_t*)&values[i])[2]= sdmarr[pos + 1];
+            ((uint8_t*)&values[i])[1]= sdmarr[pos + 2];
+            ((uint8_t*)&values[i])[0]= sdmarr[pos + 3];
+          }
         } else {
           readErr = SDM_ERR_CRC_ERROR;                                          //err debug (1)
         }
@@ -132,7 +147,7 @@ float SDM::readVal(uint16_t reg, uint8_t node) {
   sdmSer.end();                                                                 //disable softserial rx interrupt
 #endif
 
-  return (res);
+  return (readErr);
 }
 
 uint16_t SDM::getErrCode(bool _clear) {
@@ -41,6 +41,11 @@
 #ifndef MAX_MILLIS_TO_WAIT
   #define MAX_MILLIS_TO_WAIT                500                                 //default max time to wait for response from SDM
 #endif
+
+#ifndef SDM_MAX_READ_VALUES
+  #define SDM_MAX_READ_VALUES               14                                  //max number of float values read in one request (reply of 5 + 4 * 14 = 61 bytes)
+                                                                                //must fit in the 64 byte RX buffer of software serial
+#endif
 //------------------------------------------------------------------------------
 #define FRAMESIZE                           9                                   //size of out/in array
 #define SDM_REPLY_BYTE_COUNT                0x04                                //number of bytes with data
@@ -165,6 +170,8 @@ class SDM {
 
     void begin(void);
     float readVal(uint16_t reg, uint8_t node = SDM_B_01);                       //read value from register = reg and from deviceId = node
+    uint16_t readValues(uint16_t reg, uint8_t nrValues, float *values,
+                        uint8_t node = SDM_B_01);                               //read nrValues consecutive values starting at register = reg in one request, return errorcode (values not changed on error)
     uint16_t getErrCode(bool _clear = false);                                   //return last errorcode (optional clear this value, default false)
     uint16_t getErrCount(bool _clear = false);                                  //return total errors count (optional clear this value, default false)
     uint16_t getSuccCount(bool _clear = false);                                 //return total success count (optional clear this value, default false)
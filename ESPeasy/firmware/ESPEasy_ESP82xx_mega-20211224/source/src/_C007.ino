@@ -103,7 +103,7 @@ bool do_process_c007_delay_queue(int controller_number, const C007_queue_element
     url += F("field");
     url += element.idx + i;
     url += ':';
-    url += element.txt[i];
+    url += element.txt(i);
   }
   url += '}';
   url += F("&apikey=");
@@ -175,7 +175,7 @@ bool do_process_c009_delay_queue(int controller_number, const C009_queue_element
               jsonString += ',';
               jsonString += to_json_object_value(F("type"), String(static_cast<int>(element.sensorType)));
               jsonString += ',';
-              jsonString += to_json_object_value(F("value"), element.txt[x]);
+              jsonString += to_json_object_value(F("value"), element.txt(x));
             }
             jsonString += '}'; // End "sensor value N"
           }
@@ -255,7 +255,7 @@ boolean Create_schedule_HTTP_C011(struct EventStruct *event)
         log += element.postStr;
         addLog(LOG_LEVEL_ERROR, log);
       }
-      C011_DelayHandler->sendQueue.pop_back();
+      C011_DelayHandler->removeBack();
       return false;
     }
 
@@ -9,6 +9,8 @@
    This is a cache layer to collect data while not connected to a network.
    The data will first be stored in RTC memory, which will survive a crash/reboot and even an OTA update.
    If this RTC buffer is full, it will be flushed to whatever is set here as storage.
+   The flushed samples are written in the background, in small steps.
+   They are kept in the RTC buffer until written, so they also survive a crash or a failed write.
 
    Typical sample sets contain:
    - UNIX timestamp
@@ -136,6 +138,9 @@ bool CPlugin_016(CPlugin::Function function, struct EventStruct *event, String&
     case CPlugin::Function::CPLUGIN_FLUSH:
     {
       process_c016_delay_queue();
+
+      // Samples in the RTC buffer survive a reboot or deep sleep, so only finish a running write.
+      ControllerCache.finishPendingWrite();
       delay(0);
       break;
     }
@@ -113,6 +113,7 @@ boolean Plugin_020(uint8_t function, struct EventStruct *event, String& string)
         addFormSelector(F("Event processing"), F("p020_events"), 3, options, NULL, choice);
       }
       addFormNumericBox(F("RX Receive Timeout (mSec)"), F("p020_rxwait"), P020_RX_WAIT, 0, 20);
+      addFormNote(F("Received data is sent when no more data is received within this time, or when the buffer is half full"));
       addFormPinSelect(F("Reset target after init"), F("p020_resetpin"), P020_RESET_TARGET_PIN);
 
       addFormNumericBox(F("RX buffer size (bytes)"), F("p020_rx_buffer"), P020_RX_BUFFER, 256, 1024);
@@ -192,6 +193,7 @@ boolean Plugin_020(uint8_t function, struct EventStruct *event, String& string)
       // serial0 on esp32 is Ser2net: port=2 rxPin=3 txPin=1; serial1 on esp32 is Ser2net: port=4 rxPin=13 txPin=15; Serial2 on esp32 is
       // Ser2net: port=4 rxPin=16 txPin=17
       uint8_t serialconfig = serialHelper_convertOldSerialConfig(P020_SERIAL_CONFIG);
+      task->setRxBufferSize(P020_RX_BUFFER);
       task->serialBegin(port, rxPin, txPin, P020_BAUDRATE, serialconfig);
       task->startServer(P020_SERVER_PORT);
 
@@ -264,6 +266,7 @@ boolean Plugin_020(uint8_t function, struct EventStruct *event, String& string)
 
       if (task->hasClientConnected()) {
         task->handleSerialIn(event);
+        task->writeNetBuffer();
       } else {
         task->discardSerialIn();
 
@@ -272,6 +275,22 @@ boolean Plugin_020(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_TIMER_IN:
+    {
+      // Scheduled by writeNetBuffer() when the data from the client did not fit in the UART.
+      P020_Task *task = static_cast<P020_Task *>(getPluginTaskData(event->TaskIndex));
+
+      if (nullptr == task) {
+        break;
+      }
+
+      if (task->hasClientConnected()) {
+        task->handleClientIn(event);
+      }
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE:
     {
       String command  = parseString(string, 1);
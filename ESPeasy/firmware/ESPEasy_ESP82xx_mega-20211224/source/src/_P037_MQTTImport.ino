@@ -9,6 +9,7 @@
 
 // This task reads data from the MQTT Import input stream and saves the value
 
+#include "src/Globals/Cache.h"
 #include "src/Globals/EventQueue.h"
 #include "src/Globals/MQTT.h"
 #include "src/Globals/CPlugins.h"
@@ -107,6 +108,7 @@ boolean Plugin_037(uint8_t function, struct EventStruct *event, String& string)
         //    In order to resubscribe we have to disconnect and reconnect in order to get rid of any obsolete subscriptions
         if (MQTTclient_connected) {
           //		Subscribe to ALL the topics from ALL instance of this import module
+          Cache.mqttImportTopics.clear();
           MQTTSubscribe_037(event);
           success = true;
         }
@@ -133,6 +135,8 @@ boolean Plugin_037(uint8_t function, struct EventStruct *event, String& string)
         }
 
         if (currentConnectedState) {
+          // System variables in the subscriptions may have changed.
+          Cache.mqttImportTopics.clear();
           success = MQTTSubscribe_037(event);
         }
         break;
@@ -144,21 +148,13 @@ boolean Plugin_037(uint8_t function, struct EventStruct *event, String& string)
         //   Topic:   event->String1;
         //   Payload: event->String2;
 
-        // Get the Topic and see if it matches any of the subscriptions
-        char deviceTemplate[VARS_PER_TASK][41];		// variable for saving the subscription topics
-
-        LoadTaskSettings(event->TaskIndex);
-        LoadCustomTaskSettings(event->TaskIndex, (uint8_t*)&deviceTemplate, sizeof(deviceTemplate));
+        // The topic is already matched against the subscriptions of all MQTT import tasks.
+        // The event is shared by all matching tasks, so do not change it.
+        const uint8_t varMask = getMQTTimportVarMask(event);
 
         for (uint8_t x = 0; x < VARS_PER_TASK; x++)
         {
-          String subscriptionTopic = deviceTemplate[x];
-          subscriptionTopic.trim();
-          if (subscriptionTopic.isEmpty()) continue;							// skip blank subscriptions
-
-          // Now check if the incoming topic matches one of our subscriptions
-          parseSystemVariables(subscriptionTopic, false);
-          if (MQTTCheckSubscription_037(event->String1, subscriptionTopic))
+          if (bitRead(varMask, x))
           {
             // FIXME TD-er: It may be useful to generate events with string values.
             float floatPayload;
@@ -257,71 +253,4 @@ bool MQTTSubscribe_037(struct EventStruct *event)
   return true;
 }
 
-//
-// Check to see if Topic matches the MQTT subscription
-//
-bool MQTTCheckSubscription_037(const String& Topic, const String& Subscription) {
-  if (Topic.isEmpty() || Subscription.isEmpty())  {
-    return false;
-  }
-
-  String tmpTopic = Topic;
-  String tmpSub = Subscription;
-
-  tmpTopic.trim();
-  tmpSub.trim();
-
-  // Get rid of leading '/'
-  if (tmpTopic[0] == '/') { tmpTopic = tmpTopic.substring(1); }
-  if (tmpSub[0] == '/') { tmpSub = tmpSub.substring(1); }
-
-  // Add trailing / if required
-
-  int lenTopic = tmpTopic.length();
-  if (tmpTopic.substring(lenTopic - 1, lenTopic) != "/")tmpTopic += '/';
-
-  int lenSub = tmpSub.length();
-  if (tmpSub.substring(lenSub - 1, lenSub) != "/")tmpSub += '/';
-
-  // Now get first part
-
-  int SlashTopic;
-  int SlashSub;
-  int count = 0;
-
-  String pTopic;
-  String pSub;
-
-  while (count < 10) {
-
-    //  Get locations of the first /
-
-    SlashTopic = tmpTopic.indexOf('/');
-    SlashSub = tmpSub.indexOf('/');
-
-    //  If no slashes found then match is OK
-    //  If only one slash found then not OK
-
-    if ((SlashTopic == -1) && (SlashSub == -1)) return true;
-    if ((SlashTopic == -1) && (SlashSub != -1)) return false;
-    if ((SlashTopic != -1) && (SlashSub == -1)) return false;
-
-    //  Get the values for the current subtopic
-
-    pTopic = tmpTopic.substring(0, SlashTopic);
-    pSub = tmpSub.substring(0, SlashSub);
-
-    //  And strip the subtopic from the topic
-
-    tmpTopic = tmpTopic.substring(SlashTopic + 1);
-    tmpSub = tmpSub.substring(SlashSub + 1);
-
-    //  If the subtopics match then OK - otherwise fail
-    if (pSub == "#")  return true;
-    if ((pTopic != pSub) && (pSub != "+"))return false;
-
-    count = count + 1;
-  }
-  return false;
-}
 #endif // USES_P037
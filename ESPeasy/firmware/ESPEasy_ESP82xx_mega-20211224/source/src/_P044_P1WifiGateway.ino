@@ -18,11 +18,14 @@
 #define PLUGIN_044
 #define PLUGIN_ID_044         44
 #define PLUGIN_NAME_044       "Communication - P1 Wifi Gateway"
+#define PLUGIN_VALUENAME1_044 "Power"
+#define PLUGIN_VALUENAME2_044 "Tariff1"
+#define PLUGIN_VALUENAME3_044 "Tariff2"
+#define PLUGIN_VALUENAME4_044 "Gas"
 
 
 #define P044_WIFI_SERVER_PORT     ExtraTaskSettings.TaskDevicePluginConfigLong[0]
 #define P044_BAUDRATE             ExtraTaskSettings.TaskDevicePluginConfigLong[1]
-#define P044_RX_WAIT              PCONFIG(0)
 #define P044_SERIAL_CONFIG        PCONFIG(1)
 #define P044_RESET_TARGET_PIN     CONFIG_PIN1
  
@@ -39,8 +42,21 @@ boolean Plugin_044(uint8_t function, struct EventStruct *event, String& string)
       {
         Device[++deviceCount].Number = PLUGIN_ID_044;
         Device[deviceCount].Type = DEVICE_TYPE_SINGLE;
+        Device[deviceCount].VType = Sensor_VType::SENSOR_TYPE_QUAD;
         Device[deviceCount].Custom = true;
-        Device[deviceCount].TimerOption = false;
+        Device[deviceCount].ValueCount = P044_NR_OUTPUT_VALUES;
+        Device[deviceCount].SendDataOption = true;
+        Device[deviceCount].TimerOption = true;
+        Device[deviceCount].TimerOptional = true;
+        break;
+      }
+
+    case PLUGIN_GET_DEVICEVALUENAMES:
+      {
+        strcpy_P(ExtraTaskSettings.TaskDeviceValueNames[P044_VALUE_POWER], PSTR(PLUGIN_VALUENAME1_044));
+        strcpy_P(ExtraTaskSettings.TaskDeviceValueNames[P044_VALUE_TARIFF1], PSTR(PLUGIN_VALUENAME2_044));
+        strcpy_P(ExtraTaskSettings.TaskDeviceValueNames[P044_VALUE_TARIFF2], PSTR(PLUGIN_VALUENAME3_044));
+        strcpy_P(ExtraTaskSettings.TaskDeviceValueNames[P044_VALUE_GAS], PSTR(PLUGIN_VALUENAME4_044));
         break;
       }
 
@@ -62,7 +78,7 @@ boolean Plugin_044(uint8_t function, struct EventStruct *event, String& string)
         // FIXME TD-er: Why isn't this using the normal pin selection functions?
       	addFormPinSelect(F("Reset target after boot"), F("taskdevicepin1"), P044_RESET_TARGET_PIN);
 
-      	addFormNumericBox(F("RX Receive Timeout (mSec)"), F("p044_rxwait"), P044_RX_WAIT, 0);
+        addFormNote(F("Values: Power = delivered - returned (kW), Tariff1/2 = delivered (kWh), Gas (m3)"));
 
         success = true;
         break;
@@ -73,7 +89,6 @@ boolean Plugin_044(uint8_t function, struct EventStruct *event, String& string)
         LoadTaskSettings(event->TaskIndex);
         P044_WIFI_SERVER_PORT = getFormItemInt(F("p044_port"));
         P044_BAUDRATE = getFormItemInt(F("p044_baud"));
-        P044_RX_WAIT = getFormItemInt(F("p044_rxwait"));
         P044_SERIAL_CONFIG = serialHelper_serialconfig_webformSave();
 
         success = true;
@@ -179,15 +194,25 @@ boolean Plugin_044(uint8_t function, struct EventStruct *event, String& string)
         if (nullptr == task) {
           break;
         }
-        if (task->hasClientConnected()) {
-          task->handleSerialIn(event);
-        } else {
-          task->discardSerialIn();
-        }
+        // Also parse the telegrams when no client is connected, to update the task values.
+        task->handleSerialIn(event);
         success = true;
         break;
       }
 
+    case PLUGIN_READ:
+      {
+        P044_Task *task = static_cast<P044_Task *>(getPluginTaskData(event->TaskIndex));
+        if (nullptr == task) {
+          break;
+        }
+        // Values are updated when a valid telegram is received.
+        // Only send them when a new telegram arrived since the last read.
+        success                  = task->newValuesSinceRead;
+        task->newValuesSinceRead = false;
+        break;
+      }
+
   }
   return success;
 }
@@ -42,6 +42,7 @@
 
 #include <ESPeasySerial.h>
 #include <SDM.h>    // Requires SDM library from Reaper7 - https://github.com/reaper7/SDM_Energy_Meter/
+#include "src/PluginStructs/P078_data_struct.h"
 
 // These pointers may be used among multiple instances of the same plugin,
 // as long as the same serial settings are used.
@@ -49,11 +50,15 @@ ESPeasySerial* Plugin_078_SoftSerial = NULL;
 SDM* Plugin_078_SDM = NULL;
 boolean Plugin_078_init = false;
 
+// Values read in one batch for all P078 tasks of the same meter.
+P078_meter_cache Plugin_078_cache;
+
 
 // Forward declaration helper functions
 const __FlashStringHelper * p078_getQueryString(uint8_t query);
 const __FlashStringHelper * p078_getQueryValueString(uint8_t query);
 unsigned int p078_getRegister(uint8_t query, uint8_t model);
+void p078_addTaskRegisters(taskIndex_t taskIndex, std::vector<uint16_t>& registers);
 float p078_readVal(uint8_t query, uint8_t node, unsigned int model);
 
 
@@ -217,6 +222,7 @@ boolean Plugin_078(uint8_t function, struct EventStruct *event, String& string)
 
     case PLUGIN_INIT:
       {
+        Plugin_078_cache.clear();
         if (Plugin_078_SoftSerial != NULL) {
           delete Plugin_078_SoftSerial;
           Plugin_078_SoftSerial=NULL;
@@ -244,6 +250,7 @@ boolean Plugin_078(uint8_t function, struct EventStruct *event, String& string)
     case PLUGIN_EXIT:
     {
       Plugin_078_init = false;
+      Plugin_078_cache.clear();
       if (Plugin_078_SoftSerial != NULL) {
         delete Plugin_078_SoftSerial;
         Plugin_078_SoftSerial=NULL;
@@ -261,6 +268,22 @@ boolean Plugin_078(uint8_t function, struct EventStruct *event, String& string)
         {
           int model = P078_MODEL;
           uint8_t dev_id = P078_DEV_ID;
+
+          // Read the values of all tasks of this meter in as few requests as possible.
+          // Other tasks of the same meter then use the cached values.
+          std::vector<uint16_t> registers;
+          for (taskIndex_t task = 0; task < TASKS_MAX; ++task) {
+            if (task == event->TaskIndex ||
+                (Settings.TaskDeviceEnabled[task] &&
+                 Settings.TaskDeviceNumber[task] == PLUGIN_ID_078 &&
+                 Settings.TaskDevicePluginConfig[task][0] == dev_id &&
+                 Settings.TaskDevicePluginConfig[task][1] == model)) {
+              p078_addTaskRegisters(task, registers);
+            }
+          }
+          if (Plugin_078_SDM != nullptr) {
+            Plugin_078_cache.update(*Plugin_078_SDM, dev_id, registers);
+          }
           UserVar[event->BaseVarIndex]     = p078_readVal(P078_QUERY1, dev_id, model);
           UserVar[event->BaseVarIndex + 1] = p078_readVal(P078_QUERY2, dev_id, model);
           UserVar[event->BaseVarIndex + 2] = p078_readVal(P078_QUERY3, dev_id, model);
@@ -274,19 +297,20 @@ boolean Plugin_078(uint8_t function, struct EventStruct *event, String& string)
   return success;
 }
 
+void p078_addTaskRegisters(taskIndex_t taskIndex, std::vector<uint16_t>& registers) {
+  const uint8_t model = Settings.TaskDevicePluginConfig[taskIndex][1];
+  for (uint8_t i = 0; i < P078_NR_OUTPUT_VALUES; ++i) {
+    const uint8_t query = Settings.TaskDevicePluginConfig[taskIndex][i + P078_QUERY1_CONFIG_POS];
+    registers.push_back(p078_getRegister(query, model));
+  }
+}
+
 float p078_readVal(uint8_t query, uint8_t node, unsigned int model) {
   if (Plugin_078_SDM == NULL) return 0.0f;
 
-  uint8_t retry_count = 3;
-  bool success = false;
   float _tempvar = NAN;
-  while (retry_count > 0 && !success) {
-    Plugin_078_SDM->clearErrCode();
-    _tempvar = Plugin_078_SDM->readVal(p078_getRegister(query, model), node);
-    --retry_count;
-    if (Plugin_078_SDM->getErrCode() == SDM_ERR_NO_ERROR) {
-      success = true;
-    }
+  if (!Plugin_078_cache.get(node, p078_getRegister(query, model), _tempvar)) {
+    _tempvar = NAN;
   }
   if (loglevelActiveFor(LOG_LEVEL_INFO)) {
     String log = F("EASTRON: (");
@@ -62,6 +62,9 @@
 
 // Forward declaration of functions:
 const __FlashStringHelper * Plugin_085_valuename(uint8_t value_nr, bool displayString);
+void p085_modbusCallback(const ModbusRTU_transaction& transaction, uint8_t errorcode, const uint8_t *data, uint8_t length);
+uint16_t p085_getRegister(uint8_t query);
+float p085_convertValue(uint8_t query, uint32_t raw);
 
 
 struct P085_data_struct : public PluginTaskData_base {
@@ -84,7 +87,64 @@ struct P085_data_struct : public PluginTaskData_base {
     return modbus.isInitialized();
   }
 
+  // Queue reading all selected values, the values are collected in loop()
+  void startReading(struct EventStruct *event) {
+    if (nrPendingReads != 0) {
+      return;
+    }
+    ModbusRTU_transaction transaction;
+
+    transaction.callback     = p085_modbusCallback;
+    transaction.taskIndex    = event->TaskIndex;
+    transaction.slaveAddress = modbusAddress;
+    transaction.functionCode = MODBUS_READ_HOLDING_REGISTERS;
+    transaction.parameter    = 2; // All values are 32 bit
+
+    for (uint8_t i = 0; i < P085_NR_OUTPUT_VALUES; ++i) {
+      queries[i]               = PCONFIG(i + P085_QUERY1_CONFIG_POS);
+      transaction.index        = i;
+      transaction.startAddress = p085_getRegister(queries[i]);
+
+      // Cleared by the callback when the value is read.
+      readFailed[i] = true;
+
+      if (modbus.addTransaction(transaction)) {
+        ++nrPendingReads;
+      }
+    }
+  }
+
+  // Return true when all values were read in the last reading.
+  bool allValuesRead() const {
+    for (uint8_t i = 0; i < P085_NR_OUTPUT_VALUES; ++i) {
+      if (readFailed[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Return true when all values are read.
+  bool loop() {
+    if (nrPendingReads == 0) {
+      return false;
+    }
+    modbus.loop();
+
+    if (nrPendingReads == 0) {
+      newValues = true;
+      return true;
+    }
+    return false;
+  }
+
   ModbusRTU_struct modbus;
+  float            values[P085_NR_OUTPUT_VALUES] = { 0 };
+  uint8_t          queries[P085_NR_OUTPUT_VALUES] = { 0 };
+  bool             readFailed[P085_NR_OUTPUT_VALUES] = { 0 };
+  uint8_t          modbusAddress  = P085_DEV_ID_DFLT;
+  uint8_t          nrPendingReads = 0;
+  bool             newValues      = false;
 };
 
 unsigned int _plugin_085_last_measurement = 0;
@@ -335,6 +395,8 @@ boolean Plugin_085(uint8_t function, struct EventStruct *event, String& string)
         return success;
       }
 
+      P085_data->modbusAddress = P085_DEV_ID;
+
       if (P085_data->init(port, serial_rx, serial_tx, P085_DEPIN,
                           p085_storageValueToBaudrate(P085_BAUDRATE),
                           P085_DEV_ID)) {
@@ -347,21 +409,51 @@ boolean Plugin_085(uint8_t function, struct EventStruct *event, String& string)
     }
 
     case PLUGIN_EXIT: {
+      P085_data_struct *P085_data =
+        static_cast<P085_data_struct *>(getPluginTaskData(event->TaskIndex));
+
+      if (nullptr != P085_data) {
+        // Other tasks may still use the bus, do not call back for this task.
+        P085_data->modbus.removeTransactions(event->TaskIndex);
+      }
       success = true;
       break;
     }
 
-    case PLUGIN_READ: {
+    case PLUGIN_FIFTY_PER_SECOND: {
       P085_data_struct *P085_data =
         static_cast<P085_data_struct *>(getPluginTaskData(event->TaskIndex));
 
       if ((nullptr != P085_data) && P085_data->isInitialized()) {
-        for (int i = 0; i < P085_NR_OUTPUT_VALUES; ++i) {
-          UserVar[event->BaseVarIndex + i] = p085_readValue(PCONFIG(i + P085_QUERY1_CONFIG_POS), event);
-          delay(1);
+        if (P085_data->loop()) {
+          // All values read, schedule a read.
+          Scheduler.schedule_task_device_timer(event->TaskIndex, millis() + 10);
         }
+      }
+      break;
+    }
 
-        success = true;
+    case PLUGIN_READ: {
+      P085_data_struct *P085_data =
+        static_cast<P085_data_struct *>(getPluginTaskData(event->TaskIndex));
+
+      if ((nullptr != P085_data) && P085_data->isInitialized()) {
+        if (P085_data->newValues) {
+          P085_data->newValues = false;
+
+          // Do not send the values of a previous reading as new values.
+          if (P085_data->allValuesRead()) {
+            for (int i = 0; i < P085_NR_OUTPUT_VALUES; ++i) {
+              UserVar[event->BaseVarIndex + i] = P085_data->values[i];
+            }
+            success = true;
+          } else {
+            addLog(LOG_LEVEL_ERROR, F("AcuDC: Reading values failed"));
+          }
+        } else {
+          // Values are read in the background, PLUGIN_READ is called again when done.
+          P085_data->startReading(event);
+        }
       }
       break;
     }
@@ -428,40 +520,91 @@ int p085_storageValueToBaudrate(uint8_t baudrate_setting) {
   return 19200;
 }
 
+uint16_t p085_getRegister(uint8_t query) {
+  switch (query) {
+    case P085_QUERY_V:      return 0x200;
+    case P085_QUERY_A:      return 0x202;
+    case P085_QUERY_W:      return 0x204;
+    case P085_QUERY_Wh_imp: return 0x300;
+    case P085_QUERY_Wh_exp: return 0x302;
+    case P085_QUERY_Wh_tot: return 0x304;
+    case P085_QUERY_Wh_net: return 0x306;
+    case P085_QUERY_h_tot:  return 0x280;
+    case P085_QUERY_h_load: return 0x282;
+  }
+  return 0x200;
+}
+
+// Convert the 32 bit value read from 2 holding registers
+float p085_convertValue(uint8_t query, uint32_t raw) {
+  switch (query) {
+    case P085_QUERY_V:
+    case P085_QUERY_A:
+    case P085_QUERY_W:
+    {
+      union {
+        uint32_t ival;
+        float    fval;
+      } conversion;
+
+      conversion.ival = raw;
+
+      if (query == P085_QUERY_W) {
+        return conversion.fval * 1000.0f; // power (kW => W)
+      }
+      return conversion.fval;
+    }
+    case P085_QUERY_Wh_imp:
+    case P085_QUERY_Wh_exp:
+    case P085_QUERY_Wh_tot:
+      return raw * 10.0f; // 0.01 kWh => Wh
+    case P085_QUERY_Wh_net:
+    {
+      int64_t intvalue = raw;
+
+      if (intvalue >= 2147483648ll) {
+        intvalue = 4294967296ll - intvalue;
+      }
+      float value = static_cast<float>(intvalue);
+      value *= 10.0f; // 0.01 kWh => Wh
+      return value;
+    }
+    case P085_QUERY_h_tot:
+    case P085_QUERY_h_load:
+      return raw / 100.0f;
+  }
+  return 0.0f;
+}
+
+void p085_modbusCallback(const ModbusRTU_transaction& transaction, uint8_t errorcode, const uint8_t *data, uint8_t length) {
+  P085_data_struct *P085_data =
+    static_cast<P085_data_struct *>(getPluginTaskData(transaction.taskIndex));
+
+  if ((nullptr == P085_data) || (transaction.index >= P085_NR_OUTPUT_VALUES)) {
+    return;
+  }
+
+  if (P085_data->nrPendingReads > 0) {
+    --P085_data->nrPendingReads;
+  }
+
+  if ((errorcode == 0) && (length >= 4)) {
+    const uint32_t raw = (static_cast<uint32_t>(data[0]) << 24) |
+                         (static_cast<uint32_t>(data[1]) << 16) |
+                         (static_cast<uint32_t>(data[2]) << 8) |
+                         static_cast<uint32_t>(data[3]);
+    const uint8_t query = P085_data->queries[transaction.index];
+    P085_data->values[transaction.index]     = p085_convertValue(query, raw);
+    P085_data->readFailed[transaction.index] = false;
+  }
+}
+
 float p085_readValue(uint8_t query, struct EventStruct *event) {
   P085_data_struct *P085_data =
     static_cast<P085_data_struct *>(getPluginTaskData(event->TaskIndex));
 
   if ((nullptr != P085_data) && P085_data->isInitialized()) {
-    switch (query) {
-      case P085_QUERY_V:
-        return P085_data->modbus.read_float_HoldingRegister(0x200);
-      case P085_QUERY_A:
-        return P085_data->modbus.read_float_HoldingRegister(0x202);
-      case P085_QUERY_W:
-        return P085_data->modbus.read_float_HoldingRegister(0x204) * 1000.0f; // power (kW => W)
-      case P085_QUERY_Wh_imp:
-        return P085_data->modbus.read_32b_HoldingRegister(0x300) * 10.0f;     // 0.01 kWh => Wh
-      case P085_QUERY_Wh_exp:
-        return P085_data->modbus.read_32b_HoldingRegister(0x302) * 10.0f;     // 0.01 kWh => Wh
-      case P085_QUERY_Wh_tot:
-        return P085_data->modbus.read_32b_HoldingRegister(0x304) * 10.0f;     // 0.01 kWh => Wh
-      case P085_QUERY_Wh_net:
-      {
-        int64_t intvalue = P085_data->modbus.read_32b_HoldingRegister(0x306);
-
-        if (intvalue >= 2147483648ll) {
-          intvalue = 4294967296ll - intvalue;
-        }
-        float value = static_cast<float>(intvalue);
-        value *= 10.0f; // 0.01 kWh => Wh
-        return value;
-      }
-      case P085_QUERY_h_tot:
-        return P085_data->modbus.read_32b_HoldingRegister(0x280) / 100.0f;
-      case P085_QUERY_h_load:
-        return P085_data->modbus.read_32b_HoldingRegister(0x282) / 100.0f;
-    }
+    return p085_convertValue(query, P085_data->modbus.read_32b_HoldingRegister(p085_getRegister(query)));
   }
   return 0.0f;
 }
@@ -74,6 +74,10 @@ DF - Below doesn't look right; needs a RS485 to TTL(3.3v) level converter (see h
 
 // Forward declaration of functions
 const __FlashStringHelper * Plugin_108_valuename(uint8_t value_nr, bool displayString);
+void p108_modbusCallback(const ModbusRTU_transaction& transaction, uint8_t errorcode, const uint8_t *data, uint8_t length);
+uint16_t p108_getRegister(uint8_t query);
+uint8_t p108_getNrRegisters(uint8_t query);
+float p108_convertValue(uint8_t query, uint32_t raw);
 
 struct P108_data_struct : public PluginTaskData_base {
   P108_data_struct() {}
@@ -95,7 +99,64 @@ struct P108_data_struct : public PluginTaskData_base {
     return modbus.isInitialized();
   }
 
+  // Queue reading all selected values, the values are collected in loop()
+  void startReading(struct EventStruct *event) {
+    if (nrPendingReads != 0) {
+      return;
+    }
+    ModbusRTU_transaction transaction;
+
+    transaction.callback     = p108_modbusCallback;
+    transaction.taskIndex    = event->TaskIndex;
+    transaction.slaveAddress = modbusAddress;
+    transaction.functionCode = MODBUS_READ_HOLDING_REGISTERS;
+
+    for (uint8_t i = 0; i < P108_NR_OUTPUT_VALUES; ++i) {
+      queries[i]               = PCONFIG(i + P108_QUERY1_CONFIG_POS);
+      transaction.index        = i;
+      transaction.startAddress = p108_getRegister(queries[i]);
+      transaction.parameter    = p108_getNrRegisters(queries[i]);
+
+      // Cleared by the callback when the value is read.
+      readFailed[i] = true;
+
+      if (modbus.addTransaction(transaction)) {
+        ++nrPendingReads;
+      }
+    }
+  }
+
+  // Return true when all values are read.
+  bool loop() {
+    if (nrPendingReads == 0) {
+      return false;
+    }
+    modbus.loop();
+
+    if (nrPendingReads == 0) {
+      newValues = true;
+      return true;
+    }
+    return false;
+  }
+
+  // Return true when all values were read in the last reading.
+  bool allValuesRead() const {
+    for (uint8_t i = 0; i < P108_NR_OUTPUT_VALUES; ++i) {
+      if (readFailed[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   ModbusRTU_struct modbus;
+  float            values[P108_NR_OUTPUT_VALUES]     = { 0 };
+  uint8_t          queries[P108_NR_OUTPUT_VALUES]    = { 0 };
+  bool             readFailed[P108_NR_OUTPUT_VALUES] = { 0 };
+  uint8_t          modbusAddress  = P108_DEV_ID_DFLT;
+  uint8_t          nrPendingReads = 0;
+  bool             newValues      = false;
 };
 
 unsigned int _plugin_108_last_measurement = 0;
@@ -290,6 +351,8 @@ boolean Plugin_108(uint8_t function, struct EventStruct *event, String& string)
         return success;
       }
 
+      P108_data->modbusAddress = P108_DEV_ID;
+
       if (P108_data->init(port, serial_rx, serial_tx, P108_DEPIN,
                           p108_storageValueToBaudrate(P108_BAUDRATE),
                           P108_DEV_ID)) {
@@ -303,21 +366,51 @@ boolean Plugin_108(uint8_t function, struct EventStruct *event, String& string)
 
     case PLUGIN_EXIT: {
 //       clearPluginTaskData(event->TaskIndex); // DF - not present in P085
+      P108_data_struct *P108_data =
+        static_cast<P108_data_struct *>(getPluginTaskData(event->TaskIndex));
+
+      if (nullptr != P108_data) {
+        // Other tasks may still use the bus, do not call back for this task.
+        P108_data->modbus.removeTransactions(event->TaskIndex);
+      }
       success = true;
       break;
     }
 
-    case PLUGIN_READ: {
+    case PLUGIN_FIFTY_PER_SECOND: {
       P108_data_struct *P108_data =
         static_cast<P108_data_struct *>(getPluginTaskData(event->TaskIndex));
 
       if ((nullptr != P108_data) && P108_data->isInitialized()) {
-        for (int i = 0; i < P108_NR_OUTPUT_VALUES; ++i) {
-          UserVar[event->BaseVarIndex + i] = p108_readValue(PCONFIG(i + P108_QUERY1_CONFIG_POS), event);
-          delay(1);
+        if (P108_data->loop()) {
+          // All values read, schedule a read.
+          Scheduler.schedule_task_device_timer(event->TaskIndex, millis() + 10);
         }
+      }
+      break;
+    }
 
-        success = true;
+    case PLUGIN_READ: {
+      P108_data_struct *P108_data =
+        static_cast<P108_data_struct *>(getPluginTaskData(event->TaskIndex));
+
+      if ((nullptr != P108_data) && P108_data->isInitialized()) {
+        if (P108_data->newValues) {
+          P108_data->newValues = false;
+
+          // Do not send the values of a previous reading as new values.
+          if (P108_data->allValuesRead()) {
+            for (int i = 0; i < P108_NR_OUTPUT_VALUES; ++i) {
+              UserVar[event->BaseVarIndex + i] = P108_data->values[i];
+            }
+            success = true;
+          } else {
+            addLog(LOG_LEVEL_ERROR, F("DDS238: Reading values failed"));
+          }
+        } else {
+          // Values are read in the background, PLUGIN_READ is called again when done.
+          P108_data->startReading(event);
+        }
       }
       break;
     }
@@ -380,46 +473,96 @@ int p108_storageValueToBaudrate(uint8_t baudrate_setting) {
   return 9600;
 }
 
+uint16_t p108_getRegister(uint8_t query) {
+  switch (query) {
+    case P108_QUERY_V:      return 0x0C;
+    case P108_QUERY_A:      return 0x0D;
+    case P108_QUERY_W:      return 0x0E;
+    case P108_QUERY_VA:     return 0x0F;
+    case P108_QUERY_PF:     return 0x10;
+    case P108_QUERY_F:      return 0x11;
+    case P108_QUERY_Wh_imp: return 0x0A;
+    case P108_QUERY_Wh_exp: return 0x08;
+    case P108_QUERY_Wh_tot: return 0x00;
+  }
+  return 0x0C;
+}
+
+// Energy values are 32 bit, the other values 16 bit.
+uint8_t p108_getNrRegisters(uint8_t query) {
+  switch (query) {
+    case P108_QUERY_Wh_imp:
+    case P108_QUERY_Wh_exp:
+    case P108_QUERY_Wh_tot:
+      return 2;
+  }
+  return 1;
+}
+
+// Convert the value read from 1 or 2 holding registers
+float p108_convertValue(uint8_t query, uint32_t raw) {
+  float value = raw;
+
+  switch (query) {
+    case P108_QUERY_V:
+      return value / 10.0f;   // 0.1 V => V
+    case P108_QUERY_A:
+      return value / 100.0f;  // 0.01 A => A
+    case P108_QUERY_W:
+    case P108_QUERY_VA:
+      if (value > 32767) { value -= 65535; }
+      return value;
+    case P108_QUERY_PF:
+      return value / 1000.0f; // 0.001 Pf => Pf
+    case P108_QUERY_F:
+      return value / 100.0f;  // 0.01 Hz => Hz
+    case P108_QUERY_Wh_imp:
+    case P108_QUERY_Wh_exp:
+    case P108_QUERY_Wh_tot:
+      return value * 10.0f;   // 0.01 kWh => Wh
+  }
+  return 0.0f;
+}
+
+void p108_modbusCallback(const ModbusRTU_transaction& transaction, uint8_t errorcode, const uint8_t *data, uint8_t length) {
+  P108_data_struct *P108_data =
+    static_cast<P108_data_struct *>(getPluginTaskData(transaction.taskIndex));
+
+  if ((nullptr == P108_data) || (transaction.index >= P108_NR_OUTPUT_VALUES)) {
+    return;
+  }
+
+  if (P108_data->nrPendingReads > 0) {
+    --P108_data->nrPendingReads;
+  }
+
+  if ((errorcode == 0) && (length >= (2 * transaction.parameter))) {
+    uint32_t raw = 0;
+
+    for (uint8_t i = 0; i < (2 * transaction.parameter); ++i) {
+      raw = (raw << 8) | data[i];
+    }
+    const uint8_t query = P108_data->queries[transaction.index];
+    P108_data->values[transaction.index]     = p108_convertValue(query, raw);
+    P108_data->readFailed[transaction.index] = false;
+  }
+}
+
 float p108_readValue(uint8_t query, struct EventStruct *event) {
-  uint8_t errorcode     = -1; // DF - not present in P085
-  float value = 0.0f; // DF - not present in P085
   P108_data_struct *P108_data =
     static_cast<P108_data_struct *>(getPluginTaskData(event->TaskIndex));
 
   if ((nullptr != P108_data) && P108_data->isInitialized()) {
-    switch (query) {
-      case P108_QUERY_V:
-        value = P108_data->modbus.readHoldingRegister(0x0C ,errorcode) / 10.0f; // 0.1 V => V
-        break;
-      case P108_QUERY_A:
-        value = P108_data->modbus.readHoldingRegister(0x0D, errorcode) / 100.0f; // 0.01 A => A
-        break;
-      case P108_QUERY_W:
-        value =  P108_data->modbus.readHoldingRegister(0x0E, errorcode);
-        if (value > 32767) { value -= 65535; }
-        break;
-      case P108_QUERY_VA:
-        value = P108_data->modbus.readHoldingRegister(0x0F, errorcode);
-        if (value > 32767) { value -= 65535; }
-        break;
-      case P108_QUERY_PF:
-        value = P108_data->modbus.readHoldingRegister(0x10, errorcode) / 1000.0f; // 0.001 Pf => Pf
-        break;
-      case P108_QUERY_F:
-        value = P108_data->modbus.readHoldingRegister(0x11, errorcode) / 100.0f; // 0.01 Hz => Hz
-        break;
-      case P108_QUERY_Wh_imp:
-        return P108_data->modbus.read_32b_HoldingRegister(0x0A) * 10.0f;     // 0.01 kWh => Wh
-        break;
-      case P108_QUERY_Wh_exp:
-        return P108_data->modbus.read_32b_HoldingRegister(0x08) * 10.0f;     // 0.01 kWh => Wh
-        break;
-      case P108_QUERY_Wh_tot:
-        return P108_data->modbus.read_32b_HoldingRegister(0x00) * 10.0f;     // 0.01 kWh => Wh
-        break;
+    if (p108_getNrRegisters(query) == 2) {
+      return p108_convertValue(query, P108_data->modbus.read_32b_HoldingRegister(p108_getRegister(query)));
+    }
+    uint8_t errorcode = 0;
+    const int value   = P108_data->modbus.readHoldingRegister(p108_getRegister(query), errorcode);
+
+    if (errorcode == 0) {
+      return p108_convertValue(query, static_cast<uint16_t>(value));
     }
   }
-  if (errorcode == 0) return value; // DF - not present in P085
   return 0.0f;
 }
 
@@ -0,0 +1,595 @@
+#include "../ControllerQueue/C016_cache_codec.h"
+
+#ifdef USES_C016
+
+
+/*********************************************************************************************\
+* Bit stream helpers, most significant bit first
+\*********************************************************************************************/
+struct C016_bit_writer {
+  explicit C016_bit_writer(std::vector<uint8_t>& data) : _data(data) {}
+
+  void write(uint32_t value, uint8_t nrBits) {
+    while (nrBits > 0) {
+      --nrBits;
+
+      if (_bitPos == 0) {
+        _data.push_back(0);
+      }
+
+      if ((value >> nrBits) & 1) {
+        _data.back() |= (0x80 >> _bitPos);
+      }
+      _bitPos = (_bitPos + 1) & 7;
+    }
+  }
+
+  void writeBit(bool value) {
+    write(value ? 1 : 0, 1);
+  }
+
+private:
+
+  std::vector<uint8_t>& _data;
+  uint8_t               _bitPos = 0;
+};
+
+struct C016_bit_reader {
+  C016_bit_reader(const std::vector<uint8_t>& data, size_t& bitPos) : _data(data), _bitPos(bitPos) {}
+
+  bool read(uint32_t& value, uint8_t nrBits) {
+    if ((_bitPos + nrBits) > (_data.size() * 8)) {
+      return false;
+    }
+    value = 0;
+
+    while (nrBits > 0) {
+      --nrBits;
+      value = (value << 1) | ((_data[_bitPos >> 3] >> (7 - (_bitPos & 7))) & 1);
+      ++_bitPos;
+    }
+    return true;
+  }
+
+  bool readBit(bool& value) {
+    uint32_t tmp = 0;
+
+    if (!read(tmp, 1)) { return false; }
+    value = tmp != 0;
+    return true;
+  }
+
+private:
+
+  const std::vector<uint8_t>& _data;
+  size_t                    & _bitPos;
+};
+
+
+// Delta-of-delta ranges for the timestamp
+// '0'                : same delta as previous sample
+// '10'   +  7 bits   : -64   ... 63
+// '110'  +  9 bits   : -256  ... 255
+// '1110' + 12 bits   : -2048 ... 2047
+// '1111' + 32 bits   : absolute timestamp
+static const uint8_t C016_dod_bits[] = { 7, 9, 12 };
+
+
+static_assert(TASKS_MAX <= 32, "C016_cache_file_footer::taskMask too small for TASKS_MAX");
+
+
+/*********************************************************************************************\
+* C016_cache_filter
+\*********************************************************************************************/
+bool C016_cache_filter::isSet() const
+{
+  return from != 0 || to != 0xFFFFFFFF || taskMask != 0xFFFFFFFF;
+}
+
+bool C016_cache_filter::matches(uint32_t timestamp, taskIndex_t taskIndex) const
+{
+  return timestamp >= from && timestamp <= to && bitRead(taskMask, taskIndex);
+}
+
+bool C016_cache_filter::matchesRange(uint32_t minTimestamp, uint32_t maxTimestamp, uint32_t mask) const
+{
+  return maxTimestamp >= from && minTimestamp <= to && (mask & taskMask) != 0;
+}
+
+/*********************************************************************************************\
+* C016_cache_codec_state
+\*********************************************************************************************/
+void C016_cache_codec_state::reset()
+{
+  tasks.clear();
+  tasks.resize(TASKS_MAX);
+  timestamp = 0;
+  delta     = 0;
+  taskIndex = INVALID_TASK_INDEX;
+}
+
+/*********************************************************************************************\
+* Encode / decode a single sample
+\*********************************************************************************************/
+static void C016_encodeSample(C016_cache_codec_state& state, const C016_queue_element& element, C016_bit_writer& writer)
+{
+  // Task index
+  if (element.TaskIndex == state.taskIndex) {
+    writer.writeBit(false);
+  } else {
+    writer.writeBit(true);
+    writer.write(element.TaskIndex, 8);
+    state.taskIndex = element.TaskIndex;
+  }
+
+  C016_cache_codec_state::Task& task = state.tasks[element.TaskIndex];
+
+  // Sample description
+  if (task.known &&
+      (task.controller_idx == element.controller_idx) &&
+      (task.sensorType == element.sensorType) &&
+      (task.valueCount == element.valueCount)) {
+    writer.writeBit(false);
+  } else {
+    writer.writeBit(true);
+    writer.write(element.controller_idx,                    8);
+    writer.write(static_cast<uint8_t>(element.sensorType), 8);
+    writer.write(element.valueCount,                        8);
+    task.controller_idx = element.controller_idx;
+    task.sensorType     = element.sensorType;
+    task.valueCount     = element.valueCount;
+    task.known          = true;
+  }
+
+  // Timestamp
+  const uint32_t timestamp = element._timestamp;
+  const int64_t  delta     = static_cast<int64_t>(timestamp) - static_cast<int64_t>(state.timestamp);
+  const int64_t  dod       = delta - state.delta;
+
+  if (dod == 0) {
+    writer.writeBit(false);
+  } else {
+    bool done = false;
+
+    for (uint8_t i = 0; i < sizeof(C016_dod_bits) && !done; ++i) {
+      const int64_t limit = static_cast<int64_t>(1) << (C016_dod_bits[i] - 1);
+
+      if ((dod >= -limit) && (dod < limit)) {
+        // Prefix of i + 1 '1' bits followed by a '0'
+        writer.write((0xFF << 1) & ((1 << (i + 2)) - 1), i + 2);
+        writer.write(static_cast<uint32_t>(dod) & ((1u << C016_dod_bits[i]) - 1), C016_dod_bits[i]);
+        done = true;
+      }
+    }
+
+    if (!done) {
+      writer.write(0x0F,      4);
+      writer.write(timestamp, 32);
+    }
+  }
+  state.timestamp = timestamp;
+  state.delta     = delta;
+
+  // Values
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    C016_cache_codec_state::Column& column = task.columns[i];
+    uint32_t bits;
+    memcpy(&bits, &element.values[i], sizeof(bits));
+    const uint32_t xored = bits ^ column.bits;
+
+    if (xored == 0) {
+      writer.writeBit(false);
+    } else {
+      writer.writeBit(true);
+      uint8_t leading  = __builtin_clz(xored);
+      uint8_t trailing = __builtin_ctz(xored);
+
+      if (leading > 31) { leading = 31; }
+
+      if ((column.leading != 0xFF) &&
+          (leading >= column.leading) &&
+          (trailing >= (32 - column.leading - column.length))) {
+        // Fits in the window of the previous value
+        writer.writeBit(false);
+        writer.write(xored >> (32 - column.leading - column.length), column.length);
+      } else {
+        const uint8_t length = 32 - leading - trailing;
+        writer.writeBit(true);
+        writer.write(leading,    5);
+        writer.write(length - 1, 5);
+        writer.write(xored >> trailing, length);
+        column.leading = leading;
+        column.length  = length;
+      }
+    }
+    column.bits = bits;
+  }
+}
+
+static bool C016_decodeSample(C016_cache_codec_state& state, C016_queue_element& element, C016_bit_reader& reader)
+{
+  bool     flag  = false;
+  uint32_t value = 0;
+
+  // Task index
+  if (!reader.readBit(flag)) { return false; }
+
+  if (flag) {
+    if (!reader.read(value, 8)) { return false; }
+    state.taskIndex = value;
+  }
+
+  if (!validTaskIndex(state.taskIndex)) { return false; }
+  C016_cache_codec_state::Task& task = state.tasks[state.taskIndex];
+
+  // Sample description
+  if (!reader.readBit(flag)) { return false; }
+
+  if (flag) {
+    uint32_t controller_idx, sensorType, valueCount;
+
+    if (!reader.read(controller_idx, 8) ||
+        !reader.read(sensorType, 8) ||
+        !reader.read(valueCount, 8)) {
+      return false;
+    }
+    task.controller_idx = controller_idx;
+    task.sensorType     = static_cast<Sensor_VType>(sensorType);
+    task.valueCount     = valueCount;
+    task.known          = true;
+  }
+
+  if (!task.known) { return false; }
+
+  // Timestamp
+  uint32_t timestamp = 0;
+  uint8_t  prefix    = 0;
+
+  while (prefix < 4) {
+    if (!reader.readBit(flag)) { return false; }
+
+    if (!flag) { break; }
+    ++prefix;
+  }
+
+  if (prefix == 0) {
+    timestamp = state.timestamp + state.delta;
+  } else if (prefix < 4) {
+    const uint8_t nrBits = C016_dod_bits[prefix - 1];
+
+    if (!reader.read(value, nrBits)) { return false; }
+
+    // Sign extend
+    int64_t dod = value;
+
+    if (value & (1u << (nrBits - 1))) {
+      dod -= static_cast<int64_t>(1) << nrBits;
+    }
+    timestamp = state.timestamp + state.delta + dod;
+  } else {
+    if (!reader.read(timestamp, 32)) { return false; }
+  }
+  state.delta     = static_cast<int64_t>(timestamp) - static_cast<int64_t>(state.timestamp);
+  state.timestamp = timestamp;
+
+  // Values
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    C016_cache_codec_state::Column& column = task.columns[i];
+
+    if (!reader.readBit(flag)) { return false; }
+
+    if (flag) {
+      if (!reader.readBit(flag)) { return false; }
+
+      if (flag) {
+        uint32_t leading, length;
+
+        if (!reader.read(leading, 5) || !reader.read(length, 5)) { return false; }
+        column.leading = leading;
+        column.length  = length + 1;
+
+        if ((column.leading + column.length) > 32) { return false; }
+      } else if (column.leading == 0xFF) {
+        return false;
+      }
+
+      if (!reader.read(value, column.length)) { return false; }
+      column.bits ^= value << (32 - column.leading - column.length);
+    }
+    memcpy(&element.values[i], &column.bits, sizeof(column.bits));
+  }
+
+  element._timestamp     = timestamp;
+  element.TaskIndex      = state.taskIndex;
+  element.controller_idx = task.controller_idx;
+  element.sensorType     = task.sensorType;
+  element.valueCount     = task.valueCount;
+  return true;
+}
+
+/*********************************************************************************************\
+* C016_cache_encoder
+\*********************************************************************************************/
+void C016_cache_encoder::reset()
+{
+  _keyframe = true;
+}
+
+void C016_cache_encoder::startFile(bool emptyFile)
+{
+  reset();
+  _minTimestamp   = 0xFFFFFFFF;
+  _maxTimestamp   = 0;
+  _taskMask       = 0;
+  _fileStatsValid = emptyFile;
+}
+
+bool C016_cache_encoder::encode(const uint8_t *data, size_t size, std::vector<uint8_t>& block)
+{
+  const size_t nrElements = size / sizeof(C016_queue_element);
+
+  if (nrElements == 0) {
+    return false;
+  }
+
+  C016_cache_block_header header;
+  const size_t headerPos = block.size();
+
+  block.resize(headerPos + sizeof(header));
+
+  C016_bit_writer writer(block);
+
+  for (size_t i = 0; i < nrElements && header.count < 0xFF; ++i) {
+    C016_queue_element element;
+    memcpy(reinterpret_cast<uint8_t *>(&element), data + (i * sizeof(C016_queue_element)), sizeof(C016_queue_element));
+
+    if (validTaskIndex(element.TaskIndex)) {
+      const uint32_t timestamp = element._timestamp;
+
+      if (header.count == 0) {
+        if (_keyframe || (_blocksSinceKeyframe >= C016_CACHE_KEYFRAME_INTERVAL)) {
+          _state.reset();
+          _state.timestamp = timestamp;
+          bitSet(header.flags, C016_CACHE_BLOCK_KEYFRAME);
+          _keyframe            = false;
+          _blocksSinceKeyframe = 0;
+        }
+        header.firstTimestamp = timestamp;
+      } else if (timestamp < header.lastTimestamp) {
+        bitSet(header.flags, C016_CACHE_BLOCK_UNORDERED);
+      }
+      C016_encodeSample(_state, element, writer);
+      header.lastTimestamp = timestamp;
+      ++header.count;
+
+      if (timestamp < _minTimestamp) { _minTimestamp = timestamp; }
+
+      if (timestamp > _maxTimestamp) { _maxTimestamp = timestamp; }
+      bitSet(_taskMask, element.TaskIndex);
+    }
+  }
+
+  if (header.count == 0) {
+    block.resize(headerPos);
+    return false;
+  }
+  header.size = block.size() - headerPos - sizeof(header);
+  memcpy(&block[headerPos], &header, sizeof(header));
+  ++_blocksSinceKeyframe;
+  return true;
+}
+
+bool C016_cache_encoder::encodeFooter(std::vector<uint8_t>& block) const
+{
+  if (!_fileStatsValid || (_taskMask == 0)) {
+    return false;
+  }
+  C016_cache_block_header header;
+  C016_cache_file_footer  footer;
+
+  header.size           = sizeof(footer);
+  header.firstTimestamp = _minTimestamp;
+  header.lastTimestamp  = _maxTimestamp;
+  bitSet(header.flags, C016_CACHE_BLOCK_FOOTER);
+  footer.taskMask = _taskMask;
+
+  const size_t pos = block.size();
+
+  block.resize(pos + sizeof(header) + sizeof(footer));
+  memcpy(&block[pos],                  &header, sizeof(header));
+  memcpy(&block[pos + sizeof(header)], &footer, sizeof(footer));
+  return true;
+}
+
+void C016_cache_encoder::writeFileHeader(fs::File& file)
+{
+  C016_cache_file_header header;
+
+  file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+}
+
+/*********************************************************************************************\
+* C016_cache_decoder
+\*********************************************************************************************/
+void C016_cache_decoder::reset()
+{
+  _state.reset();
+  _block.clear();
+  _bitPos      = 0;
+  _keyframePos = 0;
+  _replayEnd   = 0;
+  _remaining   = 0;
+  _started     = false;
+  _legacy      = false;
+  _inSync      = true;
+  _replaying   = false;
+}
+
+void C016_cache_decoder::setFilter(const C016_cache_filter& filter)
+{
+  _filter = filter;
+}
+
+bool C016_cache_decoder::read(fs::File& file, C016_queue_element& element)
+{
+  if (!_started) {
+    _started = true;
+    _legacy  = !hasFileHeader(file);
+
+    if (!_legacy) {
+      if (!fileMayMatch(file)) {
+        file.seek(0, fs::SeekEnd);
+        return false;
+      }
+      file.seek(sizeof(C016_cache_file_header));
+    }
+  }
+
+  while (true) {
+    if (_legacy) {
+      if (file.read(reinterpret_cast<uint8_t *>(&element), sizeof(element)) != sizeof(element)) {
+        return false;
+      }
+    } else {
+      while (_remaining == 0) {
+        if (!readBlock(file)) {
+          return false;
+        }
+      }
+      C016_bit_reader reader(_block, _bitPos);
+
+      if (!C016_decodeSample(_state, element, reader)) {
+        // Corrupt block, no further samples can be decoded from this file.
+        _remaining = 0;
+        _block.clear();
+        file.seek(0, fs::SeekEnd);
+        return false;
+      }
+      --_remaining;
+    }
+
+    if (!_replaying && _filter.matches(element._timestamp, element.TaskIndex)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool C016_cache_decoder::hasFileHeader(fs::File& file)
+{
+  C016_cache_file_header header;
+  const size_t pos = file.position();
+
+  file.seek(0);
+  const bool res = (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header)) &&
+                   (header.magic == C016_CACHE_FILE_MAGIC) &&
+                   (header.version == C016_CACHE_FILE_VERSION);
+
+  file.seek(pos);
+  return res;
+}
+
+bool C016_cache_decoder::readBlock(fs::File& file)
+{
+  while (true) {
+    C016_cache_block_header header;
+    const size_t pos = file.position();
+
+    if (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header)) {
+      return false;
+    }
+    const size_t nextPos  = pos + sizeof(header) + header.size;
+    const bool   keyframe = bitRead(header.flags, C016_CACHE_BLOCK_KEYFRAME);
+
+    if (nextPos > file.size()) {
+      // Incomplete block
+      return false;
+    }
+
+    if (bitRead(header.flags, C016_CACHE_BLOCK_FOOTER)) {
+      file.seek(nextPos);
+      continue;
+    }
+
+    if (keyframe) {
+      _keyframePos = pos;
+    }
+
+    if ((pos >= _replayEnd) && !blockMayMatch(header)) {
+      // Skip without decoding, the decoder state is no longer valid until the next key frame.
+      file.seek(nextPos);
+      _inSync = false;
+      continue;
+    }
+
+    if (!_inSync && !keyframe) {
+      if (_keyframePos == 0) {
+        // Should not happen, the first block in a file is a key frame.
+        return false;
+      }
+
+      // Restore the decoder state by decoding all blocks since the last key frame.
+      _replayEnd = pos;
+      _inSync    = true;
+      file.seek(_keyframePos);
+      continue;
+    }
+
+    if (keyframe) {
+      _state.reset();
+      _state.timestamp = header.firstTimestamp;
+    }
+    _block.resize(header.size);
+
+    if ((header.size > 0) && (file.read(&_block[0], header.size) != header.size)) {
+      // Incomplete block
+      _block.clear();
+      return false;
+    }
+    _inSync    = true;
+    _replaying = pos < _replayEnd;
+    _bitPos    = 0;
+    _remaining = header.count;
+    return true;
+  }
+  return false;
+}
+
+bool C016_cache_decoder::blockMayMatch(const C016_cache_block_header& header) const
+{
+  if (!_filter.isSet() || bitRead(header.flags, C016_CACHE_BLOCK_UNORDERED)) {
+    return true;
+  }
+  return _filter.matchesRange(header.firstTimestamp, header.lastTimestamp, 0xFFFFFFFF);
+}
+
+bool C016_cache_decoder::fileMayMatch(fs::File& file) const
+{
+  const size_t footerSize = sizeof(C016_cache_block_header) + sizeof(C016_cache_file_footer);
+
+  if (!_filter.isSet() || (file.size() < (sizeof(C016_cache_file_header) + footerSize))) {
+    return true;
+  }
+  C016_cache_block_header header;
+  C016_cache_file_footer  footer;
+  const size_t pos = file.position();
+
+  file.seek(file.size() - footerSize);
+  const bool hasFooter =
+    (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header)) &&
+    (file.read(reinterpret_cast<uint8_t *>(&footer), sizeof(footer)) == sizeof(footer)) &&
+    bitRead(header.flags, C016_CACHE_BLOCK_FOOTER) &&
+    (header.count == 0) &&
+    (header.size == sizeof(footer)) &&
+    (footer.magic == C016_CACHE_FOOTER_MAGIC);
+
+  file.seek(pos);
+
+  if (!hasFooter) {
+    // File still being written, or written before a reboot.
+    return true;
+  }
+  return _filter.matchesRange(header.firstTimestamp, header.lastTimestamp, footer.taskMask);
+}
+
+#endif // ifdef USES_C016
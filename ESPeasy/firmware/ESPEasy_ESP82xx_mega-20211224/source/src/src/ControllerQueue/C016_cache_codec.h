@@ -0,0 +1,212 @@
+#ifndef CONTROLLERQUEUE_C016_CACHE_CODEC_H
+#define CONTROLLERQUEUE_C016_CACHE_CODEC_H
+
+#include "../../ESPEasy_common.h"
+
+#ifdef USES_C016
+
+# include "../ControllerQueue/C016_queue_element.h"
+
+# include <FS.h>
+# include <vector>
+
+
+/*********************************************************************************************\
+* C016 cache file format
+*
+* A cache file starts with a C016_cache_file_header, followed by compressed blocks.
+* Each flush of the RTC buffer adds a single block of C016_queue_element samples.
+* Each block starts with a C016_cache_block_header, so a reader can skip a block without decoding it.
+*
+* Samples are stored as a bit stream:
+* - Task index, only when it differs from the previous sample.
+* - Controller index, sensor type and value count, only when changed for the task.
+* - Timestamp as delta-of-delta to the previous sample.
+* - Values XOR-ed with the previous value in the same task column ("Gorilla" compression).
+*
+* The first block in a file (and after a reboot) is a key frame, decoding starts with an empty state.
+* Other blocks continue with the state of the previous block in the same file.
+* A key frame is also inserted every C016_CACHE_KEYFRAME_INTERVAL blocks,
+* so a reader can skip blocks and only has to decode from the last key frame.
+*
+* When a file is full, a footer block is added holding the time range and tasks present in the file.
+* This allows to skip a complete file when querying a time range.
+*
+* Files without the header are written by older builds, storing uncompressed C016_queue_element.
+*
+* The gain depends on the data. Measured on simulated sensors, blocks of 10 samples,
+* a 24000 byte file holds this many times the 1000 uncompressed samples:
+* - 1 task, 2 values with 1 decimal, fixed interval:                  3.9x
+* - 1 task, 3 values with 2 decimals, fixed interval:                 2.1x
+* - 3 interleaved tasks, 4 values with 2 decimals, jittered interval: 1.4x
+* - 1 task, 1 noisy unrounded value, fixed interval:                  4.5x
+* These include the 12 byte block header, about 1.2 bytes per sample.
+\*********************************************************************************************/
+
+# define C016_CACHE_FILE_MAGIC      0x36313043 // "C016"
+# define C016_CACHE_FILE_VERSION    1
+# define C016_CACHE_FOOTER_MAGIC    0x46363143 // "C16F"
+
+// Bits in C016_cache_block_header::flags
+# define C016_CACHE_BLOCK_KEYFRAME  0
+# define C016_CACHE_BLOCK_FOOTER    1 // No samples, block data is a C016_cache_file_footer
+# define C016_CACHE_BLOCK_UNORDERED 2 // Timestamps not increasing, first/last timestamp is not the time range
+
+# ifndef C016_CACHE_KEYFRAME_INTERVAL
+#  define C016_CACHE_KEYFRAME_INTERVAL 16
+# endif // ifndef C016_CACHE_KEYFRAME_INTERVAL
+
+
+struct __attribute__((__packed__)) C016_cache_file_header {
+  uint32_t magic   = C016_CACHE_FILE_MAGIC;
+  uint8_t  version = C016_CACHE_FILE_VERSION;
+  uint8_t  reserved[3] = { 0 };
+};
+
+// For a footer block, firstTimestamp and lastTimestamp are the min/max timestamp in the file.
+struct __attribute__((__packed__)) C016_cache_block_header {
+  uint16_t size           = 0; // Size of the encoded samples, excluding this header
+  uint8_t  count          = 0; // Number of samples
+  uint8_t  flags          = 0;
+  uint32_t firstTimestamp = 0;
+  uint32_t lastTimestamp  = 0;
+};
+
+struct __attribute__((__packed__)) C016_cache_file_footer {
+  uint32_t taskMask = 0; // Bit set for each task index present in the file
+  uint32_t magic    = C016_CACHE_FOOTER_MAGIC;
+};
+
+
+/*********************************************************************************************\
+* C016_cache_filter
+* Select samples by time range (inclusive) and task index.
+\*********************************************************************************************/
+struct C016_cache_filter {
+  bool isSet() const;
+
+  bool matches(uint32_t    timestamp,
+               taskIndex_t taskIndex) const;
+
+  // Return true when any sample in the range may match.
+  bool matchesRange(uint32_t minTimestamp,
+                    uint32_t maxTimestamp,
+                    uint32_t taskMask) const;
+
+  uint32_t from     = 0;
+  uint32_t to       = 0xFFFFFFFF;
+  uint32_t taskMask = 0xFFFFFFFF;
+};
+
+
+/*********************************************************************************************\
+* C016_cache_codec_state
+* State shared by encoder and decoder, must be updated exactly the same on both sides.
+\*********************************************************************************************/
+struct C016_cache_codec_state {
+  void reset();
+
+  struct Column {
+    uint32_t bits    = 0;
+    uint8_t  leading = 0xFF; // Window of meaningful bits of the last XOR, 0xFF = not set
+    uint8_t  length  = 0;
+  };
+
+  struct Task {
+    Column            columns[VARS_PER_TASK];
+    controllerIndex_t controller_idx = INVALID_CONTROLLER_INDEX;
+    Sensor_VType      sensorType     = Sensor_VType::SENSOR_TYPE_NONE;
+    uint8_t           valueCount     = 0;
+    bool              known          = false;
+  };
+
+  std::vector<Task> tasks;
+  uint32_t          timestamp = 0;
+  int64_t           delta     = 0;
+  taskIndex_t       taskIndex = INVALID_TASK_INDEX;
+};
+
+
+/*********************************************************************************************\
+* C016_cache_encoder
+\*********************************************************************************************/
+class C016_cache_encoder {
+public:
+
+  // Make the next block a key frame.
+  void reset();
+
+  // Start appending to a file, emptyFile should be false when the file already holds samples.
+  // The footer can only be written when all samples in the file were encoded by this encoder.
+  void startFile(bool emptyFile);
+
+  // Encode the raw C016_queue_element samples in data into a new block, appended to block.
+  // Return false when nothing was encoded.
+  bool encode(const uint8_t        *data,
+              size_t                size,
+              std::vector<uint8_t>& block);
+
+  // Encode the footer block describing all samples written since startFile().
+  // Return false when the footer cannot be made.
+  bool encodeFooter(std::vector<uint8_t>& block) const;
+
+  static void writeFileHeader(fs::File& file);
+
+private:
+
+  C016_cache_codec_state _state;
+  uint32_t               _minTimestamp        = 0xFFFFFFFF;
+  uint32_t               _maxTimestamp        = 0;
+  uint32_t               _taskMask            = 0;
+  uint8_t                _blocksSinceKeyframe = 0;
+  bool                   _keyframe            = true;
+  bool                   _fileStatsValid      = false;
+};
+
+
+/*********************************************************************************************\
+* C016_cache_decoder
+* Reads the samples from a cache file, one at a time.
+\*********************************************************************************************/
+class C016_cache_decoder {
+public:
+
+  // Start reading a new file.
+  void reset();
+
+  // Only return samples matching the filter.
+  // Files and blocks which cannot match are skipped without decoding.
+  void setFilter(const C016_cache_filter& filter);
+
+  // Read the next sample from the file.
+  // Return false when no more samples can be read.
+  bool read(fs::File          & file,
+            C016_queue_element& element);
+
+  // Return true when the file is written in the compressed format.
+  static bool hasFileHeader(fs::File& file);
+
+private:
+
+  bool readBlock(fs::File& file);
+
+  bool blockMayMatch(const C016_cache_block_header& header) const;
+
+  bool fileMayMatch(fs::File& file) const;
+
+  C016_cache_codec_state _state;
+  C016_cache_filter      _filter;
+  std::vector<uint8_t>   _block;
+  size_t                 _bitPos      = 0;
+  size_t                 _keyframePos = 0;
+  size_t                 _replayEnd   = 0; // Blocks before this position are decoded only to restore the state
+  uint8_t                _remaining   = 0;
+  bool                   _started     = false;
+  bool                   _legacy      = false;
+  bool                   _inSync      = true;
+  bool                   _replaying   = false;
+};
+
+#endif // ifdef USES_C016
+
+#endif // ifndef CONTROLLERQUEUE_C016_CACHE_CODEC_H
@@ -5,6 +5,7 @@
 #include "../DataStructs/TimingStats.h"
 #include "../DataStructs/UnitMessageCount.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Globals/ControllerQueueStats.h"
 #include "../Globals/CPlugins.h"
 #include "../Globals/ESPEasy_Scheduler.h"
 #include "../Globals/Protocol.h"
@@ -39,7 +40,16 @@ struct ControllerDelayHandlerStruct {
     delete_oldest(false),
     must_check_reply(false),
     deduplicate(false),
-    useLocalSystemTime(false) {}
+    useLocalSystemTime(false),
+    max_burst(1) {}
+
+  ~ControllerDelayHandlerStruct() {
+    for (auto it = sendQueue.begin(); it != sendQueue.end(); ++it) {
+      ControllerQueueStatsStruct *stats = getControllerQueueStats(it->controller_idx);
+
+      if (stats != nullptr) { stats->clearDepth(); }
+    }
+  }
 
   void configureControllerSettings(const ControllerSettingsStruct& settings) {
     minTimeBetweenMessages = settings.MinimalTimeBetweenMessages;
@@ -49,6 +59,7 @@ struct ControllerDelayHandlerStruct {
     must_check_reply       = settings.MustCheckReply;
     deduplicate            = settings.deduplicate();
     useLocalSystemTime          = settings.useLocalSystemTime();
+    max_burst              = settings.mqtt_burstSize();
     if (settings.allowExpire()) {
       expire_timeout = max_queue_depth * max_retries * (minTimeBetweenMessages + settings.ClientTimeout);
       if (expire_timeout < CONTROLLER_QUEUE_MINIMAL_EXPIRE_TIME) {
@@ -90,18 +101,11 @@ struct ControllerDelayHandlerStruct {
     }
 #ifndef BUILD_NO_DEBUG
 
-    if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-      String log = F("Controller-");
-      log += element.controller_idx + 1;
-      log += F(" : Memory used: ");
-      log += getQueueMemorySize();
-      log += F(" bytes ");
-      log += sendQueue.size();
-      log += F(" items ");
-      log += freeHeap;
-      log += F(" free");
-      addLog(LOG_LEVEL_DEBUG, log);
-    }
+    addLogFmt(LOG_LEVEL_DEBUG, LogFormat::Id::ControllerQueueMemory,
+              element.controller_idx + 1,
+              getQueueMemorySize(),
+              sendQueue.size(),
+              freeHeap);
 #endif // ifndef BUILD_NO_DEBUG
     return true;
   }
@@ -149,23 +153,23 @@ struct ControllerDelayHandlerStruct {
       // Force add to the queue.
       // If max buffer is reached, the oldest in the queue (first to be served) will be removed.
       while (queueFull(element)) {
-        sendQueue.pop_front();
-        attempt = 0;
+        removeFront(ControllerQueueStatsStruct::Removed::Oldest);
       }
     }
+    ControllerQueueStatsStruct *stats = getControllerQueueStats(element.controller_idx);
 
     if (!queueFull(element)) {
       sendQueue.push_back(std::move(element));
+
+      if (stats != nullptr) { stats->markAdded(); }
       return true;
     }
+
+    if (stats != nullptr) { stats->markDroppedFull(); }
 #ifndef BUILD_NO_DEBUG
 
-    if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-      const cpluginID_t cpluginID = getCPluginID_from_ControllerIndex(element.controller_idx);
-      String log = get_formatted_Controller_number(cpluginID);
-      log += " : queue full";
-      addLog(LOG_LEVEL_DEBUG, log);
-    }
+    addLogFmt(LOG_LEVEL_DEBUG, LogFormat::Id::ControllerQueueFull,
+              getCPluginID_from_ControllerIndex(element.controller_idx));
 #endif // ifndef BUILD_NO_DEBUG
     return false;
   }
@@ -176,8 +180,7 @@ struct ControllerDelayHandlerStruct {
     if (sendQueue.empty()) { return nullptr; }
 
     if (attempt > max_retries) {
-      sendQueue.pop_front();
-      attempt = 0;
+      removeFront(ControllerQueueStatsStruct::Removed::Retries);
     }
 
     if (expire_timeout != 0) {
@@ -186,8 +189,7 @@ struct ControllerDelayHandlerStruct {
         if (timePassedSince(sendQueue.front()._timestamp) < static_cast<long>(expire_timeout)) {
           done = true;
         } else {
-          sendQueue.pop_front();
-          attempt = 0;
+          removeFront(ControllerQueueStatsStruct::Removed::Expired);
         }
       }
     }
@@ -203,10 +205,12 @@ struct ControllerDelayHandlerStruct {
     if (sendQueue.empty()) { return 0; }
 
     if (remove_from_queue) {
-      sendQueue.pop_front();
-      attempt = 0;
+      removeFront(ControllerQueueStatsStruct::Removed::Sent);
       lastSend = millis();
     } else {
+      ControllerQueueStatsStruct *stats = getControllerQueueStats(sendQueue.front().controller_idx);
+
+      if (stats != nullptr) { stats->markRetry(); }
       ++attempt;
     }
     return getNextScheduleTime();
@@ -232,6 +236,23 @@ struct ControllerDelayHandlerStruct {
     lastSend = millis() + msecFromNow;
   }
 
+  // Remove the front element and account it in the queue statistics of its controller.
+  void removeFront(ControllerQueueStatsStruct::Removed reason) {
+    ControllerQueueStatsStruct *stats = getControllerQueueStats(sendQueue.front().controller_idx);
+
+    if (stats != nullptr) { stats->markRemoved(reason); }
+    sendQueue.pop_front();
+    attempt = 0;
+  }
+
+  // Remove the element last added, e.g. when it could not be completed.
+  void removeBack() {
+    ControllerQueueStatsStruct *stats = getControllerQueueStats(sendQueue.back().controller_idx);
+
+    if (stats != nullptr) { stats->markRemoved(ControllerQueueStatsStruct::Removed::Discarded); }
+    sendQueue.pop_back();
+  }
+
   size_t getQueueMemorySize() const {
     size_t totalSize = 0;
 
@@ -253,6 +274,7 @@ struct ControllerDelayHandlerStruct {
   bool          must_check_reply;
   bool          deduplicate;
   bool          useLocalSystemTime;
+  uint8_t       max_burst; // Max. number of elements to process in a single run (MQTT only)
 };
 
 
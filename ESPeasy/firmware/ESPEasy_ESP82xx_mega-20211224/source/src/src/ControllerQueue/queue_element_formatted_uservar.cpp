@@ -7,17 +7,14 @@
 
 queue_element_formatted_uservar::queue_element_formatted_uservar(queue_element_formatted_uservar&& other)
   :
+  values(std::move(other.values)),
   idx(other.idx),
   _timestamp(other._timestamp),
   TaskIndex(other.TaskIndex),
   controller_idx(other.controller_idx),
   sensorType(other.sensorType),
   valueCount(other.valueCount)
-{
-  for (size_t i = 0; i < VARS_PER_TASK; ++i) {
-    txt[i] = std::move(other.txt[i]);
-  }
-}
+{}
 
 queue_element_formatted_uservar::queue_element_formatted_uservar(EventStruct *event) :
   idx(event->idx),
@@ -25,36 +22,34 @@ queue_element_formatted_uservar::queue_element_formatted_uservar(EventStruct *ev
   controller_idx(event->ControllerIndex),
   sensorType(event->sensorType)
 {
+  values     = getFormattedUserVar(event);
   valueCount = getValueCountForTask(TaskIndex);
-
-  for (uint8_t i = 0; i < valueCount; ++i) {
-    txt[i] = formatUserVarNoCheck(event, i);
-  }
 }
 
 queue_element_formatted_uservar& queue_element_formatted_uservar::operator=(queue_element_formatted_uservar&& other) {
+  values         = std::move(other.values);
   idx            = other.idx;
   _timestamp     = other._timestamp;
   TaskIndex      = other.TaskIndex;
   controller_idx = other.controller_idx;
   sensorType     = other.sensorType;
   valueCount     = other.valueCount;
+  return *this;
+}
 
-  #ifdef USE_SECOND_HEAP
-  HeapSelectIram ephemeral;
-  #endif // ifdef USE_SECOND_HEAP
-
-  for (size_t i = 0; i < VARS_PER_TASK; ++i) {
-    txt[i] = std::move(other.txt[i]);
+const String& queue_element_formatted_uservar::txt(uint8_t index) const {
+  if (!values || (index >= VARS_PER_TASK)) {
+    return EMPTY_STRING;
   }
-  return *this;
+  return values->txt[index];
 }
 
 size_t queue_element_formatted_uservar::getSize() const {
   size_t total = sizeof(*this);
 
-  for (int i = 0; i < VARS_PER_TASK; ++i) {
-    total += txt[i].length();
+  if (values) {
+    // Count the shared values as if not shared, as these are kept as long as the element is in the queue.
+    total += values->getSize();
   }
   return total;
 }
@@ -67,10 +62,12 @@ bool queue_element_formatted_uservar::isDuplicate(const queue_element_formatted_
     return false;
   }
 
-  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
-    if (other.txt[i] != txt[i]) {
-      return false;
-    }
+  if (other.values == values) {
+    return true;
+  }
+
+  if (!other.values || !values) {
+    return false;
   }
-  return true;
+  return values->equals(*other.values);
 }
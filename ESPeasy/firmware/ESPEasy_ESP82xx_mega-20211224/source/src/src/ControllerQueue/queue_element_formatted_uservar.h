@@ -3,6 +3,7 @@
 
 #include "../../ESPEasy_common.h"
 #include "../DataStructs/DeviceStruct.h"
+#include "../DataStructs/FormattedUserVarStruct.h"
 #include "../DataStructs/UnitMessageCount.h"
 #include "../Globals/CPlugins.h"
 #include "../Globals/Plugins.h"
@@ -32,7 +33,10 @@ public:
     return nullptr;
   }
 
-  String txt[VARS_PER_TASK];
+  // Formatted task value, shared with other controllers sending the same values.
+  const String& txt(uint8_t index) const;
+
+  FormattedUserVar_ptr values;
   int idx                          = 0;
   unsigned long _timestamp         = millis();
   taskIndex_t TaskIndex            = INVALID_TASK_INDEX;
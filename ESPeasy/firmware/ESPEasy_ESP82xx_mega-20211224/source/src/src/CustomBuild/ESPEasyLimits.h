@@ -129,6 +129,23 @@
   #define RULES_IF_MAX_NESTING_LEVEL          4
 #endif
 
+// Number of events which can be queued for rules processing.
+#ifndef EVENT_QUEUE_MAX_SIZE
+  #ifdef ESP32
+    #define EVENT_QUEUE_MAX_SIZE             64
+  #else
+    #define EVENT_QUEUE_MAX_SIZE             32
+  #endif
+#endif
+// Number of distinct event names (part before '=') kept in the event queue name table.
+#ifndef EVENT_QUEUE_MAX_NAMES
+  #define EVENT_QUEUE_MAX_NAMES              32
+#endif
+// Event values up to this length are stored without heap allocation.
+#ifndef EVENT_QUEUE_INLINE_VALUE_SIZE
+  #define EVENT_QUEUE_INLINE_VALUE_SIZE      16
+#endif
+
 
 // ***********************************************************************
 // * Extended SecuritySettings
@@ -10,6 +10,8 @@
 void Caches::clearAllCaches()
 {
   fileExistsMap.clear();
+  syslogHeader = String();
+  rulesHelper.invalidate();
   updateTaskCaches();
   WiFi_AP_Candidates.clearCache();
 }
@@ -17,6 +19,12 @@ void Caches::clearAllCaches()
 void Caches::updateTaskCaches() {
   taskIndexName.clear();
   taskIndexValueName.clear();
+  templateCache.clear();
+  extraTaskSettingsCache.clear();
+  formulaCache.clear();
+  #ifdef USES_P037
+  mqttImportTopics.clear();
+  #endif // ifdef USES_P037
   updateActiveTaskUseSerial0();
 }
 
@@ -3,7 +3,12 @@
 
 #include <map>
 #include "../../ESPEasy_common.h"
+#include "../DataStructs/ExtraTaskSettingsCache.h"
+#include "../DataStructs/MQTT_TopicFilterTrie.h"
 #include "../Globals/Plugins.h"
+#include "../Helpers/CompiledFormula.h"
+#include "../Helpers/CompiledTemplate.h"
+#include "../Helpers/RulesHelper.h"
 
 typedef std::map<String, taskIndex_t>TaskIndexNameMap;
 typedef std::map<String, uint8_t>       TaskIndexValueNameMap;
@@ -19,6 +24,14 @@ struct Caches {
   TaskIndexNameMap      taskIndexName;
   TaskIndexValueNameMap taskIndexValueName;
   FilePresenceMap       fileExistsMap;
+  String                syslogHeader; // Hostname part of the syslog header
+  RulesHelperClass      rulesHelper;
+  CompiledTemplateCache templateCache;
+  ExtraTaskSettingsCache extraTaskSettingsCache;
+  CompiledFormulaCache  formulaCache;
+  #ifdef USES_P037
+  MQTT_TopicFilterTrie  mqttImportTopics; // Subscriptions of all MQTT import tasks
+  #endif // ifdef USES_P037
   bool                  activeTaskUseSerial0 = false;
 };
 
@@ -0,0 +1,37 @@
+#include "../DataStructs/ControllerQueueStatsStruct.h"
+
+
+void ControllerQueueStatsStruct::markAdded()
+{
+  ++depth;
+}
+
+void ControllerQueueStatsStruct::markRemoved(Removed reason)
+{
+  if (depth > 0) {
+    --depth;
+  }
+
+  switch (reason) {
+    case Removed::Sent:    ++sent;           break;
+    case Removed::Oldest:  ++droppedOldest;  break;
+    case Removed::Retries: ++droppedRetries; break;
+    case Removed::Expired: ++droppedExpired; break;
+    case Removed::Discarded:                 break;
+  }
+}
+
+void ControllerQueueStatsStruct::markRetry()
+{
+  ++retries;
+}
+
+void ControllerQueueStatsStruct::markDroppedFull()
+{
+  ++droppedFull;
+}
+
+void ControllerQueueStatsStruct::clearDepth()
+{
+  depth = 0;
+}
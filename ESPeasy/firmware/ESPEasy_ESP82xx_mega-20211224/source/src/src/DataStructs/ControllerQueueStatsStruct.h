@@ -0,0 +1,43 @@
+#ifndef DATASTRUCTS_CONTROLLERQUEUESTATSSTRUCT_H
+#define DATASTRUCTS_CONTROLLERQUEUESTATSSTRUCT_H
+
+#include "../../ESPEasy_common.h"
+
+
+/*********************************************************************************************\
+* ControllerQueueStatsStruct
+* Counters of the delay queue of a single controller, since boot.
+\*********************************************************************************************/
+struct ControllerQueueStatsStruct {
+  // Reason why an element was removed from the queue.
+  enum class Removed : uint8_t {
+    Sent,
+    Oldest,  // Removed to make room for a new element ("Delete Oldest")
+    Retries, // Max. retries reached
+    Expired,
+    Discarded // Removed by the controller itself before processing, not counted
+  };
+
+  void markAdded();
+
+  void markRemoved(Removed reason);
+
+  void markRetry();
+
+  // Element not added as the queue is full.
+  void markDroppedFull();
+
+  // Elements still queued when the queue is deleted.
+  void clearDepth();
+
+  uint32_t sent           = 0;
+  uint32_t retries        = 0;
+  uint32_t droppedFull    = 0;
+  uint32_t droppedOldest  = 0;
+  uint32_t droppedRetries = 0;
+  uint32_t droppedExpired = 0;
+  uint16_t depth          = 0; // Current number of queued elements
+};
+
+
+#endif // DATASTRUCTS_CONTROLLERQUEUESTATSSTRUCT_H
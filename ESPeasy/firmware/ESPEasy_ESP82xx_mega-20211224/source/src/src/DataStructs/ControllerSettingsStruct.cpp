@@ -286,3 +286,20 @@ void ControllerSettingsStruct::useLocalSystemTime(bool value)
 {
   bitWrite(VariousFlags, 11, value);
 }
+
+uint8_t ControllerSettingsStruct::mqtt_burstSize() const
+{
+  const uint8_t value = (VariousFlags >> 16) & 0xFF;
+
+  if (value == 0) { return 1; }
+
+  if (value > CONTROLLER_MQTT_BURST_MAX) { return CONTROLLER_MQTT_BURST_MAX; }
+  return value;
+}
+
+void ControllerSettingsStruct::mqtt_burstSize(uint8_t value)
+{
+  if (value > CONTROLLER_MQTT_BURST_MAX) { value = CONTROLLER_MQTT_BURST_MAX; }
+  VariousFlags &= ~(static_cast<uint32_t>(0xFF) << 16);
+  VariousFlags |= static_cast<uint32_t>(value) << 16;
+}
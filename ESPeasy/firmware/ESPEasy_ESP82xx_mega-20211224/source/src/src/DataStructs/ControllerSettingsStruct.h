@@ -48,6 +48,19 @@ class WiFiUDP;
 # define CONTROLLER_CLIENTTIMEOUT_DFLT     100
 #endif // ifndef CONTROLLER_CLIENTTIMEOUT_DFLT
 
+// Max. number of MQTT messages published from the queue in a single burst.
+#ifndef CONTROLLER_MQTT_BURST_MAX
+# define CONTROLLER_MQTT_BURST_MAX        32
+#endif // ifndef CONTROLLER_MQTT_BURST_MAX
+// Max. number of bytes (topic + payload) published in a single burst.
+#ifndef CONTROLLER_MQTT_BURST_MAX_BYTES
+# define CONTROLLER_MQTT_BURST_MAX_BYTES  4096
+#endif // ifndef CONTROLLER_MQTT_BURST_MAX_BYTES
+// Time budget for a single burst, to keep the main loop responsive.
+#ifndef CONTROLLER_MQTT_BURST_MAX_DURATION
+# define CONTROLLER_MQTT_BURST_MAX_DURATION  20 // msec
+#endif // ifndef CONTROLLER_MQTT_BURST_MAX_DURATION
+
 #ifndef CONTROLLER_DEFAULT_CLIENTID
 # define CONTROLLER_DEFAULT_CLIENTID  "%sysname%_%unit%"
 #endif // ifndef CONTROLLER_DEFAULT_CLIENTID
@@ -71,6 +84,7 @@ struct ControllerSettingsStruct
     CONTROLLER_FULL_QUEUE_ACTION,
     CONTROLLER_ALLOW_EXPIRE,
     CONTROLLER_DEDUPLICATE,
+    CONTROLLER_MQTT_BURST_SIZE,
     CONTROLLER_USE_LOCAL_SYSTEM_TIME,
     CONTROLLER_CHECK_REPLY,
     CONTROLLER_CLIENT_ID,
@@ -145,6 +159,11 @@ struct ControllerSettingsStruct
 
   bool      useLocalSystemTime() const;
   void      useLocalSystemTime(bool value);
+
+  // Max. number of MQTT messages to publish per run of the delay queue.
+  // Stored in bits 16 ... 23, value 0 (default) means a single message.
+  uint8_t   mqtt_burstSize() const;
+  void      mqtt_burstSize(uint8_t value);
   
 
   boolean      UseDNS;
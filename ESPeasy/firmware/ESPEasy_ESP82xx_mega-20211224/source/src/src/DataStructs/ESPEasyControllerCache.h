@@ -22,6 +22,12 @@ struct ControllerCache_struct {
   // Dump whatever is in the buffer to the filesystem
   bool   flush();
 
+  // Write flushed samples to the filesystem in small steps, called from backgroundtasks()
+  void   processWriteBehind();
+
+  // Complete writing flushed samples, without flushing the RTC buffer itself.
+  bool   finishPendingWrite();
+
   void   init();
 
   bool   isInitialized();
@@ -37,6 +43,11 @@ struct ControllerCache_struct {
   bool   peek(uint8_t     *data,
               unsigned int size);
 
+#ifdef USES_C016
+  // Only peek samples matching the filter, cleared by resetpeek()
+  void   setPeekFilter(const C016_cache_filter& filter);
+#endif
+
   String getPeekCacheFileName(bool& islast);
 
   int readFileNr = 0;
@@ -32,6 +32,19 @@ bool ControllerCache_struct::flush() {
   return _RTC_cache_handler->flush();
 }
 
+void ControllerCache_struct::processWriteBehind() {
+  if (_RTC_cache_handler != nullptr) {
+    _RTC_cache_handler->processWriteBehind();
+  }
+}
+
+bool ControllerCache_struct::finishPendingWrite() {
+  if (_RTC_cache_handler == nullptr) {
+    return false;
+  }
+  return _RTC_cache_handler->finishPendingWrite();
+}
+
 void ControllerCache_struct::init() {
   if (_RTC_cache_handler == nullptr) {
     _RTC_cache_handler = new (std::nothrow) RTC_cache_handler_struct;
@@ -66,6 +79,14 @@ bool ControllerCache_struct::peek(uint8_t *data, unsigned int size) {
   return _RTC_cache_handler->peek(data, size);
 }
 
+#ifdef USES_C016
+void ControllerCache_struct::setPeekFilter(const C016_cache_filter& filter) {
+  if (_RTC_cache_handler != nullptr) {
+    _RTC_cache_handler->setPeekFilter(filter);
+  }
+}
+#endif
+
 String ControllerCache_struct::getPeekCacheFileName(bool& islast) {
   if (_RTC_cache_handler == nullptr) {
     return "";
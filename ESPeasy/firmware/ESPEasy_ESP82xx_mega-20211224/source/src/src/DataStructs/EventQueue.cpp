@@ -1,38 +1,417 @@
 #include "../DataStructs/EventQueue.h"
 
+#include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Helpers/Memory.h"
+
+// Parse a decimal value like "-12.50" into a fixed point representation.
+// Only accept notations which are formatted exactly the same when converted back,
+// so the event string is not altered.
+static bool parseFixedPoint(const char *str, size_t length, int64_t& mantissa, uint8_t& decimals)
+{
+  size_t i             = 0;
+  bool   negative      = false;
+  bool   decimalPoint  = false;
+  uint8_t nrDigits     = 0;
+  uint64_t value       = 0;
+
+  decimals = 0;
+
+  if ((length > 0) && (str[0] == '-')) {
+    negative = true;
+    ++i;
+  }
+
+  if (i >= length) {
+    return false;
+  }
+
+  // No leading zeroes
+  if ((str[i] == '0') && ((i + 1) < length) && (str[i + 1] != '.')) {
+    return false;
+  }
+
+  for (; i < length; ++i) {
+    const char c = str[i];
+
+    if (c == '.') {
+      if (decimalPoint || (nrDigits == 0) || ((i + 1) >= length)) {
+        return false;
+      }
+      decimalPoint = true;
+    } else if ((c >= '0') && (c <= '9')) {
+      if (++nrDigits > 18) {
+        return false;
+      }
+      value = value * 10 + (c - '0');
+
+      if (decimalPoint) {
+        ++decimals;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if ((nrDigits == 0) || (negative && (value == 0))) {
+    return false;
+  }
+  mantissa = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+  return true;
+}
+
+static void appendFixedPoint(String& str, int64_t mantissa, uint8_t decimals)
+{
+  char buf[24];
+  int  pos = sizeof(buf) - 1;
+
+  buf[pos] = 0;
+  uint64_t value = (mantissa < 0) ? -mantissa : mantissa;
+
+  for (uint8_t d = 0; d < decimals; ++d) {
+    buf[--pos] = '0' + (value % 10);
+    value     /= 10;
+  }
+
+  if (decimals > 0) {
+    buf[--pos] = '.';
+  }
+
+  do {
+    buf[--pos] = '0' + (value % 10);
+    value     /= 10;
+  } while (value > 0);
+
+  if (mantissa < 0) {
+    buf[--pos] = '-';
+  }
+  str += &buf[pos];
+}
+
 EventQueueStruct::EventQueueStruct() {}
 
 void EventQueueStruct::add(const String& event)
 {
-  _eventQueue.push_back(event);
+  String tmp(event);
+
+  addEvent(tmp, false, false);
 }
 
-void EventQueueStruct::add(const __FlashStringHelper * event)
+void EventQueueStruct::add(const __FlashStringHelper *event)
 {
-  _eventQueue.push_back(event);
+  String tmp(event);
+
+  addEvent(tmp, true, false);
 }
 
 void EventQueueStruct::addMove(String&& event)
 {
-  _eventQueue.emplace_back(std::move(event));
+  addEvent(event, true, false);
+}
+
+void EventQueueStruct::addMove(String&& event, bool coalesce)
+{
+  addEvent(event, true, coalesce);
 }
 
 bool EventQueueStruct::getNext(String& event)
 {
-  if (_eventQueue.empty()) {
+  if (_count == 0) {
     return false;
   }
-  event = std::move(_eventQueue.front());
-  _eventQueue.pop_front();
+  event = toString(at(0));
+  release(at(0));
+  _head = (_head + 1) % _elements.size();
+  --_count;
   return true;
 }
 
 void EventQueueStruct::clear()
 {
-  _eventQueue.clear();
+  while (_count > 0) {
+    release(at(0));
+    _head = (_head + 1) % _elements.size();
+    --_count;
+  }
+  _head = 0;
 }
 
 bool EventQueueStruct::isEmpty() const
 {
-  return _eventQueue.empty();
-}
\ No newline at end of file
+  return _count == 0;
+}
+
+void EventQueueStruct::addEvent(String& event, bool allowMove, bool coalesce)
+{
+  if (_elements.empty()) {
+    // Allocate all elements at once, will be kept for reuse.
+    _elements.resize(EVENT_QUEUE_MAX_SIZE);
+  }
+
+  const char *str         = event.c_str();
+  const size_t length     = event.length();
+  const int    equalsPos  = event.indexOf('=');
+  const size_t nameLength = (equalsPos >= 0) ? equalsPos : length;
+  const int8_t nameIndex  = internName(str, nameLength);
+  const char  *value      = (equalsPos >= 0) ? str + equalsPos + 1 : nullptr;
+  const size_t valueLen   = (equalsPos >= 0) ? length - equalsPos - 1 : 0;
+
+  if (coalesce && (nameIndex >= 0)) {
+    Element *element = findQueued(nameIndex, true);
+
+    if (element != nullptr) {
+      element->heapValue = String();
+      setValue(*element, value, valueLen);
+      ++_merged;
+      return;
+    }
+  }
+
+  if (_count >= _elements.size()) {
+    switch (_overflowPolicy) {
+      case EventQueueOverflowPolicy::DropNewest:
+        ++_dropped;
+        addLog(LOG_LEVEL_ERROR, String(F("Event queue full, dropped: ")) + event);
+        return;
+      case EventQueueOverflowPolicy::DropOldest:
+        dropOldest();
+        break;
+      case EventQueueOverflowPolicy::Coalesce:
+      {
+        // Only an exact duplicate may be dropped, events with other values must all be processed.
+        bool duplicate = false;
+
+        for (size_t i = 0; i < _count && !duplicate && nameIndex >= 0; ++i) {
+          Element& queued = at(i);
+          duplicate = (queued.nameIndex == nameIndex) && hasValue(queued, value, valueLen);
+        }
+
+        if (duplicate) {
+          ++_coalesced;
+          addLog(LOG_LEVEL_ERROR, String(F("Event queue full, coalesced duplicate: ")) + event);
+          return;
+        }
+        dropOldest();
+        break;
+      }
+      case EventQueueOverflowPolicy::Grow:
+
+        if (!grow()) {
+          dropOldest();
+        }
+        break;
+    }
+  }
+
+  // Only count the name reference once the event is actually queued,
+  // so an event dropped above does not keep its name in the name table.
+  Element& element = at(_count);
+
+  element.heapValue = String();
+  element.nameIndex = nameIndex;
+  element.coalesce  = coalesce;
+
+  if (nameIndex >= 0) {
+    ++_nameRefCount[nameIndex];
+    setValue(element, value, valueLen);
+  } else {
+    element.type = Element::ValueType::FullEvent;
+
+    if (allowMove) {
+      element.heapValue = std::move(event);
+    } else {
+      element.heapValue = event;
+    }
+  }
+  ++_count;
+
+  if (_count > _highWaterMark) {
+    _highWaterMark = _count;
+  }
+}
+
+bool EventQueueStruct::hasValue(const Element& element, const char *value, size_t length)
+{
+  Element tmp;
+
+  setValue(tmp, value, length);
+
+  if (tmp.type != element.type) {
+    return false;
+  }
+
+  switch (tmp.type) {
+    case Element::ValueType::None:
+      return true;
+    case Element::ValueType::Numeric:
+      return tmp.mantissa == element.mantissa && tmp.decimals == element.decimals;
+    case Element::ValueType::Text:
+      return strcmp(tmp.text, element.text) == 0;
+    case Element::ValueType::HeapText:
+      return tmp.heapValue.equals(element.heapValue);
+    case Element::ValueType::FullEvent:
+      break;
+  }
+  return false;
+}
+
+bool EventQueueStruct::grow()
+{
+  const size_t newSize = _elements.size() * 2;
+
+  if (FreeMem() < (newSize * sizeof(Element) + EVENT_QUEUE_GROW_MIN_FREE_MEM)) {
+    return false;
+  }
+  std::vector<Element> elements(newSize);
+
+  for (size_t i = 0; i < _count; ++i) {
+    elements[i] = std::move(at(i));
+  }
+  _elements.swap(elements);
+  _head = 0;
+
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    addLog(LOG_LEVEL_INFO, String(F("Event queue size increased to ")) + newSize);
+  }
+  return true;
+}
+
+void EventQueueStruct::dropOldest()
+{
+  Element& element = at(0);
+  const String event = toString(element);
+
+  release(element);
+  _head = (_head + 1) % _elements.size();
+  --_count;
+  ++_dropped;
+  addLog(LOG_LEVEL_ERROR, String(F("Event queue full, dropped: ")) + event);
+}
+
+EventQueueStruct::Element * EventQueueStruct::findQueued(int8_t nameIndex, bool coalesceOnly)
+{
+  if ((nameIndex < 0) || (_nameRefCount[nameIndex] == 0)) {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < _count; ++i) {
+    Element& element = at(i);
+
+    if ((element.nameIndex == nameIndex) && (!coalesceOnly || element.coalesce)) {
+      return &element;
+    }
+  }
+  return nullptr;
+}
+
+void EventQueueStruct::setValue(Element& element, const char *value, size_t length)
+{
+  if (value == nullptr) {
+    element.type = Element::ValueType::None;
+  } else if (parseFixedPoint(value, length, element.mantissa, element.decimals)) {
+    element.type = Element::ValueType::Numeric;
+  } else if (length < EVENT_QUEUE_INLINE_VALUE_SIZE) {
+    element.type = Element::ValueType::Text;
+    memcpy(element.text, value, length);
+    element.text[length] = 0;
+  } else {
+    element.type = Element::ValueType::HeapText;
+    element.heapValue.reserve(length);
+
+    for (size_t i = 0; i < length; ++i) {
+      element.heapValue += value[i];
+    }
+  }
+}
+
+String EventQueueStruct::toString(Element& element)
+{
+  if (element.type == Element::ValueType::FullEvent) {
+    return std::move(element.heapValue);
+  }
+
+  String event;
+
+  if ((element.nameIndex < 0) || (element.nameIndex >= EVENT_QUEUE_MAX_NAMES)) {
+    return event;
+  }
+  const String& name = _names[element.nameIndex];
+
+  switch (element.type) {
+    case Element::ValueType::None:
+      event = name;
+      break;
+    case Element::ValueType::Numeric:
+      event.reserve(name.length() + 24);
+      event  = name;
+      event += '=';
+      appendFixedPoint(event, element.mantissa, element.decimals);
+      break;
+    case Element::ValueType::Text:
+      event.reserve(name.length() + 1 + EVENT_QUEUE_INLINE_VALUE_SIZE);
+      event  = name;
+      event += '=';
+      event += element.text;
+      break;
+    case Element::ValueType::HeapText:
+      event.reserve(name.length() + 1 + element.heapValue.length());
+      event  = name;
+      event += '=';
+      event += element.heapValue;
+      break;
+    case Element::ValueType::FullEvent:
+      break;
+  }
+  return event;
+}
+
+void EventQueueStruct::release(Element& element)
+{
+  if ((element.nameIndex >= 0) && (element.nameIndex < EVENT_QUEUE_MAX_NAMES)) {
+    if (_nameRefCount[element.nameIndex] > 0) {
+      --_nameRefCount[element.nameIndex];
+    }
+  }
+  element.nameIndex = -1;
+  element.coalesce  = false;
+  element.type      = Element::ValueType::None;
+  element.heapValue = String();
+}
+
+int8_t EventQueueStruct::internName(const char *name, size_t length)
+{
+  int8_t freeIndex = -1;
+
+  for (int8_t i = 0; i < EVENT_QUEUE_MAX_NAMES; ++i) {
+    const String& entry = _names[i];
+
+    if ((entry.length() == length) && (length > 0) && (memcmp(entry.c_str(), name, length) == 0)) {
+      return i;
+    }
+
+    if (_nameRefCount[i] == 0) {
+      // Prefer an empty slot over replacing a name which may be used again.
+      if ((freeIndex < 0) || (entry.length() == 0 && _names[freeIndex].length() != 0)) {
+        freeIndex = i;
+      }
+    }
+  }
+
+  if (freeIndex >= 0) {
+    String& entry = _names[freeIndex];
+
+    if (entry.reserve(length)) {
+      entry = EMPTY_STRING;
+
+      for (size_t i = 0; i < length; ++i) {
+        entry += name[i];
+      }
+      return freeIndex;
+    }
+  }
+  return -1;
+}
+
+EventQueueStruct::Element& EventQueueStruct::at(size_t index)
+{
+  return _elements[(_head + index) % _elements.size()];
+}
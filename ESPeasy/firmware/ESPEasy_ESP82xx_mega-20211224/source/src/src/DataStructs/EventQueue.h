@@ -2,12 +2,39 @@
 #define DATASTRUCTS_EVENTQUEUE_H
 
 
-#include <list>
+#include <vector>
 #include "../../ESPEasy_common.h"
 
+#include "../CustomBuild/ESPEasyLimits.h"
 #include "../Globals/Plugins.h"
 
 
+// What to do when an event is added to a full event queue.
+// Every dropped or coalesced event is logged at ERROR level.
+enum class EventQueueOverflowPolicy : uint8_t {
+  DropOldest,
+  DropNewest,
+  Coalesce,   // Drop the new event when the exact same event (name and value) is queued, else drop oldest
+  Grow        // Double the queue size, like the unbounded queue before. Drop oldest when low on memory.
+};
+
+// The queue keeps a fixed capacity of EVENT_QUEUE_MAX_SIZE events, unless the Grow policy is set.
+#ifndef EVENT_QUEUE_OVERFLOW_POLICY
+# define EVENT_QUEUE_OVERFLOW_POLICY  EventQueueOverflowPolicy::Coalesce
+#endif // ifndef EVENT_QUEUE_OVERFLOW_POLICY
+
+// Min. free memory to keep when growing the event queue.
+#ifndef EVENT_QUEUE_GROW_MIN_FREE_MEM
+# define EVENT_QUEUE_GROW_MIN_FREE_MEM  8192
+#endif // ifndef EVENT_QUEUE_GROW_MIN_FREE_MEM
+
+
+/*********************************************************************************************\
+* EventQueueStruct
+* Ring buffer of events for rules processing, initially EVENT_QUEUE_MAX_SIZE elements.
+* The event name (part before '=') is stored in a shared name table and the value
+* is stored as a fixed point number or short text, to prevent heap allocations per event.
+\*********************************************************************************************/
 struct EventQueueStruct {
   EventQueueStruct();
 
@@ -17,15 +44,119 @@ struct EventQueueStruct {
 
   void addMove(String&& event);
 
+  // When coalesce is set, a queued event with the same name (also added with coalesce set)
+  // will get the new value, keeping its position in the queue ("latest value wins").
+  void addMove(String&& event,
+               bool     coalesce);
+
   bool getNext(String& event);
 
   void clear();
 
   bool isEmpty() const;
 
+  size_t size() const {
+    return _count;
+  }
+
+  size_t capacity() const {
+    return _elements.empty() ? EVENT_QUEUE_MAX_SIZE : _elements.size();
+  }
+
+  // Highest number of queued events since boot
+  size_t highWaterMark() const {
+    return _highWaterMark;
+  }
+
+  uint32_t droppedCount() const {
+    return _dropped;
+  }
+
+  // Number of events dropped because the exact same event was queued (Coalesce policy)
+  uint32_t coalescedCount() const {
+    return _coalesced;
+  }
+
+  // Number of events merged into a queued event with the same name
+  uint32_t mergedCount() const {
+    return _merged;
+  }
+
+  void setOverflowPolicy(EventQueueOverflowPolicy policy) {
+    _overflowPolicy = policy;
+  }
+
+  EventQueueOverflowPolicy getOverflowPolicy() const {
+    return _overflowPolicy;
+  }
+
 private:
 
-  std::list<String>_eventQueue;
+  struct Element {
+    enum class ValueType : uint8_t {
+      None,      // Event without '='
+      Numeric,   // value stored as mantissa / 10^decimals
+      Text,      // value stored in text
+      HeapText,  // value stored in heapValue
+      FullEvent  // Name could not be stored in the name table, complete event stored in heapValue
+    };
+
+    String heapValue;
+    union {
+      int64_t mantissa;
+      char    text[EVENT_QUEUE_INLINE_VALUE_SIZE];
+    };
+    int8_t    nameIndex = -1;
+    uint8_t   decimals  = 0;
+    ValueType type      = ValueType::None;
+    bool      coalesce  = false;
+  };
+
+  void   addEvent(String& event,
+                  bool    allowMove,
+                  bool    coalesce);
+
+  // Find the oldest queued event with the given name.
+  // When coalesceOnly is set, only consider events added with coalesce set.
+  Element* findQueued(int8_t nameIndex,
+                      bool   coalesceOnly);
+
+  // Check whether the element has the given value.
+  bool   hasValue(const Element& element,
+                  const char    *value,
+                  size_t         length);
+
+  // Double the number of elements, return false when there is not enough memory.
+  bool   grow();
+
+  void   dropOldest();
+
+  // Store the value part of the event in the element.
+  void   setValue(Element   & element,
+                  const char *value,
+                  size_t      length);
+
+  String toString(Element& element);
+
+  void   release(Element& element);
+
+  // Find the event name in the name table, or add it.
+  // Return -1 when the name table is full.
+  int8_t internName(const char *name,
+                    size_t      length);
+
+  Element& at(size_t index);
+
+  std::vector<Element>     _elements;
+  String                   _names[EVENT_QUEUE_MAX_NAMES];
+  uint8_t                  _nameRefCount[EVENT_QUEUE_MAX_NAMES] = { 0 };
+  size_t                   _head           = 0;
+  size_t                   _count          = 0;
+  size_t                   _highWaterMark  = 0;
+  uint32_t                 _dropped        = 0;
+  uint32_t                 _coalesced      = 0;
+  uint32_t                 _merged         = 0;
+  EventQueueOverflowPolicy _overflowPolicy = EVENT_QUEUE_OVERFLOW_POLICY;
 };
 
 
@@ -0,0 +1,223 @@
+#include "../DataStructs/ExtraTaskSettingsCache.h"
+
+#include "../Globals/ExtraTaskSettings.h"
+#include "../Globals/Plugins.h"
+
+#include "../Helpers/ESPEasy_Storage.h"
+#include "../Helpers/Memory.h"
+
+
+#define EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG_LONG  0
+#define EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG       1
+
+
+bool ExtraTaskSettingsCache::load(taskIndex_t taskIndex, ExtraTaskSettingsStruct& extraTaskSettings)
+{
+  for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+    if (it->taskIndex == taskIndex) {
+      it->lastUsed = ++_useCounter;
+      unpack(it->data, extraTaskSettings);
+      extraTaskSettings.TaskIndex = taskIndex;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ExtraTaskSettingsCache::store(const ExtraTaskSettingsStruct& extraTaskSettings)
+{
+  if (!validTaskIndex(extraTaskSettings.TaskIndex)) {
+    return;
+  }
+  storeNames(extraTaskSettings);
+
+  Entry *entry = nullptr;
+
+  for (auto it = _entries.begin(); it != _entries.end() && entry == nullptr; ++it) {
+    if (it->taskIndex == extraTaskSettings.TaskIndex) {
+      entry = &(*it);
+    }
+  }
+
+  if (entry == nullptr) {
+    if ((_entries.size() < EXTRA_TASK_SETTINGS_CACHE_MAX) &&
+        (getMaxFreeBlock() > EXTRA_TASK_SETTINGS_CACHE_MIN_FREE)) {
+      _entries.emplace_back();
+      entry = &_entries.back();
+    } else if (!_entries.empty()) {
+      // Replace the least recently used entry
+      entry = &_entries[0];
+
+      for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->lastUsed < entry->lastUsed) {
+          entry = &(*it);
+        }
+      }
+    } else {
+      return;
+    }
+  }
+  entry->taskIndex = extraTaskSettings.TaskIndex;
+  entry->lastUsed  = ++_useCounter;
+  pack(extraTaskSettings, entry->data);
+}
+
+const ExtraTaskSettingsCache::TaskNames * ExtraTaskSettingsCache::getTaskNames(taskIndex_t taskIndex)
+{
+  if (!validTaskIndex(taskIndex)) {
+    return nullptr;
+  }
+
+  if (_names.size() != TASKS_MAX) {
+    _names.resize(TASKS_MAX);
+  }
+
+  if (!_names[taskIndex].loaded) {
+    // Storing the loaded settings also stores the names.
+    LoadTaskSettings(taskIndex);
+
+    if (!_names[taskIndex].loaded && (ExtraTaskSettings.TaskIndex == taskIndex)) {
+      // Settings were already loaded before the cache was cleared, or could not be read.
+      storeNames(ExtraTaskSettings);
+    }
+  }
+  return &_names[taskIndex];
+}
+
+void ExtraTaskSettingsCache::storeNames(const ExtraTaskSettingsStruct& extraTaskSettings)
+{
+  if (_names.size() != TASKS_MAX) {
+    _names.resize(TASKS_MAX);
+  }
+  TaskNames& names = _names[extraTaskSettings.TaskIndex];
+
+  names.taskName = extraTaskSettings.TaskDeviceName;
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    names.valueNames[i] = extraTaskSettings.TaskDeviceValueNames[i];
+    names.decimals[i]   = extraTaskSettings.TaskDeviceValueDecimals[i];
+  }
+  names.loaded = true;
+}
+
+void ExtraTaskSettingsCache::clear(taskIndex_t taskIndex)
+{
+  if (taskIndex < _names.size()) {
+    _names[taskIndex] = TaskNames();
+  }
+
+  for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+    if (it->taskIndex == taskIndex) {
+      _entries.erase(it);
+      return;
+    }
+  }
+}
+
+void ExtraTaskSettingsCache::clear()
+{
+  _entries.clear();
+  _names.clear();
+}
+
+static void packString(const char *str, std::vector<uint8_t>& data)
+{
+  // Include the terminating zero
+  const size_t length = strlen(str) + 1;
+
+  data.insert(data.end(), str, str + length);
+}
+
+static size_t unpackString(const std::vector<uint8_t>& data, size_t pos, char *str, size_t maxSize)
+{
+  size_t i = 0;
+
+  while (pos < data.size() && data[pos] != 0) {
+    if (i < (maxSize - 1)) {
+      str[i++] = data[pos];
+    }
+    ++pos;
+  }
+  str[i] = 0;
+  return pos + 1;
+}
+
+template<typename T>
+static bool isZeroFilled(const T *values, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    if (values[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ExtraTaskSettingsCache::pack(const ExtraTaskSettingsStruct& extraTaskSettings, std::vector<uint8_t>& data)
+{
+  uint8_t flags = 0;
+
+  if (!isZeroFilled(extraTaskSettings.TaskDevicePluginConfigLong, PLUGIN_EXTRACONFIGVAR_MAX)) {
+    bitSet(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG_LONG);
+  }
+
+  if (!isZeroFilled(extraTaskSettings.TaskDevicePluginConfig, PLUGIN_EXTRACONFIGVAR_MAX)) {
+    bitSet(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG);
+  }
+
+  data.clear();
+  data.push_back(flags);
+  packString(extraTaskSettings.TaskDeviceName, data);
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    packString(extraTaskSettings.TaskDeviceFormula[i],    data);
+    packString(extraTaskSettings.TaskDeviceValueNames[i], data);
+  }
+  data.insert(data.end(),
+              extraTaskSettings.TaskDeviceValueDecimals,
+              extraTaskSettings.TaskDeviceValueDecimals + VARS_PER_TASK);
+
+  if (bitRead(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG_LONG)) {
+    const uint8_t *start = reinterpret_cast<const uint8_t *>(extraTaskSettings.TaskDevicePluginConfigLong);
+    data.insert(data.end(), start, start + sizeof(extraTaskSettings.TaskDevicePluginConfigLong));
+  }
+
+  if (bitRead(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG)) {
+    const uint8_t *start = reinterpret_cast<const uint8_t *>(extraTaskSettings.TaskDevicePluginConfig);
+    data.insert(data.end(), start, start + sizeof(extraTaskSettings.TaskDevicePluginConfig));
+  }
+  data.shrink_to_fit();
+}
+
+void ExtraTaskSettingsCache::unpack(const std::vector<uint8_t>& data, ExtraTaskSettingsStruct& extraTaskSettings)
+{
+  extraTaskSettings.clear();
+
+  if (data.empty()) {
+    return;
+  }
+  const uint8_t flags = data[0];
+  size_t pos          = 1;
+
+  pos = unpackString(data, pos, extraTaskSettings.TaskDeviceName, sizeof(extraTaskSettings.TaskDeviceName));
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    pos = unpackString(data, pos, extraTaskSettings.TaskDeviceFormula[i],    sizeof(extraTaskSettings.TaskDeviceFormula[i]));
+    pos = unpackString(data, pos, extraTaskSettings.TaskDeviceValueNames[i], sizeof(extraTaskSettings.TaskDeviceValueNames[i]));
+  }
+
+  for (uint8_t i = 0; i < VARS_PER_TASK && pos < data.size(); ++i, ++pos) {
+    extraTaskSettings.TaskDeviceValueDecimals[i] = data[pos];
+  }
+
+  if (bitRead(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG_LONG) &&
+      ((pos + sizeof(extraTaskSettings.TaskDevicePluginConfigLong)) <= data.size())) {
+    memcpy(extraTaskSettings.TaskDevicePluginConfigLong, &data[pos], sizeof(extraTaskSettings.TaskDevicePluginConfigLong));
+    pos += sizeof(extraTaskSettings.TaskDevicePluginConfigLong);
+  }
+
+  if (bitRead(flags, EXTRA_TASK_SETTINGS_CACHE_HAS_CONFIG) &&
+      ((pos + sizeof(extraTaskSettings.TaskDevicePluginConfig)) <= data.size())) {
+    memcpy(extraTaskSettings.TaskDevicePluginConfig, &data[pos], sizeof(extraTaskSettings.TaskDevicePluginConfig));
+  }
+}
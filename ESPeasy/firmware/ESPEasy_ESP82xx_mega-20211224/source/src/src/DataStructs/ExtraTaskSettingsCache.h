@@ -0,0 +1,87 @@
+#ifndef DATASTRUCTS_EXTRATASKSETTINGSCACHE_H
+#define DATASTRUCTS_EXTRATASKSETTINGSCACHE_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../CustomBuild/ESPEasyLimits.h"
+#include "../DataStructs/ExtraTaskSettingsStruct.h"
+#include "../DataTypes/TaskIndex.h"
+
+#include <vector>
+
+
+// Maximum number of task settings kept in RAM.
+#ifndef EXTRA_TASK_SETTINGS_CACHE_MAX
+# ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_CACHE_MAX       TASKS_MAX
+# else // ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_CACHE_MAX       8
+# endif // ifdef ESP32
+#endif // ifndef EXTRA_TASK_SETTINGS_CACHE_MAX
+
+// Only add more entries while the largest free heap block is larger than this.
+// Otherwise the least recently used entry is replaced.
+#ifndef EXTRA_TASK_SETTINGS_CACHE_MIN_FREE
+# define EXTRA_TASK_SETTINGS_CACHE_MIN_FREE  8000
+#endif // ifndef EXTRA_TASK_SETTINGS_CACHE_MIN_FREE
+
+
+/*********************************************************************************************\
+* ExtraTaskSettingsCache
+* Keeps the most recently loaded ExtraTaskSettings of several tasks in RAM,
+* so switching between tasks does not need to read the settings from the file system.
+* Settings are stored in a compact form, only storing the used part of the strings.
+*
+* The task name, value names and number of decimals are kept for all tasks, also when the settings
+* are no longer cached. For pages listing all tasks (e.g. /metrics) without loading the task settings of each task.
+\*********************************************************************************************/
+class ExtraTaskSettingsCache {
+public:
+
+  struct TaskNames {
+    String  taskName;
+    String  valueNames[VARS_PER_TASK];
+    uint8_t decimals[VARS_PER_TASK] = { 0 };
+    bool    loaded                  = false;
+  };
+
+  // Copy the cached settings of the task into extraTaskSettings.
+  // Return false when the task is not cached.
+  bool load(taskIndex_t              taskIndex,
+            ExtraTaskSettingsStruct& extraTaskSettings);
+
+  // Store the settings just loaded from the file system.
+  void store(const ExtraTaskSettingsStruct& extraTaskSettings);
+
+  // Return the names of the task, only loading the task settings when not yet known.
+  // Return nullptr for an invalid task index.
+  const TaskNames* getTaskNames(taskIndex_t taskIndex);
+
+  // Remove a single task, e.g. when its settings are saved.
+  void clear(taskIndex_t taskIndex);
+
+  void clear();
+
+private:
+
+  struct Entry {
+    std::vector<uint8_t> data;
+    uint32_t             lastUsed  = 0;
+    taskIndex_t          taskIndex = INVALID_TASK_INDEX;
+  };
+
+  void        storeNames(const ExtraTaskSettingsStruct& extraTaskSettings);
+
+  static void pack(const ExtraTaskSettingsStruct& extraTaskSettings,
+                   std::vector<uint8_t>         & data);
+
+  static void unpack(const std::vector<uint8_t>& data,
+                     ExtraTaskSettingsStruct   & extraTaskSettings);
+
+  std::vector<Entry>     _entries;
+  std::vector<TaskNames> _names; // Indexed by task index
+  uint32_t               _useCounter = 0;
+};
+
+
+#endif // DATASTRUCTS_EXTRATASKSETTINGSCACHE_H
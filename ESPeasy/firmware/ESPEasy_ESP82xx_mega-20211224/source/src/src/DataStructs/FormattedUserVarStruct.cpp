@@ -0,0 +1,69 @@
+#include "../DataStructs/FormattedUserVarStruct.h"
+
+#include "../DataStructs/ESPEasy_EventStruct.h"
+#include "../Globals/RuntimeData.h"
+#include "../Helpers/Numerical.h"
+#include "../Helpers/StringConverter.h"
+#include "../../_Plugin_Helper.h"
+
+
+FormattedUserVarStruct::FormattedUserVarStruct(struct EventStruct *event)
+{
+  if (event == nullptr) { return; }
+  TaskIndex  = event->TaskIndex;
+  sensorType = event->sensorType;
+  valueCount = getValueCountForTask(TaskIndex);
+
+  bool checkFloat = true;
+
+  switch (event->getSensorType()) {
+    case Sensor_VType::SENSOR_TYPE_LONG:
+    case Sensor_VType::SENSOR_TYPE_STRING:
+      checkFloat = false;
+      break;
+    default:
+      break;
+  }
+
+  for (uint8_t i = 0; i < valueCount && i < VARS_PER_TASK; ++i) {
+    txt[i] = formatUserVarUncached(event, i, false, isvalid[i]);
+
+    if (checkFloat && !isValidFloat(UserVar[event->BaseVarIndex + i])) {
+      // Would be formatted differently when checked
+      isvalid[i] = false;
+    }
+  }
+}
+
+bool FormattedUserVarStruct::matches(const struct EventStruct *event) const
+{
+  return event != nullptr &&
+         event->TaskIndex == TaskIndex &&
+         event->sensorType == sensorType;
+}
+
+size_t FormattedUserVarStruct::getSize() const
+{
+  size_t total = sizeof(*this);
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    total += txt[i].length();
+  }
+  return total;
+}
+
+bool FormattedUserVarStruct::equals(const FormattedUserVarStruct& other) const
+{
+  if ((other.TaskIndex != TaskIndex) ||
+      (other.sensorType != sensorType) ||
+      (other.valueCount != valueCount)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    if (other.txt[i] != txt[i]) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,40 @@
+#ifndef DATASTRUCTS_FORMATTEDUSERVARSTRUCT_H
+#define DATASTRUCTS_FORMATTEDUSERVARSTRUCT_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../DataStructs/DeviceStruct.h"
+#include "../Globals/Plugins.h"
+
+#include <memory> // For std::shared_ptr
+
+struct EventStruct;
+
+/*********************************************************************************************\
+* FormattedUserVarStruct
+* All values of a task, formatted according to the task settings.
+* Created once per sendData() call and shared by all controllers and their delay queues.
+\*********************************************************************************************/
+struct FormattedUserVarStruct {
+  explicit FormattedUserVarStruct(struct EventStruct *event);
+
+  // Check if the values were formatted for the same task and sensor type as the event.
+  bool   matches(const struct EventStruct *event) const;
+
+  size_t getSize() const;
+
+  bool   equals(const FormattedUserVarStruct& other) const;
+
+  String       txt[VARS_PER_TASK];
+
+  // Set when the value is formatted the same, whether or not the value is checked.
+  bool         isvalid[VARS_PER_TASK] = { false };
+  taskIndex_t  TaskIndex              = INVALID_TASK_INDEX;
+  Sensor_VType sensorType             = Sensor_VType::SENSOR_TYPE_NONE;
+  uint8_t      valueCount             = 0;
+};
+
+typedef std::shared_ptr<const FormattedUserVarStruct> FormattedUserVar_ptr;
+
+
+#endif // DATASTRUCTS_FORMATTEDUSERVARSTRUCT_H
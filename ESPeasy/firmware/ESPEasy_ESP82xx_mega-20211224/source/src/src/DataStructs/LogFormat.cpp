@@ -0,0 +1,284 @@
+#include "../DataStructs/LogFormat.h"
+
+#include "../Helpers/Convert.h"
+#include "../Helpers/StringConverter.h"
+
+#define LOG_FORMAT_STRING(name, format) static const char LogFormat_ ## name[] PROGMEM = format;
+LOG_FORMAT_LIST(LOG_FORMAT_STRING)
+#undef LOG_FORMAT_STRING
+
+static const char * const LogFormat_table[] PROGMEM = {
+#define LOG_FORMAT_TABLE_ENTRY(name, format) LogFormat_ ## name,
+  LOG_FORMAT_LIST(LOG_FORMAT_TABLE_ENTRY)
+#undef LOG_FORMAT_TABLE_ENTRY
+};
+
+
+LogFormat::LogFormat(Id id) {
+  const uint16_t id_value = static_cast<uint16_t>(id);
+
+  _data[0] = id_value & 0xFF;
+  _data[1] = id_value >> 8;
+  _length  = 2;
+}
+
+void LogFormat::add(float value) {
+  uint8_t bytes[4];
+
+  memcpy(bytes, &value, sizeof(bytes));
+  addBytes(ArgType::Float, bytes, sizeof(bytes));
+}
+
+void LogFormat::add(const char *value) {
+  if (value == nullptr) {
+    value = "";
+  }
+  addString(value, strlen(value), false);
+}
+
+void LogFormat::add(const __FlashStringHelper *value) {
+  PGM_P str = reinterpret_cast<PGM_P>(value);
+
+  if (str == nullptr) {
+    addString("", 0, false);
+    return;
+  }
+  addString(str, strlen_P(str), true);
+}
+
+void LogFormat::add(const String& value) {
+  addString(value.c_str(), value.length(), false);
+}
+
+void LogFormat::add(const IPAddress& value) {
+  const uint8_t bytes[4] = { value[0], value[1], value[2], value[3] };
+
+  addBytes(ArgType::IP, bytes, sizeof(bytes));
+}
+
+void LogFormat::add(const MAC_address& value) {
+  addBytes(ArgType::MAC, value.mac, sizeof(value.mac));
+}
+
+void LogFormat::addUnsigned(uint32_t value) {
+  const uint8_t bytes[4] = {
+    static_cast<uint8_t>(value & 0xFF),
+    static_cast<uint8_t>((value >> 8) & 0xFF),
+    static_cast<uint8_t>((value >> 16) & 0xFF),
+    static_cast<uint8_t>(value >> 24)
+  };
+
+  addBytes(ArgType::Unsigned, bytes, sizeof(bytes));
+}
+
+void LogFormat::addSigned(int32_t value) {
+  const uint32_t tmp      = static_cast<uint32_t>(value);
+  const uint8_t  bytes[4] = {
+    static_cast<uint8_t>(tmp & 0xFF),
+    static_cast<uint8_t>((tmp >> 8) & 0xFF),
+    static_cast<uint8_t>((tmp >> 16) & 0xFF),
+    static_cast<uint8_t>(tmp >> 24)
+  };
+
+  addBytes(ArgType::Signed, bytes, sizeof(bytes));
+}
+
+void LogFormat::addString(const char *value, size_t length, bool progmem) {
+  if (length > LOG_FORMAT_MAX_STRING_SIZE) {
+    length = LOG_FORMAT_MAX_STRING_SIZE;
+  }
+
+  if (_truncated || ((_length + 2u + length) > LOG_FORMAT_MAX_SIZE)) {
+    // Does not fit, also skip all next arguments to keep them in order.
+    _truncated = true;
+    return;
+  }
+  _data[_length++] = static_cast<uint8_t>(ArgType::String);
+  _data[_length++] = static_cast<uint8_t>(length);
+
+  if (progmem) {
+    memcpy_P(&_data[_length], value, length);
+  } else {
+    memcpy(&_data[_length], value, length);
+  }
+  _length += length;
+}
+
+void LogFormat::addBytes(ArgType type, const uint8_t *bytes, size_t length) {
+  if (_truncated || ((_length + 1u + length) > LOG_FORMAT_MAX_SIZE)) {
+    // Does not fit, also skip all next arguments to keep them in order.
+    _truncated = true;
+    return;
+  }
+  _data[_length++] = static_cast<uint8_t>(type);
+  memcpy(&_data[_length], bytes, length);
+  _length += length;
+}
+
+const __FlashStringHelper * LogFormat::getFormat(Id id) {
+  const uint16_t index = static_cast<uint16_t>(id);
+
+  if (index >= static_cast<uint16_t>(Id::NrFormats)) {
+    return nullptr;
+  }
+  return reinterpret_cast<const __FlashStringHelper *>(pgm_read_ptr(&LogFormat_table[index]));
+}
+
+namespace {
+// Reads the encoded arguments one by one.
+struct LogFormatReader {
+  LogFormatReader(const uint8_t *data, size_t length) : _data(data), _length(length) {}
+
+  // Return nullptr when no argument of the expected size is left.
+  const uint8_t* next(LogFormat::ArgType& type, size_t& size) {
+    if (_pos >= _length) {
+      return nullptr;
+    }
+    type = static_cast<LogFormat::ArgType>(_data[_pos++]);
+
+    switch (type) {
+      case LogFormat::ArgType::Unsigned:
+      case LogFormat::ArgType::Signed:
+      case LogFormat::ArgType::Float:
+      case LogFormat::ArgType::IP:
+        size = 4;
+        break;
+      case LogFormat::ArgType::MAC:
+        size = 6;
+        break;
+      case LogFormat::ArgType::String:
+
+        if (_pos >= _length) {
+          return nullptr;
+        }
+        size = _data[_pos++];
+        break;
+      default:
+        // Unknown type, the rest can not be decoded
+        _pos = _length;
+        return nullptr;
+    }
+
+    if ((_pos + size) > _length) {
+      _pos = _length;
+      return nullptr;
+    }
+    const uint8_t *res = &_data[_pos];
+
+    _pos += size;
+    return res;
+  }
+
+  const uint8_t *_data;
+  size_t         _length;
+  size_t         _pos = 2; // Skip format ID
+};
+
+uint32_t getUInt32(const uint8_t *bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+void appendPadded(String& message, const String& value, uint8_t width, bool zeroPad) {
+  for (size_t i = value.length(); i < width; ++i) {
+    message += zeroPad ? '0' : ' ';
+  }
+  message += value;
+}
+}
+
+void LogFormat::format(const uint8_t *data, size_t length, String& message) {
+  if (length < 2) {
+    return;
+  }
+  const Id id  = static_cast<Id>(data[0] | (data[1] << 8));
+  PGM_P    fmt = reinterpret_cast<PGM_P>(getFormat(id));
+
+  if (fmt == nullptr) {
+    message += F("Unknown log format ");
+    message += static_cast<uint16_t>(id);
+    return;
+  }
+  LogFormatReader reader(data, length);
+
+  for (char c = pgm_read_byte(fmt); c != 0; c = pgm_read_byte(++fmt)) {
+    if (c != '%') {
+      message += c;
+      continue;
+    }
+    c = pgm_read_byte(++fmt);
+
+    if (c == '%') {
+      message += c;
+      continue;
+    }
+    bool    zeroPad   = false;
+    uint8_t width     = 0;
+    uint8_t precision = 2;
+
+    if (c == '0') {
+      zeroPad = true;
+      c       = pgm_read_byte(++fmt);
+    }
+
+    while (isdigit(c)) {
+      width = width * 10 + (c - '0');
+      c     = pgm_read_byte(++fmt);
+    }
+
+    if (c == '.') {
+      precision = 0;
+      c         = pgm_read_byte(++fmt);
+
+      while (isdigit(c)) {
+        precision = precision * 10 + (c - '0');
+        c         = pgm_read_byte(++fmt);
+      }
+    }
+
+    if (c == 0) {
+      return;
+    }
+    ArgType type;
+    size_t  size       = 0;
+    const uint8_t *arg = reader.next(type, size);
+
+    if (arg == nullptr) {
+      message += '?';
+      continue;
+    }
+    String value;
+
+    switch (type) {
+      case ArgType::Unsigned:
+        value = (c == 'x') ? String(getUInt32(arg), HEX) : String(getUInt32(arg));
+        break;
+      case ArgType::Signed:
+        value = String(static_cast<int32_t>(getUInt32(arg)));
+        break;
+      case ArgType::Float:
+      {
+        float f;
+        memcpy(&f, arg, sizeof(f));
+        value = toString(f, precision);
+        break;
+      }
+      case ArgType::String:
+        value.reserve(size);
+
+        for (size_t i = 0; i < size; ++i) {
+          value += static_cast<char>(arg[i]);
+        }
+        break;
+      case ArgType::IP:
+        value = formatIP(IPAddress(arg[0], arg[1], arg[2], arg[3]));
+        break;
+      case ArgType::MAC:
+        value = MAC_address(arg).toString();
+        break;
+    }
+    appendPadded(message, value, width, zeroPad);
+  }
+}
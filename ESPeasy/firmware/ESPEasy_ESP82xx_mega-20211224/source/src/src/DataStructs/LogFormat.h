@@ -0,0 +1,119 @@
+#ifndef DATASTRUCTS_LOGFORMAT_H
+#define DATASTRUCTS_LOGFORMAT_H
+
+#include "../../ESPEasy_common.h"
+
+#include <IPAddress.h>
+
+#include "../DataStructs/MAC_address.h"
+
+/*********************************************************************************************\
+ * Deferred log formatting
+ * Instead of building a String at the call site, a log line is stored as a format ID
+ * plus its arguments in binary form. The line is only formatted when a log destination
+ * reads it from the log buffer.
+ *
+ * Format specifiers (optional zero padding and width, e.g. %03u, and precision for float, e.g. %.2f):
+ *   %u  unsigned integer
+ *   %d  signed integer
+ *   %x  unsigned integer as hex
+ *   %f  float (default 2 decimals)
+ *   %s  string
+ *   %I  IP address
+ *   %M  MAC address
+ *   %%  literal '%'
+ *
+ * IDs are the index in LOG_FORMAT_LIST, so only append new formats at the end.
+ * tools/log_decoder.py reads this list to decode a log dump (see /logdump).
+\*********************************************************************************************/
+#define LOG_FORMAT_LIST(X)                                                                      \
+  X(ControllerQueueMemory, "Controller-%u : Memory used: %u bytes %u items %u free")            \
+  X(ControllerQueueFull,   "C%03u : queue full")                                                \
+  X(UDP_SysInfoReceived,   "UDP  : %M,%I,%u")                                                   \
+  X(UDP_SendMessage,       "UDP  : Send UDP message to %u")
+
+// Max. size of the encoded format ID + arguments
+#ifndef LOG_FORMAT_MAX_SIZE
+# define LOG_FORMAT_MAX_SIZE 64
+#endif // ifndef LOG_FORMAT_MAX_SIZE
+
+// Max. length of a string argument
+#ifndef LOG_FORMAT_MAX_STRING_SIZE
+# define LOG_FORMAT_MAX_STRING_SIZE 32
+#endif // ifndef LOG_FORMAT_MAX_STRING_SIZE
+
+
+struct LogFormat {
+  enum class Id : uint16_t {
+#define LOG_FORMAT_ENUM(name, format) name,
+    LOG_FORMAT_LIST(LOG_FORMAT_ENUM)
+#undef LOG_FORMAT_ENUM
+
+    NrFormats // Keep as last
+  };
+
+  // Type tag stored in front of each argument
+  enum class ArgType : uint8_t {
+    Unsigned = 'u', // 4 bytes
+    Signed   = 'd', // 4 bytes
+    Float    = 'f', // 4 bytes
+    String   = 's', // length byte + characters
+    IP       = 'I', // 4 bytes
+    MAC      = 'M'  // 6 bytes
+  };
+
+  LogFormat(Id id);
+
+  void add(uint8_t value)       { addUnsigned(value); }
+  void add(uint16_t value)      { addUnsigned(value); }
+  void add(unsigned int value)  { addUnsigned(value); }
+  void add(unsigned long value) { addUnsigned(value); }
+  void add(int8_t value)        { addSigned(value); }
+  void add(int16_t value)       { addSigned(value); }
+  void add(int value)           { addSigned(value); }
+  void add(long value)          { addSigned(value); }
+  void add(float value);
+  void add(double value)        { add(static_cast<float>(value)); }
+  void add(const char *value);
+  void add(const __FlashStringHelper *value);
+  void add(const String& value);
+  void add(const IPAddress& value);
+  void add(const MAC_address& value);
+
+  const uint8_t* data() const {
+    return _data;
+  }
+
+  size_t length() const {
+    return _length;
+  }
+
+  // True when an argument did not fit.
+  // That argument and all next ones are left out and will be shown as '?'
+  bool truncated() const {
+    return _truncated;
+  }
+
+  // Format an encoded log line.
+  // Arguments missing in the data (e.g. when they did not fit) are shown as '?'
+  static void format(const uint8_t *data, size_t length, String& message);
+
+  static const __FlashStringHelper* getFormat(Id id);
+
+private:
+
+  void addUnsigned(uint32_t value);
+
+  void addSigned(int32_t value);
+
+  void addString(const char *value, size_t length, bool progmem);
+
+  void addBytes(ArgType type, const uint8_t *bytes, size_t length);
+
+  uint8_t _data[LOG_FORMAT_MAX_SIZE];
+  uint8_t _length    = 0;
+  bool    _truncated = false;
+};
+
+
+#endif // DATASTRUCTS_LOGFORMAT_H
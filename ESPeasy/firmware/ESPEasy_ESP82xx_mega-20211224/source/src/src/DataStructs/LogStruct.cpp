@@ -1,99 +1,328 @@
 #include "../DataStructs/LogStruct.h"
 
+#include "../Globals/Settings.h"
 #include "../Helpers/ESPEasy_time_calc.h"
 #include "../Helpers/StringConverter.h"
 
+#ifdef ESP32
+# include <freertos/FreeRTOS.h>
+# include <freertos/semphr.h>
+#endif // ifdef ESP32
 
+// Length + log level + timestamp
+#define LOG_STRUCT_RECORD_HEADER_SIZE 7
+
+// Set in the log level byte when the record holds a LogFormat
+#define LOG_STRUCT_DEFERRED_FORMAT    0x80
+
+static_assert((LOG_STRUCT_BUFFER_SIZE & (LOG_STRUCT_BUFFER_SIZE - 1)) == 0, "LOG_STRUCT_BUFFER_SIZE must be a power of 2");
+static_assert(LOG_STRUCT_MESSAGE_SIZE <= 0xFFFF, "LOG_STRUCT_MESSAGE_SIZE must fit in 16 bit");
+static_assert(LOG_FORMAT_MAX_SIZE <= LOG_STRUCT_MESSAGE_SIZE, "LOG_FORMAT_MAX_SIZE must fit in a log record");
 
-void LogStruct::add(const uint8_t loglevel, const char *line) {
-  write_idx = (write_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
 
-  if (write_idx == read_idx) {
-    // Buffer full, move read_idx to overwrite oldest entry.
-    read_idx = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
+/*********************************************************************************************\
+ * Lock to access the log buffer.
+ * On ESP8266 everything runs from the same context, so no lock is needed.
+\*********************************************************************************************/
+#ifdef ESP32
+// Created on first use, as log calls may already be made from other global constructors.
+static SemaphoreHandle_t getLogStructMutex() {
+  static StaticSemaphore_t logStructMutexBuffer;
+  static SemaphoreHandle_t logStructMutex = xSemaphoreCreateMutexStatic(&logStructMutexBuffer);
+
+  return logStructMutex;
+}
+
+struct LogStructLock {
+  LogStructLock() : _mutex(getLogStructMutex()) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+  }
+
+  ~LogStructLock() {
+    xSemaphoreGive(_mutex);
   }
-  timeStamp[write_idx] = millis();
-  log_level[write_idx] = loglevel;
 
+private:
+
+  SemaphoreHandle_t _mutex;
+};
+#else // ifdef ESP32
+struct LogStructLock {
+  LogStructLock() {}
+};
+#endif // ifdef ESP32
+
+
+void LogStruct::add(const uint8_t loglevel, const char *line) {
   // Must use PROGMEM aware functions here to process line
-  unsigned int linelength = strlen_P(line);
+  size_t linelength = strlen_P(line);
 
-  if (linelength > LOG_STRUCT_MESSAGE_SIZE - 1) {
-    linelength = LOG_STRUCT_MESSAGE_SIZE - 1;
-  }
-  Message[write_idx] = "";
-  if (!Message[write_idx].reserve(linelength)) {
-    return;
+  if (linelength > LOG_STRUCT_MESSAGE_SIZE) {
+    linelength = LOG_STRUCT_MESSAGE_SIZE;
   }
+  addRecord(loglevel, reinterpret_cast<const uint8_t *>(line), linelength, true);
+}
+
+void LogStruct::add(const uint8_t loglevel, const LogFormat& line) {
+  addRecord(loglevel | LOG_STRUCT_DEFERRED_FORMAT, line.data(), line.length(), false);
+}
+
+void LogStruct::addRecord(const uint8_t levelByte, const uint8_t *data, size_t length, bool progmem) {
+  const uint32_t timestamp = millis();
+  const uint8_t  header[LOG_STRUCT_RECORD_HEADER_SIZE] = {
+    static_cast<uint8_t>(length & 0xFF),
+    static_cast<uint8_t>(length >> 8),
+    levelByte,
+    static_cast<uint8_t>(timestamp & 0xFF),
+    static_cast<uint8_t>((timestamp >> 8) & 0xFF),
+    static_cast<uint8_t>((timestamp >> 16) & 0xFF),
+    static_cast<uint8_t>(timestamp >> 24)
+  };
+
+  LogStructLock lock;
 
-  const char* c = line;
-  for (unsigned i = 0; i < linelength; ++i) {
-    Message[write_idx] += static_cast<char>(pgm_read_byte(c++));
+  while ((LOG_STRUCT_BUFFER_SIZE - (_writePos - _tailPos)) < (LOG_STRUCT_RECORD_HEADER_SIZE + length)) {
+    dropOldest();
   }
+  write(header, LOG_STRUCT_RECORD_HEADER_SIZE, false);
+  write(data,   length,                        progmem);
+  ++_writeSeq;
 }
 
-// Read the next item and append it to the given string.
-// Returns whether new lines are available.
-bool LogStruct::get(String& output, const String& lineEnd) {
-  lastReadTimeStamp = millis();
+bool LogStruct::getNext(Sink sink, uint8_t maxLevel, unsigned long& timestamp, String& message, uint8_t& loglevel) {
+  SinkCursor& cursor = _cursors[static_cast<uint8_t>(sink)];
+
+  cursor.maxLevel = maxLevel;
+
+  while (true) {
+    uint16_t length   = 0;
+    bool     deferred = false;
+    uint8_t  formatData[LOG_FORMAT_MAX_SIZE];
+    {
+      LogStructLock lock;
+
+      if (cursor.seq == _writeSeq) {
+        return false;
+      }
+      uint8_t header[LOG_STRUCT_RECORD_HEADER_SIZE];
+      read(cursor.pos, header, LOG_STRUCT_RECORD_HEADER_SIZE);
+      length = header[0] | (header[1] << 8);
+
+      if ((header[2] & ~LOG_STRUCT_DEFERRED_FORMAT) > maxLevel) {
+        // Not for this sink
+        cursor.pos += LOG_STRUCT_RECORD_HEADER_SIZE + length;
+        ++cursor.seq;
+        continue;
+      }
+      deferred = header[2] & LOG_STRUCT_DEFERRED_FORMAT;
+
+      if (deferred) {
+        // Copy the record, it is formatted after releasing the lock.
+        loglevel  = header[2] & ~LOG_STRUCT_DEFERRED_FORMAT;
+        timestamp = getTimestamp(header);
+        read(cursor.pos + LOG_STRUCT_RECORD_HEADER_SIZE, formatData, length);
+        cursor.pos += LOG_STRUCT_RECORD_HEADER_SIZE + length;
+        ++cursor.seq;
+      }
+    }
+
+    if (deferred) {
+      message = String();
+      LogFormat::format(formatData, length, message);
+      return true;
+    }
+
+    // Do not allocate memory while holding the lock.
+    message = String();
+
+    if (!message.reserve(length)) {
+      LogStructLock lock;
+      if (cursor.seq != _writeSeq) {
+        cursor.pos += LOG_STRUCT_RECORD_HEADER_SIZE + getRecordLength(cursor.pos);
+        ++cursor.seq;
+        ++cursor.lost;
+      }
+      return false;
+    }
+
+    LogStructLock lock;
+
+    if ((cursor.seq == _writeSeq) || (getRecordLength(cursor.pos) != length)) {
+      // Record was overwritten while reserving memory, try again.
+      continue;
+    }
+    uint8_t header[LOG_STRUCT_RECORD_HEADER_SIZE];
+    read(cursor.pos, header, LOG_STRUCT_RECORD_HEADER_SIZE);
+
+    if (header[2] > maxLevel) {
+      // Another record, including one with LOG_STRUCT_DEFERRED_FORMAT set
+      continue;
+    }
+    loglevel  = header[2];
+    timestamp = getTimestamp(header);
+
+    uint32_t pos = cursor.pos + LOG_STRUCT_RECORD_HEADER_SIZE;
 
-  if (!isEmpty()) {
-    read_idx = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-    output  += formatLine(read_idx, lineEnd);
+    for (uint16_t i = 0; i < length; ++i, ++pos) {
+      message += static_cast<char>(_buffer[pos & (LOG_STRUCT_BUFFER_SIZE - 1)]);
+    }
+    cursor.pos = pos;
+    ++cursor.seq;
+    return true;
   }
-  return !isEmpty();
 }
 
 bool LogStruct::getNext(bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel) {
+  if (!logActiveRead()) {
+    // Not read for a while, so lines not read are not lost but not needed.
+    LogStructLock lock;
+    SinkCursor& cursor = _cursors[static_cast<uint8_t>(Sink::Web)];
+    cursor.pos = _tailPos;
+    cursor.seq = _tailSeq;
+  }
   lastReadTimeStamp = millis();
-  logLinesAvailable = false;
+  const bool res = getNext(Sink::Web, Settings.WebLogLevel, timestamp, message, loglevel);
+  logLinesAvailable = res && available(Sink::Web);
+  return res;
+}
+
+bool LogStruct::available(Sink sink) const {
+  LogStructLock lock;
+  return _cursors[static_cast<uint8_t>(sink)].seq != _writeSeq;
+}
+
+void LogStruct::skipAll(Sink sink) {
+  LogStructLock lock;
+  SinkCursor& cursor = _cursors[static_cast<uint8_t>(sink)];
+
+  cursor.pos      = _writePos;
+  cursor.seq      = _writeSeq;
+  cursor.maxLevel = 0;
+}
+
+uint32_t LogStruct::getLostCount(Sink sink) const {
+  return _cursors[static_cast<uint8_t>(sink)].lost;
+}
+
+void LogStruct::markLost(Sink sink) {
+  ++_cursors[static_cast<uint8_t>(sink)].lost;
+}
 
-  if (isEmpty()) {
-    return false;
+void LogStruct::dump(void (*writeLine)(const String& line)) {
+  static const char hexDigits[] = "0123456789ABCDEF";
+  uint32_t pos;
+  uint32_t seq;
+  {
+    LogStructLock lock;
+    pos = _tailPos;
+    seq = _tailSeq;
   }
-  read_idx  = (read_idx + 1) % LOG_STRUCT_MESSAGE_LINES;
-  timestamp = timeStamp[read_idx];
-  message = Message[read_idx];
-  loglevel = log_level[read_idx];
-  if (!isEmpty()) { 
-    logLinesAvailable = true;
+
+  while (true) {
+    uint8_t  record[LOG_STRUCT_RECORD_HEADER_SIZE + LOG_STRUCT_MESSAGE_SIZE];
+    uint16_t length = 0;
+    {
+      LogStructLock lock;
+
+      // Unsigned difference, also correct when the counters wrap around.
+      if ((seq - _tailSeq) > (_writeSeq - _tailSeq)) {
+        // Overwritten while sending, continue at the oldest record
+        pos = _tailPos;
+        seq = _tailSeq;
+      }
+
+      if (seq == _writeSeq) {
+        return;
+      }
+      length = LOG_STRUCT_RECORD_HEADER_SIZE + getRecordLength(pos);
+      read(pos, record, length);
+      pos += length;
+      ++seq;
+    }
+    String line;
+
+    if (line.reserve(2 * length)) {
+      for (uint16_t i = 0; i < length; ++i) {
+        line += hexDigits[record[i] >> 4];
+        line += hexDigits[record[i] & 0x0F];
+      }
+      writeLine(line);
+    }
   }
-  return true;
 }
 
 bool LogStruct::isEmpty() {
-  return write_idx == read_idx;
+  return _writeSeq == _tailSeq;
 }
 
 bool LogStruct::logActiveRead() {
-  clearExpiredEntries();
   return timePassedSince(lastReadTimeStamp) < LOG_BUFFER_EXPIRE;
 }
 
-String LogStruct::formatLine(int index, const String& lineEnd) {
-  String output;
+void LogStruct::dropOldest() {
+  uint8_t header[LOG_STRUCT_RECORD_HEADER_SIZE];
 
-  output += timeStamp[index];
-  output += " : ";
-  output += Message[index];
-  output += lineEnd;
-  return output;
-}
+  read(_tailPos, header, LOG_STRUCT_RECORD_HEADER_SIZE);
+  const uint32_t recordSize = LOG_STRUCT_RECORD_HEADER_SIZE + (header[0] | (header[1] << 8));
+  const uint8_t  loglevel   = header[2] & ~LOG_STRUCT_DEFERRED_FORMAT;
+
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Sink::NrSinks); ++i) {
+    SinkCursor& cursor = _cursors[i];
+
+    if (cursor.seq == _tailSeq) {
+      // Not yet read by the sink.
+      cursor.pos += recordSize;
+      ++cursor.seq;
 
-void LogStruct::clearExpiredEntries() {
-  if (isEmpty()) {
-    return;
+      // The web log does not lose lines when nobody is viewing it.
+      const bool sinkActive = (i != static_cast<uint8_t>(Sink::Web)) || logActiveRead();
+
+      if (sinkActive && (loglevel <= cursor.maxLevel)) {
+        ++cursor.lost;
+      }
+    }
   }
+  _tailPos += recordSize;
+  ++_tailSeq;
+}
+
+void LogStruct::write(const uint8_t *data, size_t length, bool progmem) {
+  // Copy in at most 2 blocks, split at the end of the buffer.
+  while (length > 0) {
+    const size_t index = _writePos & (LOG_STRUCT_BUFFER_SIZE - 1);
+    size_t block       = LOG_STRUCT_BUFFER_SIZE - index;
+
+    if (block > length) {
+      block = length;
+    }
 
-  if (timePassedSince(lastReadTimeStamp) > LOG_BUFFER_EXPIRE) {
-    // Clear the entire log.
-    // If web log is the only log active, it will not be checked again until it is read.
-    for (read_idx = 0; read_idx < LOG_STRUCT_MESSAGE_LINES; ++read_idx) {
-      Message[read_idx]   = String(); // Free also the reserved memory.
-      timeStamp[read_idx] = 0;
-      log_level[read_idx] = 0;
+    if (progmem) {
+      memcpy_P(&_buffer[index], data, block);
+    } else {
+      memcpy(&_buffer[index], data, block);
     }
-    read_idx  = 0;
-    write_idx = 0;
+    data      += block;
+    length    -= block;
+    _writePos += block;
   }
 }
+
+void LogStruct::read(uint32_t pos, uint8_t *data, size_t length) const {
+  for (size_t i = 0; i < length; ++i, ++pos) {
+    data[i] = _buffer[pos & (LOG_STRUCT_BUFFER_SIZE - 1)];
+  }
+}
+
+unsigned long LogStruct::getTimestamp(const uint8_t *header) {
+  return static_cast<unsigned long>(header[3]) |
+         (static_cast<unsigned long>(header[4]) << 8) |
+         (static_cast<unsigned long>(header[5]) << 16) |
+         (static_cast<unsigned long>(header[6]) << 24);
+}
+
+uint16_t LogStruct::getRecordLength(uint32_t pos) const {
+  uint8_t length[2];
+
+  read(pos, length, 2);
+  return length[0] | (length[1] << 8);
+}
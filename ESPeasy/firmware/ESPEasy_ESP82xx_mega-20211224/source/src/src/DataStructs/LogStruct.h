@@ -5,50 +5,117 @@
 
 #include "../../ESPEasy_common.h"
 
+#include "../DataStructs/LogFormat.h"
+
 /*********************************************************************************************\
  * LogStruct
+ * Single ring buffer of log records, shared by all log destinations ("sinks").
+ * A record is stored as [length (2 bytes)][log level][timestamp (4 bytes)][message],
+ * so adding a line does not allocate memory.
+ * A message may also be stored as format ID + arguments (see LogFormat),
+ * which is only formatted when a sink reads it.
+ * Each sink keeps its own read cursor and reads the records at its own pace.
+ * When the buffer is full, the oldest records are overwritten. For each sink which did not
+ * yet read them, the cursor is moved past them and they are counted as lost when the sink
+ * would have output them (log level at most the level the sink last read with).
+ *
+ * On ESP32 the buffer is protected by a mutex, so lines may be added from other tasks.
 \*********************************************************************************************/
-#define LOG_STRUCT_MESSAGE_SIZE 128
+#ifndef LOG_STRUCT_BUFFER_SIZE
+  #ifdef ESP32
+    #define LOG_STRUCT_BUFFER_SIZE  4096
+  #else
+    #define LOG_STRUCT_BUFFER_SIZE  2048
+  #endif
+#endif
+
+// Longer lines are truncated.
+#define LOG_STRUCT_MESSAGE_SIZE     (LOG_STRUCT_BUFFER_SIZE / 4)
+
 #ifdef ESP32
-  #define LOG_STRUCT_MESSAGE_LINES 30
   #define LOG_BUFFER_EXPIRE         30000  // Time after which a buffered log item is considered expired.
 #else
-  #if defined(PLUGIN_BUILD_TESTING) || defined(PLUGIN_BUILD_DEV)
-    #define LOG_STRUCT_MESSAGE_LINES 10
-  #else
-    #define LOG_STRUCT_MESSAGE_LINES 15
-  #endif
   #define LOG_BUFFER_EXPIRE         5000  // Time after which a buffered log item is considered expired.
 #endif
 
 struct LogStruct {
-    
+    enum class Sink : uint8_t {
+      Serial,
+      Syslog,
+      Web,
+      SDcard,
+
+      NrSinks // Keep as last
+    };
+
+    // Copy the line (may be stored in PROGMEM) into the buffer.
     void add(const uint8_t loglevel, const char *line);
 
-    // Read the next item and append it to the given string.
-    // Returns whether new lines are available.
-    bool get(String& output, const String& lineEnd);
+    // Store the format ID + arguments, to be formatted when read.
+    void add(const uint8_t loglevel, const LogFormat& line);
+
+    // Read the next record for the sink with a log level of at most maxLevel.
+    // Records with a higher log level are skipped.
+    bool getNext(Sink sink, uint8_t maxLevel, unsigned long& timestamp, String& message, uint8_t& loglevel);
 
+    // Web log: read the next record, using the web log level.
     bool getNext(bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel);
 
+    // Return true when the sink has not yet read all records.
+    bool available(Sink sink) const;
+
+    // Mark all records as read for the sink, e.g. when the sink is disabled.
+    void skipAll(Sink sink);
+
+    // Number of records the sink did not output, as they were overwritten before being read
+    // or failed to send. Records with a log level above the sink's log level are not counted.
+    uint32_t getLostCount(Sink sink) const;
+
+    // Count a record the sink failed to output.
+    void markLost(Sink sink);
+
     bool isEmpty();
 
     bool logActiveRead();
 
+    // Copy all records as hex, one record per line, to be decoded by tools/log_decoder.py
+    // Record: [length (2 bytes)][log level][timestamp (4 bytes)][message or format ID + arguments]
+    void dump(void (*writeLine)(const String& line));
+
   private:
-    String formatLine(int index, const String& lineEnd);
+    struct SinkCursor {
+      uint32_t pos  = 0; // Position of the next record to read
+      uint32_t seq  = 0; // Sequence number of the next record to read
+      uint32_t lost = 0;
+      uint8_t  maxLevel = 0; // Log level of the last read, 0 (none) when the sink is not active
+    };
+
+    void addRecord(const uint8_t levelByte, const uint8_t *data, size_t length, bool progmem);
+
+    // Drop the oldest record, moving the cursors of the sinks which did not yet read it.
+    void dropOldest();
+
+    void write(const uint8_t *data, size_t length, bool progmem);
+
+    void read(uint32_t pos, uint8_t *data, size_t length) const;
+
+    uint16_t getRecordLength(uint32_t pos) const;
+
+    static unsigned long getTimestamp(const uint8_t *header);
+
+    uint8_t _buffer[LOG_STRUCT_BUFFER_SIZE];
 
-    void clearExpiredEntries();
+    // Absolute positions and sequence numbers, the buffer index is taken modulo the buffer size.
+    uint32_t _writePos = 0;
+    uint32_t _tailPos  = 0; // Position of the oldest record
+    uint32_t _writeSeq = 0;
+    uint32_t _tailSeq  = 0;
 
-    String Message[LOG_STRUCT_MESSAGE_LINES];
-    unsigned long timeStamp[LOG_STRUCT_MESSAGE_LINES] = {0};
-    int write_idx = 0;
-    int read_idx = 0;
     unsigned long lastReadTimeStamp = 0;
-    uint8_t log_level[LOG_STRUCT_MESSAGE_LINES] = {0};
 
+    SinkCursor _cursors[static_cast<uint8_t>(Sink::NrSinks)];
 };
 
 
 
-#endif // DATASTRUCTS_LOGSTRUCT_H
\ No newline at end of file
+#endif // DATASTRUCTS_LOGSTRUCT_H
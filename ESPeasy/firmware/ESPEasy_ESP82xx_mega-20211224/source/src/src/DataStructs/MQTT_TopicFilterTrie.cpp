@@ -0,0 +1,128 @@
+#include "../DataStructs/MQTT_TopicFilterTrie.h"
+
+
+#define MQTT_TOPIC_FILTER_ROOT  0
+#define MQTT_TOPIC_FILTER_NONE  0xFFFF
+
+
+MQTT_TopicFilterTrie::MQTT_TopicFilterTrie()
+{
+  clear();
+}
+
+void MQTT_TopicFilterTrie::add(const String& filter, uint16_t id)
+{
+  std::vector<String> levels;
+
+  if (!split(filter, levels)) {
+    return;
+  }
+  uint16_t node = MQTT_TOPIC_FILTER_ROOT;
+
+  for (auto it = levels.begin(); it != levels.end(); ++it) {
+    uint16_t child = getChild(node, *it);
+
+    if (child == MQTT_TOPIC_FILTER_NONE) {
+      child = _nodes.size();
+      _nodes.emplace_back();
+      _nodes.back().level = *it;
+      _nodes[node].children.push_back(child);
+    }
+    node = child;
+
+    if (it->equals(F("#"))) {
+      // Any further level in the filter is ignored
+      break;
+    }
+  }
+  _nodes[node].ids.push_back(id);
+}
+
+bool MQTT_TopicFilterTrie::match(const String& topic, std::vector<uint16_t>& ids) const
+{
+  std::vector<String> levels;
+
+  if (!split(topic, levels)) {
+    return false;
+  }
+  const size_t nrIds = ids.size();
+
+  match(MQTT_TOPIC_FILTER_ROOT, levels, 0, ids);
+  return ids.size() > nrIds;
+}
+
+void MQTT_TopicFilterTrie::clear()
+{
+  _nodes.clear();
+  _nodes.emplace_back();
+  _valid = false;
+}
+
+void MQTT_TopicFilterTrie::setValid()
+{
+  _valid = true;
+}
+
+bool MQTT_TopicFilterTrie::isValid() const
+{
+  return _valid;
+}
+
+bool MQTT_TopicFilterTrie::split(const String& topic, std::vector<String>& levels)
+{
+  if (topic.isEmpty()) {
+    return false;
+  }
+  String tmp = topic;
+
+  tmp.trim();
+
+  // Get rid of leading '/'
+  int start = (!tmp.isEmpty() && (tmp[0] == '/')) ? 1 : 0;
+
+  // A trailing '/' does not add a level.
+  int end = tmp.length();
+
+  if ((end > start) && (tmp[end - 1] == '/')) {
+    --end;
+  }
+
+  while (start <= end) {
+    int slash = tmp.indexOf('/', start);
+
+    if ((slash == -1) || (slash > end)) {
+      slash = end;
+    }
+    levels.push_back(tmp.substring(start, slash));
+    start = slash + 1;
+  }
+  return true;
+}
+
+uint16_t MQTT_TopicFilterTrie::getChild(uint16_t node, const String& level) const
+{
+  for (auto it = _nodes[node].children.begin(); it != _nodes[node].children.end(); ++it) {
+    if (_nodes[*it].level.equals(level)) {
+      return *it;
+    }
+  }
+  return MQTT_TOPIC_FILTER_NONE;
+}
+
+void MQTT_TopicFilterTrie::match(uint16_t node, const std::vector<String>& levels, size_t depth, std::vector<uint16_t>& ids) const
+{
+  if (depth == levels.size()) {
+    ids.insert(ids.end(), _nodes[node].ids.begin(), _nodes[node].ids.end());
+    return;
+  }
+
+  for (auto it = _nodes[node].children.begin(); it != _nodes[node].children.end(); ++it) {
+    const String& level = _nodes[*it].level;
+
+    if (level.equals(F("#"))) {
+      ids.insert(ids.end(), _nodes[*it].ids.begin(), _nodes[*it].ids.end());
+    } else if (level.equals(F("+")) || level.equals(levels[depth])) {
+      match(*it, levels, depth + 1, ids);
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef DATASTRUCTS_MQTT_TOPICFILTERTRIE_H
+#define DATASTRUCTS_MQTT_TOPICFILTERTRIE_H
+
+#include "../../ESPEasy_common.h"
+
+#include <vector>
+
+
+/*********************************************************************************************\
+* MQTT_TopicFilterTrie
+* Keeps a set of MQTT subscription filters (with '+' and '#' wildcards), split per topic level.
+* An incoming topic is matched against all filters at once, returning the IDs of the matching filters.
+*
+* Topics and filters are split the same way as P037 did before:
+* - leading and trailing spaces are ignored
+* - a single leading and a single trailing '/' are ignored
+* - '#' matches one or more remaining levels
+\*********************************************************************************************/
+class MQTT_TopicFilterTrie {
+public:
+
+  MQTT_TopicFilterTrie();
+
+  // Add a filter, the same filter may be added with different IDs.
+  void add(const String& filter,
+           uint16_t      id);
+
+  // Append the IDs of all filters matching the topic to ids.
+  // Return true when at least one filter matches.
+  bool match(const String         & topic,
+             std::vector<uint16_t>& ids) const;
+
+  // Remove all filters and mark as not valid.
+  void clear();
+
+  // Mark as valid, which means it is filled with all filters.
+  void setValid();
+
+  bool isValid() const;
+
+private:
+
+  struct Node {
+    String                level;
+    std::vector<uint16_t> children;
+    std::vector<uint16_t> ids;
+  };
+
+  static bool split(const String       & topic,
+                    std::vector<String>& levels);
+
+  uint16_t getChild(uint16_t      node,
+                    const String& level) const;
+
+  void     match(uint16_t                   node,
+                 const std::vector<String>& levels,
+                 size_t                     depth,
+                 std::vector<uint16_t>    & ids) const;
+
+  std::vector<Node> _nodes;
+  bool              _valid = false;
+};
+
+
+#endif // DATASTRUCTS_MQTT_TOPICFILTERTRIE_H
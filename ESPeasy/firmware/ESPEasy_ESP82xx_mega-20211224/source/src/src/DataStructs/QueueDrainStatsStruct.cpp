@@ -0,0 +1,62 @@
+#include "../DataStructs/QueueDrainStatsStruct.h"
+
+#include "../Helpers/ESPEasy_time_calc.h"
+
+
+void QueueDrainStatsStruct::start()
+{
+  if (isDraining()) {
+    return;
+  }
+  _start    = millis();
+  _messages = 0;
+  _bytes    = 0;
+
+  if (_start == 0) { _start = 1; }
+}
+
+void QueueDrainStatsStruct::add(uint32_t messages, uint32_t bytes)
+{
+  if (messages == 0) {
+    return;
+  }
+  start();
+  _messages     += messages;
+  _bytes        += bytes;
+  totalMessages += messages;
+  totalBytes    += bytes;
+
+  if (messages > maxBurst) {
+    maxBurst = messages;
+  }
+}
+
+void QueueDrainStatsStruct::finish()
+{
+  if (!isDraining()) {
+    return;
+  }
+  lastMessages = _messages;
+  lastBytes    = _bytes;
+  lastDuration = timePassedSince(_start);
+
+  if (lastDuration == 0) { lastDuration = 1; }
+  _start = 0;
+}
+
+bool QueueDrainStatsStruct::isDraining() const
+{
+  return _start != 0;
+}
+
+uint32_t QueueDrainStatsStruct::getMessagesPerSecond() const
+{
+  if (lastDuration == 0) { return 0; }
+  return (static_cast<uint64_t>(lastMessages) * 1000) / lastDuration;
+}
+
+uint32_t QueueDrainStatsStruct::getBytesPerSecond() const
+{
+  if (lastDuration == 0) { return 0; }
+  return (static_cast<uint64_t>(lastBytes) * 1000) / lastDuration;
+}
@@ -0,0 +1,45 @@
+#ifndef DATASTRUCTS_QUEUEDRAINSTATSSTRUCT_H
+#define DATASTRUCTS_QUEUEDRAINSTATSSTRUCT_H
+
+#include "../../ESPEasy_common.h"
+
+
+/*********************************************************************************************\
+* QueueDrainStatsStruct
+* Measures the throughput while emptying a controller queue.
+* A drain starts when the first run of the queue begins sending and ends when the queue is empty.
+\*********************************************************************************************/
+struct QueueDrainStatsStruct {
+  // Called before sending from a non-empty queue, starting a drain when not yet started.
+  // Must be called before the first message is sent, to include the time of the first burst.
+  void     start();
+
+  // Account a burst of messages sent in a single run of the queue.
+  void     add(uint32_t messages,
+               uint32_t bytes);
+
+  // Called when the queue is empty, finishing the current drain.
+  void     finish();
+
+  bool     isDraining() const;
+
+  // Throughput of the last finished drain.
+  uint32_t getMessagesPerSecond() const;
+  uint32_t getBytesPerSecond() const;
+
+  uint32_t lastMessages  = 0;
+  uint32_t lastBytes     = 0;
+  uint32_t lastDuration  = 0; // msec
+  uint32_t totalMessages = 0;
+  uint32_t totalBytes    = 0;
+  uint32_t maxBurst      = 0; // Max. messages sent in a single run
+
+private:
+
+  unsigned long _start    = 0;
+  uint32_t      _messages = 0;
+  uint32_t      _bytes    = 0;
+};
+
+
+#endif // DATASTRUCTS_QUEUEDRAINSTATSSTRUCT_H
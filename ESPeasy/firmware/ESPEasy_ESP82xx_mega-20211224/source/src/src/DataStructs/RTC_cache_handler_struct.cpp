@@ -5,7 +5,10 @@
 #include "../Helpers/CRC_functions.h"
 #include "../Helpers/ESPEasy_Storage.h"
 
+#include "../DataStructs/TimingStats.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Globals/Settings.h"
+#include "../Helpers/ESPEasy_time_calc.h"
 
 #ifdef ESP8266
 #include <user_interface.h>
@@ -57,14 +60,21 @@ void RTC_cache_handler_struct::resetpeek() {
   }
   peekfilenr  = 0;
   peekreadpos = 0;
+#ifdef USES_C016
+  _decoder.setFilter(C016_cache_filter());
+#endif
 }
 
-bool RTC_cache_handler_struct::peek(uint8_t *data, unsigned int size) {
-  int retries = 2;
-
-  while (retries > 0) {
-    --retries;
+#ifdef USES_C016
+void RTC_cache_handler_struct::setPeekFilter(const C016_cache_filter& filter) {
+  _decoder.setFilter(filter);
+}
+#endif
 
+bool RTC_cache_handler_struct::peek(uint8_t *data, unsigned int size) {
+  // Continue with the next file until a sample is read or no more files are present.
+  // With a filter set, several files may be skipped.
+  while (true) {
     if (!fp) {
       int tmppos;
       String fname;
@@ -79,16 +89,26 @@ bool RTC_cache_handler_struct::peek(uint8_t *data, unsigned int size) {
 
       if (fname.isEmpty()) { return false; }
       fp = tryOpenFile(fname, "r");
+#ifdef USES_C016
+      _decoder.reset();
+#endif
     }
 
     if (!fp) { return false; }
 
+#ifdef USES_C016
+    if (size == sizeof(C016_queue_element)) {
+      if (_decoder.read(fp, *reinterpret_cast<C016_queue_element *>(data))) {
+        return true;
+      }
+    } else
+#endif
     if (fp.read(data, size)) {
       return true;
     }
     fp.close();
   }
-  return true;
+  return false;
 }
 
 // Write a single sample set to the buffer
@@ -98,7 +118,10 @@ bool RTC_cache_handler_struct::write(const uint8_t *data, unsigned int size) {
     #endif // ifdef RTC_STRUCT_DEBUG
 
   if (getFreeSpace() < size) {
-    if (!flush()) {
+    // The write-behind did not finish before this sample arrived, so wait for it.
+    finishPendingWrite();
+
+    if ((getFreeSpace() < size) && !flush()) {
       return false;
     }
   }
@@ -128,50 +151,304 @@ bool RTC_cache_handler_struct::write(const uint8_t *data, unsigned int size) {
     // Can this happen?
     nrBytes = RTC_CACHE_DATA_SIZE - startOffset;
   }
-  return saveRTCcache(startOffset, nrBytes);
+
+  if (!saveRTCcache(startOffset, nrBytes)) {
+    return false;
+  }
+
+  if (getFreeSpace() < size) {
+    // The next sample will not fit, write the samples to the file system in small steps from backgroundtasks()
+    startWriteBehind();
+  }
+  return true;
 }
 
 // Mark all content as being processed and empty buffer.
 bool RTC_cache_handler_struct::flush() {
-  if (prepareFileForWrite()) {
-    if (RTC_cache.writePos > 0) {
-      #ifdef RTC_STRUCT_DEBUG
-      size_t filesize    = fw.size();
-      #endif
-      int    bytesWriten = fw.write(&RTC_cache_data[0], RTC_cache.writePos);
+  finishPendingWrite();
+  return startWriteBehind() && finishPendingWrite();
+}
 
-      delay(0);
-      fw.flush();
-        #ifdef RTC_STRUCT_DEBUG
-      addLog(LOG_LEVEL_INFO, F("RTC  : flush RTC cache"));
-        #endif // ifdef RTC_STRUCT_DEBUG
+bool RTC_cache_handler_struct::startWriteBehind() {
+  if ((_writeBehindState != WriteBehindState::Idle) &&
+      (_writeBehindState != WriteBehindState::Error)) {
+    return true;
+  }
+
+  if (RTC_cache.writePos == 0) {
+    return false;
+  }
+
+  // The samples stay in the RTC buffer, new samples are added behind them while writing.
+  _pendingLength = RTC_cache.writePos;
+  _pendingBlock.clear();
+  _pendingWritePos  = 0;
+  _openRetries      = 3;
+  _writeBehindState = WriteBehindState::CheckFile;
+  return true;
+}
+
+void RTC_cache_handler_struct::processWriteBehind() {
+  const unsigned long start = micros();
+
+  // Perform at least one step per call, but never start a new step when the time budget is used.
+  do {
+    if ((_writeBehindState == WriteBehindState::Idle) ||
+        (_writeBehindState == WriteBehindState::Error)) {
+      return;
+    }
+    processWriteBehindStep();
+  } while (usecPassedSince(start) < RTC_CACHE_WRITE_TIME_BUDGET);
+}
+
+bool RTC_cache_handler_struct::finishPendingWrite() {
+  if (_writeBehindState == WriteBehindState::Error) {
+    // Retry, garbage collection may have made some room.
+    _openRetries      = 3;
+    _writeBehindState = WriteBehindState::CheckFile;
+  }
+
+  while ((_writeBehindState != WriteBehindState::Idle) &&
+         (_writeBehindState != WriteBehindState::Error)) {
+    processWriteBehindStep();
+    delay(0);
+  }
+  return _writeBehindState == WriteBehindState::Idle;
+}
+
+#ifdef USES_TIMING_STATS
+int RTC_cache_handler_struct::getWriteBehindTimingStat(WriteBehindState state) {
+  switch (state) {
+    case WriteBehindState::CloseFile:      return RTC_CACHE_CLOSE_FILE;
+    case WriteBehindState::GarbageCollect:
+    case WriteBehindState::WriteFailed:    return RTC_CACHE_GC;
+    case WriteBehindState::DeleteOldest:   return RTC_CACHE_DELETE_FILE;
+    case WriteBehindState::OpenFile:       return RTC_CACHE_OPEN_FILE;
+    case WriteBehindState::FlushFile:      return RTC_CACHE_FLUSH_FILE;
+    default:
+      break;
+  }
+  return RTC_CACHE_WRITE_BEHIND;
+}
+
+#endif // ifdef USES_TIMING_STATS
 
+// Perform a single file system operation, so each step can be timed separately.
+void RTC_cache_handler_struct::processWriteBehindStep() {
+  START_TIMER;
+  #ifdef USES_TIMING_STATS
+  const int timingStat = getWriteBehindTimingStat(_writeBehindState);
+  #endif // ifdef USES_TIMING_STATS
 
-      if ((bytesWriten < RTC_cache.writePos) /*|| (fw.size() == filesize)*/) {
+  switch (_writeBehindState) {
+    case WriteBehindState::Idle:
+    case WriteBehindState::Error:
+      return;
+
+    case WriteBehindState::CheckFile:
+
+      if (SpiffsFull()) {
           #ifdef RTC_STRUCT_DEBUG
-        String log = F("RTC  : error writing file. Size before: ");
-        log += filesize;
-        log += F(" after: ");
+        addLog(LOG_LEVEL_ERROR, F("RTC  : FS full"));
+          #endif // ifdef RTC_STRUCT_DEBUG
+        _writeBehindState = WriteBehindState::Error;
+      } else if (!fw) {
+        _writeBehindState = WriteBehindState::CheckSpace;
+      } else if (fw.size() >= CACHE_FILE_MAX_SIZE) {
+        _writeBehindState = WriteBehindState::CloseFile;
+      } else {
+        _writeBehindState = WriteBehindState::Encode;
+      }
+      break;
+
+    case WriteBehindState::CloseFile:
+    {
+#ifdef USES_C016
+
+      // File is full, add the footer to allow skipping this file when querying a time range.
+      std::vector<uint8_t> footer;
+
+      if (_encoder.encodeFooter(footer)) {
+        fw.write(&footer[0], footer.size());
+      }
+#endif // ifdef USES_C016
+      fw.close();
+      _writeBehindState = WriteBehindState::GarbageCollect;
+      break;
+    }
+
+    case WriteBehindState::GarbageCollect:
+      GarbageCollection();
+      _writeBehindState = WriteBehindState::CheckSpace;
+      break;
+
+    case WriteBehindState::CheckSpace:
+      initRTCcache_data();
+
+      if (updateRTC_filenameCounters() &&
+          (writeerror || (SpiffsFreeSpace() < ((2 * CACHE_FILE_MAX_SIZE) + SpiffsBlocksize())))) {
+        // Not enough room for another file, remove the oldest one.
+        _writeBehindState = WriteBehindState::DeleteOldest;
+      } else {
+        _writeBehindState = WriteBehindState::OpenFile;
+      }
+      break;
+
+    case WriteBehindState::DeleteOldest:
+      deleteOldestCacheBlock();
+      _writeBehindState = WriteBehindState::OpenFile;
+      break;
+
+    case WriteBehindState::OpenFile:
+    {
+#ifdef USES_C016
+
+      if (_startNewFile) {
+        ++RTC_cache.writeFileNr;
+        _startNewFile = false;
+      }
+#endif // ifdef USES_C016
+
+      String fname = createCacheFilename(RTC_cache.writeFileNr);
+      fw = tryOpenFile(fname, "a+");
+
+#ifdef USES_C016
+
+      if (fw && (fw.size() > 0) && !C016_cache_decoder::hasFileHeader(fw)) {
+        // File written by an older build with uncompressed samples, do not append compressed blocks to it.
+        fw.close();
+        ++RTC_cache.writeFileNr;
+        fname = createCacheFilename(RTC_cache.writeFileNr);
+        fw    = tryOpenFile(fname, "a+");
+      }
+
+      if (fw) {
+        const bool emptyFile = fw.size() == 0;
+
+        if (emptyFile) {
+          C016_cache_encoder::writeFileHeader(fw);
+        }
+
+        // Encoder state is kept in RAM, so the first block after opening a file is a key frame.
+        _encoder.startFile(emptyFile);
+      }
+#endif // ifdef USES_C016
+
+      if (fw && (fw.size() < CACHE_FILE_MAX_SIZE)) {
+          #ifdef RTC_STRUCT_DEBUG
+
+        if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+          String log = F("Write to ");
+          log += fname;
+          log += F(" size");
+          rtc_debug_log(log, fw.size());
+        }
+          #endif // ifdef RTC_STRUCT_DEBUG
+        _writeBehindState = WriteBehindState::Encode;
+      } else if (_openRetries > 1) {
+        --_openRetries;
+        _writeBehindState = WriteBehindState::CheckFile;
+      } else {
+          #ifdef RTC_STRUCT_DEBUG
+        addLog(LOG_LEVEL_ERROR, F("RTC  : error opening file"));
+          #endif // ifdef RTC_STRUCT_DEBUG
+        _writeBehindState = WriteBehindState::Error;
+      }
+      break;
+    }
+
+    case WriteBehindState::Encode:
+#ifdef USES_C016
+
+      // Encode just before writing, so the block continues the encoder state of the file it is written to.
+      // Store the samples as a single compressed block.
+      _pendingBlock.clear();
+
+      if (!_encoder.encode(&RTC_cache_data[0], _pendingLength, _pendingBlock)) {
+        // No valid samples
+        removeWrittenSamples();
+        _writeBehindState = WriteBehindState::Idle;
+        break;
+      }
+#else // ifdef USES_C016
+      _pendingBlock.assign(&RTC_cache_data[0], &RTC_cache_data[0] + _pendingLength);
+#endif // ifdef USES_C016
+      _pendingWritePos  = 0;
+      _writeBehindState = WriteBehindState::WriteData;
+      break;
+
+    case WriteBehindState::WriteData:
+    {
+      size_t chunkSize = _pendingBlock.size() - _pendingWritePos;
+
+      if (chunkSize > RTC_CACHE_WRITE_CHUNK_SIZE) {
+        chunkSize = RTC_CACHE_WRITE_CHUNK_SIZE;
+      }
+      const size_t bytesWriten = fw.write(&_pendingBlock[_pendingWritePos], chunkSize);
+
+      if (bytesWriten < chunkSize) {
+          #ifdef RTC_STRUCT_DEBUG
+        String log = F("RTC  : error writing file. Size: ");
         log += fw.size();
         log += F(" writen: ");
         log += bytesWriten;
         addLog(LOG_LEVEL_ERROR, log);
           #endif // ifdef RTC_STRUCT_DEBUG
-        fw.close();
+        _writeBehindState = WriteBehindState::WriteFailed;
+        break;
+      }
+      _pendingWritePos += chunkSize;
 
-        if (!GarbageCollection()) {
-          // Garbage collection was not able to remove anything
-          writeerror = true;
-        }
-        return false;
+      if (_pendingWritePos >= _pendingBlock.size()) {
+        _writeBehindState = WriteBehindState::FlushFile;
       }
-      initRTCcache_data();
-      clearRTCcacheData();
-      saveRTCcache();
-      return true;
+      break;
     }
+
+    case WriteBehindState::FlushFile:
+      fw.flush();
+        #ifdef RTC_STRUCT_DEBUG
+      addLog(LOG_LEVEL_INFO, F("RTC  : flush RTC cache"));
+        #endif // ifdef RTC_STRUCT_DEBUG
+      removeWrittenSamples();
+      _writeBehindState = WriteBehindState::Idle;
+      break;
+
+    case WriteBehindState::WriteFailed:
+      fw.close();
+#ifdef USES_C016
+
+      // The file may now end with a partial block, continue in a new file starting with a key frame.
+      _encoder.reset();
+      _startNewFile = true;
+#endif // ifdef USES_C016
+
+      if (!GarbageCollection()) {
+        // Garbage collection was not able to remove anything
+        writeerror = true;
+      }
+
+      // The samples are still in the RTC buffer, retried on the next flush.
+      _pendingBlock.clear();
+      _writeBehindState = WriteBehindState::Error;
+      break;
   }
-  return false;
+  STOP_TIMER(timingStat);
+}
+
+void RTC_cache_handler_struct::removeWrittenSamples() {
+  const size_t remaining = RTC_cache.writePos - _pendingLength;
+
+  memmove(&RTC_cache_data[0], &RTC_cache_data[_pendingLength], remaining);
+
+  for (size_t i = remaining; i < RTC_CACHE_DATA_SIZE; ++i) {
+    RTC_cache_data[i] = 0;
+  }
+  RTC_cache.writePos = remaining;
+  _pendingLength     = 0;
+  _pendingBlock.clear();
+  _pendingWritePos = 0;
+  saveRTCcache();
 }
 
 // Return usable filename for reading.
@@ -290,6 +567,7 @@ bool RTC_cache_handler_struct::saveRTCcache(unsigned int startOffset, size_t nrB
   #endif
 
   #ifdef ESP8266
+  START_TIMER;
   if (!system_rtc_mem_write(RTC_BASE_CACHE, reinterpret_cast<const uint8_t *>(&RTC_cache), sizeof(RTC_cache)) || !loadMetaData())
   {
         # ifdef RTC_STRUCT_DEBUG
@@ -313,6 +591,7 @@ bool RTC_cache_handler_struct::saveRTCcache(unsigned int startOffset, size_t nrB
     rtc_debug_log(F("Write cache data to RTC"), nrBytes);
         # endif // ifdef RTC_STRUCT_DEBUG
   }
+  STOP_TIMER(SAVE_TO_RTC);
   return true;
   #endif
 }
@@ -345,13 +624,6 @@ void RTC_cache_handler_struct::initRTCcache_data() {
   }
 }
 
-void RTC_cache_handler_struct::clearRTCcacheData() {
-  for (size_t i = 0; i < RTC_CACHE_DATA_SIZE; ++i) {
-    RTC_cache_data[i] = 0;
-  }
-  RTC_cache.writePos = 0;
-}
-
 // Return true if any cache file found
 bool RTC_cache_handler_struct::updateRTC_filenameCounters() {
   size_t filesizeHighest;
@@ -369,68 +641,6 @@ bool RTC_cache_handler_struct::updateRTC_filenameCounters() {
   return false;
 }
 
-bool RTC_cache_handler_struct::prepareFileForWrite() {
-  //    if (storageLocation != CACHE_STORAGE_SPIFFS) {
-  //      return false;
-  //    }
-  if (SpiffsFull()) {
-      #ifdef RTC_STRUCT_DEBUG
-    addLog(LOG_LEVEL_ERROR, F("RTC  : FS full"));
-      #endif // ifdef RTC_STRUCT_DEBUG
-    return false;
-  }
-  unsigned int retries = 3;
-
-  while (retries > 0) {
-    --retries;
-
-    if (fw && (fw.size() >= CACHE_FILE_MAX_SIZE)) {
-      fw.close();
-      GarbageCollection();
-    }
-
-    if (!fw) {
-      // Open file to write
-      initRTCcache_data();
-
-      if (updateRTC_filenameCounters()) {
-        if (writeerror || (SpiffsFreeSpace() < ((2 * CACHE_FILE_MAX_SIZE) + SpiffsBlocksize()))) {
-          // Not enough room for another file, remove the oldest one.
-          deleteOldestCacheBlock();
-        }
-      }
-
-      String fname = createCacheFilename(RTC_cache.writeFileNr);
-      fw = tryOpenFile(fname, "a+");
-
-      if (!fw) {
-          #ifdef RTC_STRUCT_DEBUG
-        addLog(LOG_LEVEL_ERROR, F("RTC  : error opening file"));
-          #endif // ifdef RTC_STRUCT_DEBUG
-      } else {
-          #ifdef RTC_STRUCT_DEBUG
-
-        if (loglevelActiveFor(LOG_LEVEL_INFO)) {
-          String log = F("Write to ");
-          log += fname;
-          log += F(" size");
-          rtc_debug_log(log, fw.size());
-        }
-          #endif // ifdef RTC_STRUCT_DEBUG
-      }
-    }
-    delay(0);
-
-    if (fw && (fw.size() < CACHE_FILE_MAX_SIZE)) {
-      return true;
-    }
-  }
-    #ifdef RTC_STRUCT_DEBUG
-  addLog(LOG_LEVEL_ERROR, F("RTC  : prepareFileForWrite failed"));
-    #endif // ifdef RTC_STRUCT_DEBUG
-  return false;
-}
-
 #ifdef RTC_STRUCT_DEBUG
 void RTC_cache_handler_struct::rtc_debug_log(const String& description, size_t nrBytes) {
   if (loglevelActiveFor(LOG_LEVEL_INFO)) {
@@ -6,6 +6,10 @@
 
 #include "../../ESPEasy_common.h"
 
+#ifdef USES_C016
+#include "../ControllerQueue/C016_cache_codec.h"
+#endif
+
 #include <FS.h>
 #include <vector>
 
@@ -26,6 +30,16 @@
 
 //#define RTC_STRUCT_DEBUG
 
+// Flushed samples are written to the file system in chunks, spread over several calls to backgroundtasks()
+// A block holds at most RTC_CACHE_DATA_SIZE bytes of samples, so it is written in a few chunks.
+// The file system only programs the flash when its write cache is full, which happens in at most one of these.
+#ifndef RTC_CACHE_WRITE_CHUNK_SIZE
+#define RTC_CACHE_WRITE_CHUNK_SIZE  64
+#endif
+#ifndef RTC_CACHE_WRITE_TIME_BUDGET
+#define RTC_CACHE_WRITE_TIME_BUDGET 2000 // usec per call of processWriteBehind()
+#endif
+
 /********************************************************************************************\
    RTC located cache
  \*********************************************************************************************/
@@ -40,13 +54,28 @@ struct RTC_cache_handler_struct
   bool         peek(uint8_t     *data,
                     unsigned int size);
 
+#ifdef USES_C016
+  // Only peek samples matching the filter, cleared by resetpeek()
+  void         setPeekFilter(const C016_cache_filter& filter);
+#endif
+
   // Write a single sample set to the buffer
   bool write(const uint8_t     *data,
              unsigned int size);
 
   // Mark all content as being processed and empty buffer.
+  // Blocks until all samples are written to the file system.
   bool flush();
 
+  // Continue writing flushed samples to the file system.
+  // Each step performs at most one file system operation, no new step is started when
+  // RTC_CACHE_WRITE_TIME_BUDGET is used.
+  // The samples are kept in the RTC buffer until written.
+  void processWriteBehind();
+
+  // Block until flushed samples are written to the file system.
+  bool finishPendingWrite();
+
   // Return usable filename for reading.
   // Will be empty if there is no file to process.
   String getReadCacheFileName(int& readPos);
@@ -70,12 +99,17 @@ private:
 
   void     initRTCcache_data();
 
-  void     clearRTCcacheData();
-
   // Return true if any cache file found
   bool     updateRTC_filenameCounters();
 
-  bool     prepareFileForWrite();
+  // Start writing the samples in the RTC buffer to the file system.
+  // Samples added meanwhile are written by the next write-behind.
+  bool     startWriteBehind();
+
+  void     processWriteBehindStep();
+
+  // Remove the written samples from the RTC buffer.
+  void     removeWrittenSamples();
 
 #ifdef RTC_STRUCT_DEBUG
   void     rtc_debug_log(const String& description,
@@ -94,6 +128,40 @@ private:
 
   uint8_t storageLocation = CACHE_STORAGE_SPIFFS;
   bool writeerror      = false;
+
+  enum class WriteBehindState : uint8_t {
+    Idle,
+    CheckFile,      // Check whether the open file can be used
+    CloseFile,      // Add the footer to the full file and close it
+    GarbageCollect,
+    CheckSpace,     // Update the file counters and check the free space
+    DeleteOldest,   // Delete the oldest file to make room
+    OpenFile,
+    Encode,         // Encode the samples into a block
+    WriteData,      // Write a chunk of at most RTC_CACHE_WRITE_CHUNK_SIZE
+    FlushFile,
+    WriteFailed,    // Close the file and collect garbage after a failed write
+    Error           // Write failed, retried on the next flush
+  };
+
+#ifdef USES_TIMING_STATS
+  static int getWriteBehindTimingStat(WriteBehindState state);
+#endif
+
+  // The first _pendingLength bytes of the RTC buffer are being written.
+  // They are only removed from the RTC buffer when written, so they survive a crash or a failed write.
+  std::vector<uint8_t> _pendingBlock;
+  size_t               _pendingWritePos  = 0;
+  uint16_t             _pendingLength    = 0;
+  uint8_t              _openRetries      = 0;
+  WriteBehindState     _writeBehindState = WriteBehindState::Idle;
+
+#ifdef USES_C016
+  C016_cache_encoder  _encoder;
+  C016_cache_decoder  _decoder;
+  // Set when a block could not be written completely, so the current file may end in a partial block.
+  bool                _startNewFile = false;
+#endif
 };
 
 #endif // ifndef DATASTRUCTS_RTC_CACHE_HANDLER_STRUCT_H
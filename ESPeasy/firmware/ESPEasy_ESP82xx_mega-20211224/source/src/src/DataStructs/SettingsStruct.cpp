@@ -190,6 +190,21 @@ void SettingsStruct_tmpl<N_TASKS>::CombineTaskValues_SingleEvent(taskIndex_t tas
   }
 }
 
+template<unsigned int N_TASKS>
+bool SettingsStruct_tmpl<N_TASKS>::CoalesceTaskEvents(taskIndex_t taskIndex) const {
+  if (validTaskIndex(taskIndex)) {
+    return bitRead(TaskDeviceSendDataFlags[taskIndex], 1);
+  }
+  return false;
+}
+
+template<unsigned int N_TASKS>
+void SettingsStruct_tmpl<N_TASKS>::CoalesceTaskEvents(taskIndex_t taskIndex, bool value) {
+  if (validTaskIndex(taskIndex)) {
+    bitWrite(TaskDeviceSendDataFlags[taskIndex], 1, value);
+  }
+}
+
 template<unsigned int N_TASKS>
 bool SettingsStruct_tmpl<N_TASKS>::DoNotStartAP() const {
   return bitRead(VariousBits1, 17);
@@ -251,6 +266,16 @@ void SettingsStruct_tmpl<N_TASKS>::EnableClearHangingI2Cbus(bool value) {
   bitWrite(VariousBits1, 22, value);
 }
 
+template<unsigned int N_TASKS>
+bool SettingsStruct_tmpl<N_TASKS>::EnableRulesCaching() const {
+  return !bitRead(VariousBits1, 23);
+}
+
+template<unsigned int N_TASKS>
+void SettingsStruct_tmpl<N_TASKS>::EnableRulesCaching(bool value) {
+  bitWrite(VariousBits1, 23, !value);
+}
+
 
 
 template<unsigned int N_TASKS>
@@ -117,11 +117,19 @@ class SettingsStruct_tmpl
   bool EnableClearHangingI2Cbus() const;
   void EnableClearHangingI2Cbus(bool value);
 
+  // Keep a compiled version of the rules files in RAM (enabled by default, so invert the values)
+  bool EnableRulesCaching() const;
+  void EnableRulesCaching(bool value);
+
 
   // Flag indicating whether all task values should be sent in a single event or one event per task value (default behavior)
   bool CombineTaskValues_SingleEvent(taskIndex_t taskIndex) const;
   void CombineTaskValues_SingleEvent(taskIndex_t taskIndex, bool value);
 
+  // Flag indicating a newer task value event replaces the one still pending in the event queue
+  bool CoalesceTaskEvents(taskIndex_t taskIndex) const;
+  void CoalesceTaskEvents(taskIndex_t taskIndex, bool value);
+
   bool DoNotStartAP() const;
   void DoNotStartAP(bool value);
 
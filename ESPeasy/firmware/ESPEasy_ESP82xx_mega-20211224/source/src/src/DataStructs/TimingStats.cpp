@@ -3,6 +3,7 @@
 #include "../../ESPEasy_common.h"
 #include "../DataTypes/ESPEasy_plugin_functions.h"
 #include "../Globals/CPlugins.h"
+#include "../Globals/Plugins.h"
 #include "../Helpers/_CPlugin_Helper.h"
 #include "../Helpers/StringConverter.h"
 
@@ -10,15 +11,63 @@
 #ifdef USES_TIMING_STATS
 
 
-std::map<int, TimingStats> pluginStats;
-std::map<int, TimingStats> controllerStats;
-std::map<int, TimingStats> miscStats;
+// Return true when a task uses the plugin of the key (deviceIndex * 256 + function).
+static bool pluginStatsKeyInUse(int key) {
+  const deviceIndex_t deviceIndex = static_cast<deviceIndex_t>(key / 256);
+
+  for (taskIndex_t taskIndex = 0; taskIndex < TASKS_MAX; ++taskIndex) {
+    if (getDeviceIndex_from_TaskIndex(taskIndex) == deviceIndex) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Return true when a controller uses the protocol of the key (ProtocolIndex * 256 + function).
+static bool controllerStatsKeyInUse(int key) {
+  const protocolIndex_t protocolIndex = static_cast<protocolIndex_t>(key / 256);
+
+  for (controllerIndex_t controllerIndex = 0; controllerIndex < CONTROLLER_MAX; ++controllerIndex) {
+    if (getProtocolIndex_from_ControllerIndex(controllerIndex) == protocolIndex) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TimingStatsTable<TIMING_STATS_PLUGIN_MAX> pluginStats(pluginStatsKeyInUse);
+TimingStatsTable<TIMING_STATS_CONTROLLER_MAX> controllerStats(controllerStatsKeyInUse);
+TimingStats miscStats[TIMING_STATS_MISC_MAX];
 unsigned long timingstats_last_reset(0);
 
+TimingStats::Histogram TimingStats::_histograms[TIMING_STATS_HISTOGRAM_MAX];
+bool     TimingStats::_histogramUsed[TIMING_STATS_HISTOGRAM_MAX] = { false };
+uint32_t TimingStats::_noHistogramCount = 0;
 
 
+TimingStats::TimingStats() : _timeTotal(0.0f), _count(0), _maxVal(0), _minVal(4294967295),
+  _histogramIndex(TIMING_STATS_NO_HISTOGRAM), _noHistogram(false) {}
 
-TimingStats::TimingStats() : _timeTotal(0.0f), _count(0), _maxVal(0), _minVal(4294967295) {}
+TimingStats::~TimingStats() {
+  releaseHistogram();
+}
+
+TimingStats::TimingStats(TimingStats&& other)
+  : _timeTotal(other._timeTotal), _count(other._count), _maxVal(other._maxVal), _minVal(other._minVal),
+  _histogramIndex(other._histogramIndex), _noHistogram(other._noHistogram) {
+  other._histogramIndex = TIMING_STATS_NO_HISTOGRAM;
+}
+
+TimingStats& TimingStats::operator=(TimingStats&& other) {
+  // Swap, so the histogram of this object is released by the other.
+  std::swap(_timeTotal,      other._timeTotal);
+  std::swap(_count,          other._count);
+  std::swap(_maxVal,         other._maxVal);
+  std::swap(_minVal,         other._minVal);
+  std::swap(_histogramIndex, other._histogramIndex);
+  std::swap(_noHistogram,    other._noHistogram);
+  return *this;
+}
 
 void TimingStats::add(unsigned long time) {
   _timeTotal += static_cast<float>(time);
@@ -27,6 +76,40 @@ void TimingStats::add(unsigned long time) {
   if (time > _maxVal) { _maxVal = time; }
 
   if (time < _minVal) { _minVal = time; }
+
+  if (_histogramIndex == TIMING_STATS_NO_HISTOGRAM) {
+    if (_noHistogram || !Settings.EnableTimingStats()) {
+      return;
+    }
+
+    for (uint8_t i = 0; i < TIMING_STATS_HISTOGRAM_MAX && _histogramIndex == TIMING_STATS_NO_HISTOGRAM; ++i) {
+      if (!_histogramUsed[i]) {
+        _histogramUsed[i] = true;
+        _histogramIndex   = i;
+        memset(&_histograms[i], 0, sizeof(Histogram));
+      }
+    }
+
+    if (_histogramIndex == TIMING_STATS_NO_HISTOGRAM) {
+      _noHistogram = true;
+      ++_noHistogramCount;
+      return;
+    }
+  }
+  Histogram& histogram = _histograms[_histogramIndex];
+
+  histogram.totalTime += time;
+  ++histogram.totalCount;
+
+  uint16_t *buckets   = histogram.buckets;
+  const uint8_t index = getBucketIndex(time);
+
+  if (buckets[index] == 0xFFFF) {
+    for (uint8_t i = 0; i < TIMING_STATS_NR_BUCKETS; ++i) {
+      buckets[i] = (buckets[i] + 1) >> 1;
+    }
+  }
+  ++buckets[index];
 }
 
 void TimingStats::reset() {
@@ -34,6 +117,29 @@ void TimingStats::reset() {
   _count     = 0;
   _maxVal    = 0;
   _minVal    = 4294967295;
+
+  if (_histogramIndex != TIMING_STATS_NO_HISTOGRAM) {
+    memset(_histograms[_histogramIndex].buckets, 0, sizeof(_histograms[_histogramIndex].buckets));
+  } else if (_noHistogram) {
+    // Try again to get a histogram in the next window, other stats may have released theirs.
+    _noHistogram = false;
+
+    if (_noHistogramCount > 0) {
+      --_noHistogramCount;
+    }
+  }
+}
+
+void TimingStats::releaseHistogram() {
+  if (_histogramIndex != TIMING_STATS_NO_HISTOGRAM) {
+    _histogramUsed[_histogramIndex] = false;
+    _histogramIndex                 = TIMING_STATS_NO_HISTOGRAM;
+  }
+  reset();
+}
+
+uint32_t TimingStats::getNoHistogramCount() {
+  return _noHistogramCount;
 }
 
 bool TimingStats::isEmpty() const {
@@ -63,6 +169,86 @@ bool TimingStats::thresholdExceeded(unsigned long threshold) const {
   return _maxVal > threshold;
 }
 
+unsigned long TimingStats::getPercentile(uint8_t percentile) const {
+  if (_histogramIndex == TIMING_STATS_NO_HISTOGRAM) {
+    return 0;
+  }
+  const uint16_t *buckets = _histograms[_histogramIndex].buckets;
+  uint32_t total          = 0;
+
+  for (uint8_t i = 0; i < TIMING_STATS_NR_BUCKETS; ++i) {
+    total += buckets[i];
+  }
+
+  if ((total == 0) || (_count == 0)) {
+    return 0;
+  }
+
+  if (percentile > 100) { percentile = 100; }
+
+  // Number of samples at or below the percentile, rounded up.
+  uint32_t target = (total * percentile + 99) / 100;
+
+  if (target == 0) { target = 1; }
+
+  uint32_t cumulative = 0;
+
+  for (uint8_t i = 0; i < TIMING_STATS_NR_BUCKETS; ++i) {
+    cumulative += buckets[i];
+
+    if (cumulative >= target) {
+      // Use the middle of the bucket
+      const unsigned long lower = (i == 0) ? 0 : getBucketUpperBound(i - 1) + 1;
+      const unsigned long res   = lower + (getBucketUpperBound(i) - lower) / 2;
+
+      if (res > _maxVal) { return _maxVal; }
+
+      if (res < _minVal) { return _minVal; }
+      return res;
+    }
+  }
+  return _maxVal;
+}
+
+uint32_t TimingStats::getTotals(uint64_t& totalTime) const {
+  if (_histogramIndex == TIMING_STATS_NO_HISTOGRAM) {
+    totalTime = 0;
+    return 0;
+  }
+  totalTime = _histograms[_histogramIndex].totalTime;
+  return _histograms[_histogramIndex].totalCount;
+}
+
+uint8_t TimingStats::getBucketIndex(unsigned long value) {
+  if (value < TIMING_STATS_LINEAR_BUCKETS) {
+    return value;
+  }
+  const uint8_t msb = 31 - __builtin_clz(value);
+
+  if (msb > TIMING_STATS_MAX_OCTAVE) {
+    return TIMING_STATS_NR_BUCKETS - 1;
+  }
+  const uint8_t sub = (value >> (msb - TIMING_STATS_SUB_BUCKET_BITS)) & ((1 << TIMING_STATS_SUB_BUCKET_BITS) - 1);
+
+  return TIMING_STATS_LINEAR_BUCKETS + ((msb - TIMING_STATS_SUB_BUCKET_BITS - 1) << TIMING_STATS_SUB_BUCKET_BITS) + sub;
+}
+
+unsigned long TimingStats::getBucketUpperBound(uint8_t index) {
+  if (index < TIMING_STATS_LINEAR_BUCKETS) {
+    return index;
+  }
+
+  if (index >= (TIMING_STATS_NR_BUCKETS - 1)) {
+    // Also holds all values above the range
+    return 4294967295;
+  }
+  const uint8_t offset = index - TIMING_STATS_LINEAR_BUCKETS;
+  const uint8_t msb    = (offset >> TIMING_STATS_SUB_BUCKET_BITS) + TIMING_STATS_SUB_BUCKET_BITS + 1;
+  const uint8_t sub    = offset & ((1 << TIMING_STATS_SUB_BUCKET_BITS) - 1);
+
+  return ((static_cast<unsigned long>((1 << TIMING_STATS_SUB_BUCKET_BITS) + sub + 1)) << (msb - TIMING_STATS_SUB_BUCKET_BITS)) - 1;
+}
+
 /********************************************************************************************\
    Functions used for displaying timing stats
  \*********************************************************************************************/
@@ -224,12 +410,25 @@ String getMiscStatsName(int stat) {
     case FS_GC_SUCCESS:           return F("ESPEASY_FS GC success");
     case FS_GC_FAIL:              return F("ESPEASY_FS GC fail");
     case RULES_PROCESSING:        return F("rulesProcessing()");
+    case RULES_PROCESSING_FILE:   return F("rulesProcessingFile() from file");
+    case RULES_PROCESSING_CACHED: return F("rulesProcessingFile() cached");
+    case RULES_COMPILE_FILE:      return F("Compile rules file");
     case GRAT_ARP_STATS:          return F("sendGratuitousARP()");
     case SAVE_TO_RTC:             return F("saveToRTC()");
     case BACKGROUND_TASKS:        return F("backgroundtasks()");
     case HANDLE_SCHEDULER_IDLE:   return F("handle_schedule() idle");
     case HANDLE_SCHEDULER_TASK:   return F("handle_schedule() task");
     case PARSE_TEMPLATE_PADDED:   return F("parseTemplate_padded()");
+    case PARSE_TEMPLATE_COMPILED: return F("parseTemplate_padded() compiled");
+    case PARSE_TEMPLATE_COMPILE:  return F("Compile template");
+    case LOAD_TASK_SETTINGS_CACHED: return F("LoadTaskSettings() cached");
+    case COMPUTE_FORMULA_COMPILE: return F("Compile formula");
+    case RTC_CACHE_WRITE_BEHIND:  return F("RTC cache write-behind step");
+    case RTC_CACHE_CLOSE_FILE:    return F("RTC cache close file");
+    case RTC_CACHE_GC:            return F("RTC cache garbage collection");
+    case RTC_CACHE_DELETE_FILE:   return F("RTC cache delete oldest file");
+    case RTC_CACHE_OPEN_FILE:     return F("RTC cache open file");
+    case RTC_CACHE_FLUSH_FILE:    return F("RTC cache flush file");
     case PARSE_SYSVAR:            return F("parseSystemVariables()");
     case PARSE_SYSVAR_NOCHANGE:   return F("parseSystemVariables() No change");
     case HANDLE_SERVING_WEBPAGE:  return F("handle webpage");
@@ -10,7 +10,7 @@
 #include "../Helpers/ESPEasy_time_calc.h"
 
 # include <Arduino.h>
-# include <map>
+# include <utility>
 
 
 /*********************************************************************************************\
@@ -83,6 +83,77 @@
 # define HANDLE_SERVING_WEBPAGE  62
 # define WIFI_SCAN_ASYNC         63
 # define WIFI_SCAN_SYNC          64
+# define RULES_PROCESSING_FILE   65
+# define RULES_PROCESSING_CACHED 66
+# define RULES_COMPILE_FILE      67
+# define PARSE_TEMPLATE_COMPILED 68
+# define PARSE_TEMPLATE_COMPILE  69
+# define LOAD_TASK_SETTINGS_CACHED 70
+# define COMPUTE_FORMULA_COMPILE 71
+# define RTC_CACHE_WRITE_BEHIND  72
+# define RTC_CACHE_CLOSE_FILE    73
+# define RTC_CACHE_GC            74
+# define RTC_CACHE_DELETE_FILE   75
+# define RTC_CACHE_OPEN_FILE     76
+# define RTC_CACHE_FLUSH_FILE    77
+
+// Must be the last misc stat ID + 1
+# define TIMING_STATS_MISC_MAX   78
+
+// Number of plugin and controller functions for which mustLogFunction() and mustLogCFunction() return true.
+# define TIMING_STATS_NR_PLUGIN_FUNCTIONS     10
+# define TIMING_STATS_NR_CONTROLLER_FUNCTIONS 5
+
+// Number of plugin/controller + function combinations to keep stats for.
+// Plugin stats are only recorded for calls made for a task, so at most TASKS_MAX plugins are in use at the same time.
+// When the table is full, the stats of plugins or controllers no longer in use are removed.
+# ifndef TIMING_STATS_PLUGIN_MAX
+#  define TIMING_STATS_PLUGIN_MAX     (TASKS_MAX * TIMING_STATS_NR_PLUGIN_FUNCTIONS)
+# endif // ifndef TIMING_STATS_PLUGIN_MAX
+# ifndef TIMING_STATS_CONTROLLER_MAX
+#  define TIMING_STATS_CONTROLLER_MAX (CONTROLLER_MAX * TIMING_STATS_NR_CONTROLLER_FUNCTIONS)
+# endif // ifndef TIMING_STATS_CONTROLLER_MAX
+
+
+/*********************************************************************************************\
+* Latency histogram
+* Log-linear buckets (HDR histogram style):
+* - Values below TIMING_STATS_LINEAR_BUCKETS usec have their own bucket.
+* - Each power of 2 above is split into 2^TIMING_STATS_SUB_BUCKET_BITS buckets,
+*   so the relative error of a percentile is at most 1/2^TIMING_STATS_SUB_BUCKET_BITS.
+* - Values of 2^(TIMING_STATS_MAX_OCTAVE + 1) usec (~4 sec) and up are counted in the last bucket.
+*
+* When a bucket is full, all buckets are halved, rounding up so a bucket with rare (tail) values never becomes empty.
+*
+* The histograms are taken from a static pool of TIMING_STATS_HISTOGRAM_MAX histograms on the first sample
+* added while timing stats are enabled, so stats which are never used do not take a histogram.
+* Along with the buckets, the number of samples and their total duration are kept, which are not cleared by reset().
+\*********************************************************************************************/
+# ifndef TIMING_STATS_SUB_BUCKET_BITS
+#  ifdef ESP32
+#   define TIMING_STATS_SUB_BUCKET_BITS 2
+#  else // ifdef ESP32
+#   define TIMING_STATS_SUB_BUCKET_BITS 1
+#  endif // ifdef ESP32
+# endif // ifndef TIMING_STATS_SUB_BUCKET_BITS
+
+# ifndef TIMING_STATS_HISTOGRAM_MAX
+#  ifdef ESP32
+#   define TIMING_STATS_HISTOGRAM_MAX   64
+#  else // ifdef ESP32
+#   define TIMING_STATS_HISTOGRAM_MAX   32
+#  endif // ifdef ESP32
+# endif // ifndef TIMING_STATS_HISTOGRAM_MAX
+
+# define TIMING_STATS_MAX_OCTAVE    21
+# define TIMING_STATS_LINEAR_BUCKETS (2 << TIMING_STATS_SUB_BUCKET_BITS)
+# define TIMING_STATS_NR_BUCKETS \
+  (TIMING_STATS_LINEAR_BUCKETS + ((TIMING_STATS_MAX_OCTAVE - TIMING_STATS_SUB_BUCKET_BITS) << TIMING_STATS_SUB_BUCKET_BITS))
+
+// Histogram index of stats without a histogram
+# define TIMING_STATS_NO_HISTOGRAM  0xFF
+
+static_assert(TIMING_STATS_HISTOGRAM_MAX < TIMING_STATS_NO_HISTOGRAM, "TIMING_STATS_HISTOGRAM_MAX must be less than 255");
 
 
 class TimingStats {
@@ -90,20 +161,180 @@ public:
 
   TimingStats();
 
-  void         add(unsigned long time);
-  void         reset();
-  bool         isEmpty() const;
-  float        getAvg() const;
-  unsigned int getMinMax(unsigned long& minVal,
-                         unsigned long& maxVal) const;
-  bool         thresholdExceeded(unsigned long threshold) const;
+  ~TimingStats();
+
+  // Not copyable, as it owns a histogram of the pool.
+  TimingStats(const TimingStats&)            = delete;
+  TimingStats& operator=(const TimingStats&) = delete;
+
+  TimingStats(TimingStats&& other);
+  TimingStats& operator=(TimingStats&& other);
+
+  void          add(unsigned long time);
+  void          reset();
+  bool          isEmpty() const;
+  float         getAvg() const;
+  unsigned int  getMinMax(unsigned long& minVal,
+                          unsigned long& maxVal) const;
+  bool          thresholdExceeded(unsigned long threshold) const;
+
+  // Estimate of the percentile (0 ... 100) in usec, taken from the middle of the matching histogram bucket.
+  // Return 0 when no histogram is kept.
+  unsigned long getPercentile(uint8_t percentile) const;
+
+  // Number of samples and their total duration in usec since timing stats were enabled.
+  // Not cleared by reset(), e.g. for the counters in /metrics.
+  uint32_t      getTotals(uint64_t& totalTime) const;
+
+  // Return the histogram to the pool, when the stats are no longer used.
+  void          releaseHistogram();
+
+  static uint8_t       getBucketIndex(unsigned long value);
+
+  // Highest value counted in the bucket.
+  static unsigned long getBucketUpperBound(uint8_t index);
+
+  // Number of stats which did not get a histogram as the pool was full.
+  static uint32_t      getNoHistogramCount();
 
 private:
 
+  struct Histogram {
+    uint64_t totalTime;
+    uint32_t totalCount;
+    uint16_t buckets[TIMING_STATS_NR_BUCKETS];
+  };
+
   float _timeTotal;
   unsigned int _count;
   unsigned long _maxVal;
   unsigned long _minVal;
+  uint8_t _histogramIndex;
+  bool    _noHistogram; // Pool was full on the first sample, do not try again
+
+  static Histogram _histograms[TIMING_STATS_HISTOGRAM_MAX];
+  static bool      _histogramUsed[TIMING_STATS_HISTOGRAM_MAX];
+  static uint32_t  _noHistogramCount;
+};
+
+
+/*********************************************************************************************\
+* TimingStatsTable
+* Fixed size table of TimingStats, sorted by key.
+* Iterating works like a std::map<int, TimingStats>, but adding a sample never allocates memory.
+* When the table is full, the entries for which keyInUse() returns false are removed to make room.
+\*********************************************************************************************/
+template<size_t N>
+class TimingStatsTable {
+public:
+
+  typedef std::pair<int, TimingStats>entry_t;
+
+  explicit TimingStatsTable(bool (*keyInUse)(int key)) : _keyInUse(keyInUse) {}
+
+  // Add a sample to the stats of the key.
+  // Samples are dropped when the key is new and the table is full.
+  void add(int key, unsigned long time) {
+    TimingStats *stats = get(key);
+
+    if (stats == nullptr) {
+      ++_dropped;
+    } else {
+      stats->add(time);
+    }
+  }
+
+  // Return the stats of the key, adding the key when not present.
+  // Return nullptr when the table is full.
+  TimingStats* get(int key) {
+    size_t pos = lowerBound(key);
+
+    if ((pos < _size) && (_entries[pos].first == key)) {
+      return &_entries[pos].second;
+    }
+
+    if (_size >= N) {
+      if (!removeUnused()) {
+        return nullptr;
+      }
+      pos = lowerBound(key);
+    }
+
+    for (size_t i = _size; i > pos; --i) {
+      std::swap(_entries[i], _entries[i - 1]);
+    }
+    _entries[pos].first = key;
+    _entries[pos].second.reset();
+    ++_size;
+    return &_entries[pos].second;
+  }
+
+  entry_t* begin() {
+    return _entries;
+  }
+
+  entry_t* end() {
+    return _entries + _size;
+  }
+
+  const entry_t* begin() const {
+    return _entries;
+  }
+
+  const entry_t* end() const {
+    return _entries + _size;
+  }
+
+  // Number of samples dropped as the table was full.
+  uint32_t droppedCount() const {
+    return _dropped;
+  }
+
+private:
+
+  size_t lowerBound(int key) const {
+    size_t first = 0;
+    size_t last  = _size;
+
+    while (first < last) {
+      const size_t mid = (first + last) / 2;
+
+      if (_entries[mid].first < key) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first;
+  }
+
+  // Remove the entries of keys no longer in use, keeping the order.
+  // Return false when nothing was removed.
+  bool removeUnused() {
+    size_t newSize = 0;
+
+    for (size_t i = 0; i < _size; ++i) {
+      if (_keyInUse(_entries[i].first)) {
+        if (newSize != i) {
+          std::swap(_entries[newSize], _entries[i]);
+        }
+        ++newSize;
+      } else {
+        _entries[i].second.releaseHistogram();
+      }
+    }
+
+    if (newSize == _size) {
+      return false;
+    }
+    _size = newSize;
+    return true;
+  }
+
+  entry_t  _entries[N];
+  size_t   _size    = 0;
+  uint32_t _dropped = 0;
+  bool (*_keyInUse)(int key);
 };
 
 
@@ -114,16 +345,21 @@ bool   mustLogCFunction(CPlugin::Function function);
 String getMiscStatsName(int stat);
 
 
-extern std::map<int, TimingStats> pluginStats;
-extern std::map<int, TimingStats> controllerStats;
-extern std::map<int, TimingStats> miscStats;
+// Key: deviceIndex * 256 + function
+extern TimingStatsTable<TIMING_STATS_PLUGIN_MAX> pluginStats;
+
+// Key: ProtocolIndex * 256 + function
+extern TimingStatsTable<TIMING_STATS_CONTROLLER_MAX> controllerStats;
+
+// Indexed by misc stat ID
+extern TimingStats miscStats[TIMING_STATS_MISC_MAX];
 extern unsigned long timingstats_last_reset;
 
 # define START_TIMER const unsigned long statisticsTimerStart(micros());
 # define STOP_TIMER_TASK(T, F) \
-  if (mustLogFunction(F)) pluginStats[(T) * 256 + (F)].add(usecPassedSince(statisticsTimerStart));
+  if (mustLogFunction(F)) pluginStats.add((T) * 256 + (F), usecPassedSince(statisticsTimerStart));
 # define STOP_TIMER_CONTROLLER(T, F) \
-  if (mustLogCFunction(F)) controllerStats[(T) * 256 + static_cast<int>(F)].add(usecPassedSince(statisticsTimerStart));
+  if (mustLogCFunction(F)) controllerStats.add((T) * 256 + static_cast<int>(F), usecPassedSince(statisticsTimerStart));
 
 // #define STOP_TIMER_LOADFILE miscStats[LOADFILE_STATS].add(usecPassedSince(statisticsTimerStart));
 # define STOP_TIMER(L) if (Settings.EnableTimingStats()) { miscStats[L].add(usecPassedSince(statisticsTimerStart)); }
@@ -17,9 +17,11 @@
 #include "../ESPEasyCore/Serial.h"
 
 #include "../Globals/CPlugins.h"
+#include "../Globals/Cache.h"
 #include "../Globals/Device.h"
 #include "../Globals/ESPEasyWiFiEvent.h"
 #include "../Globals/ESPEasy_Scheduler.h"
+#include "../Globals/FormattedUserVar.h"
 #include "../Globals/MQTT.h"
 #include "../Globals/Plugins.h"
 #include "../Globals/Protocol.h"
@@ -55,6 +57,14 @@ void sendData(struct EventStruct *event)
 
   LoadTaskSettings(event->TaskIndex); // could have changed during background tasks.
 
+  // Values formatted by one controller are used by all controllers.
+  // Store the previous state, in case sendData() is called while sending.
+  const taskIndex_t    prevSendDataTaskIndex = sendDataTaskIndex;
+  FormattedUserVar_ptr prevFormattedUserVar  = std::move(sendDataFormattedUserVar);
+
+  sendDataTaskIndex = event->TaskIndex;
+  sendDataFormattedUserVar.reset();
+
   for (controllerIndex_t x = 0; x < CONTROLLER_MAX; x++)
   {
     event->ControllerIndex = x;
@@ -82,6 +92,10 @@ void sendData(struct EventStruct *event)
     }
   }
 
+  // Delay queues may still keep a reference to the formatted values.
+  sendDataTaskIndex        = prevSendDataTaskIndex;
+  sendDataFormattedUserVar = std::move(prevFormattedUserVar);
+
   // FIXME TD-er: This PLUGIN_EVENT_OUT seems to be unused.
   {
     String dummy;
@@ -110,6 +124,67 @@ bool validUserVar(struct EventStruct *event) {
 
 #ifdef USES_MQTT
 
+#ifdef USES_P037
+
+// The bit mask of all matching task values is stored in Par1 ... Par4 of the event.
+static_assert(TASKS_MAX * VARS_PER_TASK <= 4 * 32, "Too many task values for the MQTT import var mask");
+
+static int& getMQTTimportVarMaskPar(struct EventStruct& event, uint8_t parNr) {
+  switch (parNr) {
+    case 0: return event.Par1;
+    case 1: return event.Par2;
+    case 2: return event.Par3;
+  }
+  return event.Par4;
+}
+
+// Set the bit for the task value identified by id (taskIndex * VARS_PER_TASK + varNr)
+static void setMQTTimportVarMask(struct EventStruct& event, uint16_t id) {
+  int& par = getMQTTimportVarMaskPar(event, id / 32);
+
+  par = static_cast<int>(static_cast<uint32_t>(par) | (1u << (id % 32)));
+}
+
+uint8_t getMQTTimportVarMask(const struct EventStruct *event) {
+  if ((event == nullptr) || !validTaskIndex(event->TaskIndex)) {
+    return 0;
+  }
+  const uint16_t id      = event->TaskIndex * VARS_PER_TASK;
+  const int      pars[4] = { event->Par1, event->Par2, event->Par3, event->Par4 };
+  const uint32_t mask    = static_cast<uint32_t>(pars[id / 32]) >> (id % 32);
+
+  return mask & ((1u << VARS_PER_TASK) - 1);
+}
+
+// Collect the subscriptions of all enabled MQTT import tasks.
+static void updateMQTTimportTopics() {
+  Cache.mqttImportTopics.clear();
+
+  for (taskIndex_t taskIndex = 0; taskIndex < TASKS_MAX; taskIndex++)
+  {
+    if (Settings.TaskDeviceEnabled[taskIndex] && (Settings.TaskDeviceNumber[taskIndex] == PLUGIN_ID_MQTT_IMPORT))
+    {
+      // Same layout as stored by P037
+      char deviceTemplate[VARS_PER_TASK][41];
+      LoadCustomTaskSettings(taskIndex, (uint8_t *)&deviceTemplate, sizeof(deviceTemplate));
+
+      for (uint8_t varNr = 0; varNr < VARS_PER_TASK; varNr++)
+      {
+        String subscriptionTopic = deviceTemplate[varNr];
+        subscriptionTopic.trim();
+
+        if (!subscriptionTopic.isEmpty()) {
+          parseSystemVariables(subscriptionTopic, false);
+          Cache.mqttImportTopics.add(subscriptionTopic, taskIndex * VARS_PER_TASK + varNr);
+        }
+      }
+    }
+  }
+  Cache.mqttImportTopics.setValid();
+}
+
+#endif // ifdef USES_P037
+
 /*********************************************************************************************\
 * Handle incoming MQTT messages
 \*********************************************************************************************/
@@ -138,20 +213,31 @@ void incoming_mqtt_callback(char *c_topic, uint8_t *b_payload, unsigned int leng
     CPlugin::Function::CPLUGIN_PROTOCOL_RECV,
     c_topic, b_payload, length);
 
+#ifdef USES_P037
   deviceIndex_t DeviceIndex = getDeviceIndex(PLUGIN_ID_MQTT_IMPORT); // Check if P037_MQTTimport is present in the build
 
   if (validDeviceIndex(DeviceIndex)) {
-    //  Here we loop over all tasks and call each 037 plugin with function PLUGIN_MQTT_IMPORT
-    for (taskIndex_t taskIndex = 0; taskIndex < TASKS_MAX; taskIndex++)
-    {
-      if (Settings.TaskDeviceEnabled[taskIndex] && (Settings.TaskDeviceNumber[taskIndex] == PLUGIN_ID_MQTT_IMPORT))
-      {
-        Scheduler.schedule_mqtt_plugin_import_event_timer(
-          DeviceIndex, taskIndex, PLUGIN_MQTT_IMPORT,
-          c_topic, b_payload, length);
+    if (!Cache.mqttImportTopics.isValid()) {
+      updateMQTTimportTopics();
+    }
+
+    // Match the topic once against the subscriptions of all MQTT import tasks.
+    // Only a single event is scheduled, shared by all matching tasks, so the payload is only copied once.
+    std::vector<uint16_t> matches;
+
+    if (Cache.mqttImportTopics.match(c_topic, matches)) {
+      EventStruct event;
+
+      for (auto it = matches.begin(); it != matches.end(); ++it) {
+        setMQTTimportVarMask(event, *it);
       }
+      Scheduler.schedule_mqtt_plugin_import_event_timer(
+        DeviceIndex, PLUGIN_MQTT_IMPORT,
+        c_topic, b_payload, length,
+        std::move(event));
     }
   }
+#endif // ifdef USES_P037
 }
 
 /*********************************************************************************************\
@@ -608,6 +694,7 @@ void SensorSendTask(taskIndex_t TaskIndex)
     const uint8_t valueCount = getValueCountForTask(TaskIndex);
     // Store the previous value, in case %pvalue% is used in the formula
     String preValue[VARS_PER_TASK];
+    float  preValueFloat[VARS_PER_TASK] = { 0.0f };
     if (Device[DeviceIndex].FormulaOption) {
       for (uint8_t varNr = 0; varNr < valueCount; varNr++)
       {
@@ -615,7 +702,8 @@ void SensorSendTask(taskIndex_t TaskIndex)
         {
           const String formula = ExtraTaskSettings.TaskDeviceFormula[varNr];
           if (formula.indexOf(F("%pvalue%")) != -1) {
-            preValue[varNr] = formatUserVarNoCheck(&TempEvent, varNr);
+            preValue[varNr]      = formatUserVarNoCheck(&TempEvent, varNr);
+            preValueFloat[varNr] = UserVar[TempEvent.BaseVarIndex + varNr];
           }
         }
       }
@@ -639,12 +727,19 @@ void SensorSendTask(taskIndex_t TaskIndex)
         {
           if (ExtraTaskSettings.TaskDeviceFormula[varNr][0] != 0)
           {
+            double result = 0;
+
+            // Use the compiled formula when possible, which gives the same result without parsing the formula.
+            if (Cache.formulaCache.calculate(&TempEvent, varNr, preValueFloat[varNr], result)) {
+              UserVar[TempEvent.BaseVarIndex + varNr] = result;
+              continue;
+            }
+
             // TD-er: Should we use the set nr of decimals here, or not round at all?
             // See: https://github.com/letscontrolit/ESPEasy/issues/3721#issuecomment-889649437
             String formula = ExtraTaskSettings.TaskDeviceFormula[varNr];
             formula.replace(F("%pvalue%"), preValue[varNr]);
             formula.replace(F("%value%"),  formatUserVarNoCheck(&TempEvent, varNr));
-            double result = 0;
 
             if (!isError(Calculate(parseTemplate(formula), result))) {
               UserVar[TempEvent.BaseVarIndex + varNr] = result;
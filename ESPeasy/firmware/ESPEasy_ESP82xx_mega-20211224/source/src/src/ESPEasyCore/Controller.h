@@ -21,6 +21,11 @@ bool validUserVar(struct EventStruct *event);
 // handle MQTT messages
 void incoming_mqtt_callback(char *c_topic, uint8_t *b_payload, unsigned int length);
 
+#ifdef USES_P037
+// Bit mask of the values of the MQTT import task (event->TaskIndex) subscribed to the topic in the event.
+uint8_t getMQTTimportVarMask(const struct EventStruct *event);
+#endif // ifdef USES_P037
+
 /*********************************************************************************************\
 * Disconnect from MQTT message broker
 \*********************************************************************************************/
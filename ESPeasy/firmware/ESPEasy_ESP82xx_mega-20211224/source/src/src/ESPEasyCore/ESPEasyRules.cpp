@@ -5,6 +5,7 @@
 #include "../DataTypes/EventValueSource.h"
 #include "../ESPEasyCore/ESPEasy_backgroundtasks.h"
 #include "../ESPEasyCore/Serial.h"
+#include "../Globals/Cache.h"
 #include "../Globals/Device.h"
 #include "../Globals/EventQueue.h"
 #include "../Globals/ExtraTaskSettings.h"
@@ -16,6 +17,7 @@
 #include "../Helpers/FS_Helper.h"
 #include "../Helpers/Misc.h"
 #include "../Helpers/Numerical.h"
+#include "../Helpers/RulesHelper.h"
 #include "../Helpers/Rules_calculate.h"
 #include "../Helpers/StringConverter.h"
 #include "../Helpers/StringParser.h"
@@ -59,6 +61,8 @@ String FileNameToEvent(const String& fileName) {
 }
 
 void checkRuleSets() {
+  Cache.rulesHelper.invalidate();
+
   for (uint8_t x = 0; x < RULESETS_MAX; x++) {
 #if defined(ESP8266)
     String fileName = F("rules");
@@ -195,6 +199,22 @@ String rulesProcessingFile(const String& fileName, const String& event) {
     return EMPTY_STRING;
   }
 
+  if (Settings.EnableRulesCaching()) {
+    const RulesFile *rulesFile = Cache.rulesHelper.getFile(fileName);
+
+    if (rulesFile != nullptr) {
+      START_TIMER;
+      Cache.rulesHelper.beginProcessing();
+      rulesProcessingCompiledFile(*rulesFile, event);
+      Cache.rulesHelper.endProcessing();
+      STOP_TIMER(RULES_PROCESSING_CACHED);
+
+      nestingLevel--;
+      return EMPTY_STRING;
+    }
+  }
+  START_TIMER;
+
   fs::File f = tryOpenFile(fileName, "r+");
   SPIFFS_CHECK(f, fileName.c_str());
 
@@ -220,76 +240,33 @@ String rulesProcessingFile(const String& fileName, const String& event) {
     int len = f.read(&buf[0], RULES_BUFFER_SIZE);
 
     for (int x = 0; x < len; x++) {
-      int data = buf[x];
-
-      switch (static_cast<char>(data))
-      {
-        case '\n':
-        {
-          // Line end, parse rule
-          line.trim();
-          check_rules_line_user_errors(line);
+      if (rules_append_char(static_cast<char>(buf[x]), line, firstNonSpaceRead, commentFound)) {
+        // Line end, parse rule
+        if (rules_finalize_line(line)) {
           const size_t lineLength = line.length();
 
           if (lineLength > longestLineSize) {
             longestLineSize = lineLength;
           }
 
-          if ((lineLength > 0) && !line.startsWith(F("//"))) {
-            // Parse the line and extract the action (if there is any)
-            String action;
-            parseCompleteNonCommentLine(line, event, action, match, codeBlock,
-                                        isCommand, condition, ifBranche, ifBlock,
-                                        fakeIfBlock);
-
-            if (match) // rule matched for one action or a block of actions
-            {
-              processMatchedRule(action, event, match, codeBlock,
-                                 isCommand, condition, ifBranche, ifBlock, fakeIfBlock);
-            }
+          // Parse the line and extract the action (if there is any)
+          String action;
+          parseCompleteNonCommentLine(line, event, action, match, codeBlock,
+                                      isCommand, condition, ifBranche, ifBlock,
+                                      fakeIfBlock);
 
-            backgroundtasks();
+          if (match) // rule matched for one action or a block of actions
+          {
+            processMatchedRule(action, event, match, codeBlock,
+                               isCommand, condition, ifBranche, ifBlock, fakeIfBlock);
           }
 
-          // Prepare for new line
-          line = EMPTY_STRING;
-          line.reserve(longestLineSize);
-          firstNonSpaceRead = false;
-          commentFound      = false;
-          break;
-        }
-        case '\r': // Just skip this character
-          break;
-        case '\t': // tab
-        case ' ':  // space
-        {
-          // Strip leading spaces.
-          if (firstNonSpaceRead) {
-            line += ' ';
-          }
-          break;
+          backgroundtasks();
         }
-        case '/':
-        {
-          if (!commentFound) {
-            line += '/';
-
-            if (line.endsWith(F("//"))) {
-              // consider the rest of the line a comment
-              commentFound = true;
-            }
-          }
-          break;
-        }
-        default: // Any other character
-        {
-          firstNonSpaceRead = true;
 
-          if (!commentFound) {
-            line += char(data);
-          }
-          break;
-        }
+        // Prepare for new line
+        line = EMPTY_STRING;
+        line.reserve(longestLineSize);
       }
     }
   }
@@ -298,6 +275,8 @@ String rulesProcessingFile(const String& fileName, const String& event) {
     f.close();
   }
 
+  STOP_TIMER(RULES_PROCESSING_FILE);
+
   nestingLevel--;
   #ifndef BUILD_NO_RAM_TRACKER
   checkRAM(F("rulesProcessingFile2"));
@@ -305,6 +284,143 @@ String rulesProcessingFile(const String& fileName, const String& event) {
   return EMPTY_STRING;
 }
 
+/********************************************************************************************\
+   Rules processing using the compiled (cached) form of a rules file.
+   Lines outside a matching "on ... do" block are skipped without parsing them.
+ \*********************************************************************************************/
+void rulesProcessingCompiledFile(const RulesFile& rulesFile, const String& event)
+{
+  bool match     = false;
+  bool codeBlock = false;
+  bool isCommand = false;
+  bool condition[RULES_IF_MAX_NESTING_LEVEL];
+  bool ifBranche[RULES_IF_MAX_NESTING_LEVEL];
+  uint8_t ifBlock     = 0;
+  uint8_t fakeIfBlock = 0;
+
+  const size_t nrLines = rulesFile.lines.size();
+  size_t index         = 0;
+
+  // "on" lines which may match the event, or nullptr when all must be checked.
+  const std::vector<uint16_t> *candidates = rulesFile.getCandidates(event);
+  size_t candidate                        = 0;
+
+  while (index < nrLines) {
+    if (!codeBlock && !match && (candidates != nullptr)) {
+      // Jump to the next "on" line which may match the event.
+      while (candidate < candidates->size() && (*candidates)[candidate] < index) {
+        ++candidate;
+      }
+
+      if (candidate >= candidates->size()) {
+        break;
+      }
+      index = (*candidates)[candidate];
+    }
+
+    const RulesLine& rulesLine = rulesFile.lines[index];
+
+    if (!codeBlock && !match) {
+      // Looking for the next "on ... do" line.
+      if (!rulesLine.isOn()) {
+        index = rulesLine.next;
+        continue;
+      }
+
+      if (rulesLine.canSkip(event)) {
+        // Static event trigger which does not match, no need to parse the line.
+        index = rulesLine.next;
+        continue;
+      }
+    }
+
+    String line = rulesFile.getLine(index);
+    String action;
+    parseCompleteNonCommentLine(line, event, action, match, codeBlock,
+                                isCommand, condition, ifBranche, ifBlock,
+                                fakeIfBlock);
+
+    if (match) // rule matched for one action or a block of actions
+    {
+      processMatchedRule(action, event, match, codeBlock,
+                         isCommand, condition, ifBranche, ifBlock, fakeIfBlock);
+    }
+
+    backgroundtasks();
+
+    if (codeBlock && !match && (rulesLine.type == RulesLine::Type::OnBlock)) {
+      // Non matching block, continue right after its "endon"
+      codeBlock   = false;
+      ifBlock     = 0;
+      fakeIfBlock = 0;
+      index       = rulesLine.next;
+    } else {
+      ++index;
+    }
+  }
+}
+
+/********************************************************************************************\
+   Append a character read from a rules file to the current line.
+   Leading white space, carriage returns and comments are stripped.
+   Return true when the end of the line was reached.
+ \*********************************************************************************************/
+bool rules_append_char(char c, String& line, bool& firstNonSpaceRead, bool& commentFound)
+{
+  switch (c)
+  {
+    case '\n':
+      // Line end
+      firstNonSpaceRead = false;
+      commentFound      = false;
+      return true;
+    case '\r': // Just skip this character
+      break;
+    case '\t': // tab
+    case ' ':  // space
+    {
+      // Strip leading spaces.
+      if (firstNonSpaceRead) {
+        line += ' ';
+      }
+      break;
+    }
+    case '/':
+    {
+      if (!commentFound) {
+        line += '/';
+
+        if (line.endsWith(F("//"))) {
+          // consider the rest of the line a comment
+          commentFound = true;
+        }
+      }
+      break;
+    }
+    default: // Any other character
+    {
+      firstNonSpaceRead = true;
+
+      if (!commentFound) {
+        line += c;
+      }
+      break;
+    }
+  }
+  return false;
+}
+
+/********************************************************************************************\
+   Prepare a complete line read from a rules file for parsing.
+   Return true when the line is not empty and not a comment line.
+ \*********************************************************************************************/
+bool rules_finalize_line(String& line)
+{
+  line.trim();
+  check_rules_line_user_errors(line);
+  return (line.length() > 0) && !line.startsWith(F("//"));
+}
+
 /********************************************************************************************\
    Strip comment from the line.
    Return true when comment was stripped.
@@ -1445,6 +1561,7 @@ void createRuleEvents(struct EventStruct *event) {
   LoadTaskSettings(event->TaskIndex);
 
   const uint8_t valueCount = getValueCountForTask(event->TaskIndex);
+  const bool    coalesce   = Settings.CoalesceTaskEvents(event->TaskIndex);
 
   // Small optimization as sensor type string may result in large strings
   // These also only yield a single value, so no need to check for combining task values.
@@ -1475,7 +1592,7 @@ void createRuleEvents(struct EventStruct *event) {
       eventString += event->String2.substring(event->String2.length() - 10);
     }
     eventString += '`';
-    eventQueue.addMove(std::move(eventString));    
+    eventQueue.addMove(std::move(eventString), coalesce);
   } else if (Settings.CombineTaskValues_SingleEvent(event->TaskIndex)) {
     String eventString;
     eventString.reserve(128); // Enough for most use cases, prevent lots of memory allocations.
@@ -1488,7 +1605,7 @@ void createRuleEvents(struct EventStruct *event) {
       }
       eventString += formatUserVarNoCheck(event, varNr);
     }
-    eventQueue.addMove(std::move(eventString));
+    eventQueue.addMove(std::move(eventString), coalesce);
   } else {
     for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
       String eventString;
@@ -1498,7 +1615,7 @@ void createRuleEvents(struct EventStruct *event) {
       eventString += ExtraTaskSettings.TaskDeviceValueNames[varNr];
       eventString += F("=");
       eventString += formatUserVarNoCheck(event, varNr);
-      eventQueue.addMove(std::move(eventString));
+      eventQueue.addMove(std::move(eventString), coalesce);
     }
   }
 }
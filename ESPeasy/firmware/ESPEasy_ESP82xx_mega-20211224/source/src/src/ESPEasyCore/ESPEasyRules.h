@@ -35,6 +35,28 @@ void   rulesProcessing(const String& event);
 String rulesProcessingFile(const String& fileName,
                            const String& event);
 
+/********************************************************************************************\
+   Rules processing using the compiled (cached) form of a rules file.
+ \*********************************************************************************************/
+struct RulesFile;
+void rulesProcessingCompiledFile(const RulesFile& rulesFile,
+                                 const String   & event);
+
+/********************************************************************************************\
+   Append a character read from a rules file to the current line.
+   Return true when the end of the line was reached.
+ \*********************************************************************************************/
+bool rules_append_char(char    c,
+                       String& line,
+                       bool  & firstNonSpaceRead,
+                       bool  & commentFound);
+
+/********************************************************************************************\
+   Prepare a complete line read from a rules file for parsing.
+   Return true when the line is not empty and not a comment line.
+ \*********************************************************************************************/
+bool rules_finalize_line(String& line);
+
 
 /********************************************************************************************\
    Strip comment from the line.
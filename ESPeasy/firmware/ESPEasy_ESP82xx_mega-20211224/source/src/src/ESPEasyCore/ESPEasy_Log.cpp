@@ -6,7 +6,6 @@
 #include "../Globals/ESPEasyWiFiEvent.h"
 #include "../Globals/Logging.h"
 #include "../Globals/Settings.h"
-#include "../Helpers/Networking.h"
 
 #include <FS.h>
 
@@ -17,8 +16,16 @@
 /********************************************************************************************\
   Init critical variables for logging (important during initial factory reset stuff )
   \*********************************************************************************************/
+#ifdef ESP32
+// Task running setup() and loop(), the only task allowed to output log lines.
+static TaskHandle_t logMainTask = nullptr;
+#endif
+
 void initLog()
 {
+#ifdef ESP32
+  logMainTask = xTaskGetCurrentTaskHandle();
+#endif
   //make sure addLog doesnt do any stuff before initalisation of Settings is complete.
   Settings.UseSerial=true;
   Settings.SyslogFacility=0;
@@ -203,45 +210,65 @@ void addToLog(uint8_t loglevel, const String& string)
 void addToLog(uint8_t logLevel, const char *line)
 {
   // Please note all functions called from here handling line must be PROGMEM aware.
-  if (loglevelActiveFor(LOG_TO_SERIAL, logLevel)) {
-    addToSerialBuffer(String(millis()));
-    addToSerialBuffer(F(" : "));
-    {
-      String loglevelDisplayString = getLogLevelDisplayString(logLevel);
-      while (loglevelDisplayString.length() < 6) {
-        loglevelDisplayString += ' ';
-      }
-      addToSerialBuffer(loglevelDisplayString);
-    }
-    addToSerialBuffer(F(" : "));
-    addToSerialBuffer(line);
-    addNewlineToSerialBuffer();
+  // The line is only copied into the log buffer, each log destination reads it from there.
+  if (!loglevelActiveFor(logLevel)) {
+    return;
   }
-  if (loglevelActiveFor(LOG_TO_SYSLOG, logLevel)) {
-    syslog(logLevel, line);
+  Logging.add(logLevel, line);
+
+  if (isLogMainTask()) {
+    // Keep the serial output going, also when the background tasks are not called (e.g. during setup)
+    process_serialWriteBuffer();
   }
-  if (loglevelActiveFor(LOG_TO_WEBLOG, logLevel)) {
-    Logging.add(logLevel, line);
+}
+
+void addToLog(uint8_t logLevel, const LogFormat& line)
+{
+  if (!loglevelActiveFor(logLevel)) {
+    return;
+  }
+  Logging.add(logLevel, line);
+
+  if (isLogMainTask()) {
+    process_serialWriteBuffer();
   }
+}
+
+bool isLogMainTask()
+{
+#ifdef ESP32
+  return (logMainTask == nullptr) || (xTaskGetCurrentTaskHandle() == logMainTask);
+#else
+  return true;
+#endif
+}
 
 #ifdef FEATURE_SD
-  if (loglevelActiveFor(LOG_TO_SDCARD, logLevel)) {
-    File logFile = SD.open("log.dat", FILE_WRITE);
+void process_SDlog()
+{
+  if (!Logging.available(LogStruct::Sink::SDcard)) {
+    return;
+  }
+  if (Settings.SDLogLevel == 0) {
+    Logging.skipAll(LogStruct::Sink::SDcard);
+    return;
+  }
+
+  // Write all available lines at once, to open the file only once.
+  File logFile = SD.open("log.dat", FILE_WRITE);
+  unsigned long timestamp;
+  String message;
+  uint8_t loglevel;
+
+  while (Logging.getNext(LogStruct::Sink::SDcard, Settings.SDLogLevel, timestamp, message, loglevel)) {
     if (logFile) {
-      const char* c = line;
-      bool done = false;
-      while (!done) {
-        // Must use PROGMEM aware functions here to process line
-        char ch = pgm_read_byte(c++);
-        if (ch == '\0') {
-          done = true;
-        } else {
-          logFile.print(ch);
-        }
-      }
-      logFile.println();
+      logFile.println(message);
+    } else {
+      Logging.markLost(LogStruct::Sink::SDcard);
     }
+  }
+  if (logFile) {
     logFile.close();
   }
-#endif
 }
+#endif
@@ -4,6 +4,8 @@
 
 #include "../../ESPEasy_common.h"
 
+#include "../DataStructs/LogFormat.h"
+
 #define LOG_LEVEL_NONE                      0
 #define LOG_LEVEL_ERROR                     1
 #define LOG_LEVEL_INFO                      2
@@ -60,5 +62,30 @@ void addToLog(uint8_t loglevel, const String& string);
 
 void addToLog(uint8_t logLevel, const char *line);
 
+void addToLog(uint8_t logLevel, const LogFormat& line);
+
+// Deferred formatting: only the format ID and the arguments are stored,
+// the line is formatted when a log destination reads it. See LogFormat.h
+// e.g. addLogFmt(LOG_LEVEL_DEBUG, LogFormat::Id::ControllerQueueFull, cpluginID);
+template<typename ... Args>
+void addLogFmt(uint8_t logLevel, LogFormat::Id id, const Args& ... args)
+{
+  if (loglevelActiveFor(logLevel)) {
+    LogFormat line(id);
+    const int dummy[] = { 0, (line.add(args), 0) ... };
+    (void)dummy;
+    addToLog(logLevel, line);
+  }
+}
+
+// Return true when called from the task running setup() and loop().
+// Log lines may be added from other tasks, but only this task may output them.
+bool isLogMainTask();
+
+#ifdef FEATURE_SD
+// Append the new log lines to the log file on the SD card.
+void process_SDlog();
+#endif
+
 
 #endif 
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../DataStructs/TimingStats.h"
 #include "../ESPEasyCore/ESPEasyNetwork.h"
 #include "../ESPEasyCore/Serial.h"
+#include "../Globals/C016_ControllerCache.h"
 #include "../Globals/NetworkState.h"
 #include "../Globals/Services.h"
 #include "../Globals/Settings.h"
@@ -59,6 +60,12 @@ void backgroundtasks()
 
   process_serialWriteBuffer();
 
+  process_syslog();
+
+  #ifdef FEATURE_SD
+  process_SDlog();
+  #endif
+
   if (!UseRTOSMultitasking) {
     serial();
 
@@ -69,6 +76,12 @@ void backgroundtasks()
     checkUDP();
   }
 
+  #ifdef USES_C016
+
+  // Write cached samples to the file system in small steps, to prevent long stalls of the loop.
+  ControllerCache.processWriteBehind();
+  #endif // ifdef USES_C016
+
   #ifdef FEATURE_DNS_SERVER
 
   // process DNS, only used if the ESP has no valid WiFi config
@@ -3,6 +3,10 @@
 
 #include "../Commands/InternalCommands.h"
 
+#include "../DataStructs/LogStruct.h"
+
+#include "../ESPEasyCore/ESPEasy_Log.h"
+
 #include "../Globals/Cache.h"
 #include "../Globals/Logging.h" //  For serialWriteBuffer
 #include "../Globals/Settings.h"
@@ -127,7 +131,47 @@ void addNewlineToSerialBuffer() {
   serialWriteBuffer.push_back('\n');
 }
 
+// Move log lines from the log buffer to the serial write buffer.
+// Only a few lines are kept in the serial write buffer, the rest stays in the log buffer.
+void addLogToSerialBuffer() {
+  const uint8_t serialLogLevel = getSerialLogLevel();
+
+  if (serialLogLevel == 0) {
+    Logging.skipAll(LogStruct::Sink::Serial);
+    return;
+  }
+
+  unsigned long timestamp;
+  String message;
+  uint8_t loglevel;
+
+  while (serialWriteBuffer.size() < SERIAL_LOG_BUFFER_LOW && getRoomLeft() > 0 &&
+         Logging.getNext(LogStruct::Sink::Serial, serialLogLevel, timestamp, message, loglevel)) {
+    String line;
+    line.reserve(message.length() + 24);
+    line += timestamp;
+    line += F(" : ");
+    {
+      String loglevelDisplayString = getLogLevelDisplayString(loglevel);
+      while (loglevelDisplayString.length() < 6) {
+        loglevelDisplayString += ' ';
+      }
+      line += loglevelDisplayString;
+    }
+    line += F(" : ");
+    line += message;
+    line += F("\r\n");
+
+    for (auto it = line.begin(); it != line.end(); ++it) {
+      serialWriteBuffer.push_back(*it);
+    }
+  }
+}
+
 void process_serialWriteBuffer() {
+  if (serialWriteBuffer.size() < SERIAL_LOG_BUFFER_LOW) {
+    addLogToSerialBuffer();
+  }
   if (serialWriteBuffer.size() == 0) { return; }
   size_t snip = Serial.availableForWrite();
 
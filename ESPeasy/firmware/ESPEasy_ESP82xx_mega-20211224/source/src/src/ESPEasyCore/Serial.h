@@ -5,6 +5,9 @@
 
 #define INPUT_BUFFER_SIZE          128
 
+// Log lines are added to the serial write buffer when it holds less than this.
+#define SERIAL_LOG_BUFFER_LOW      128
+
 extern uint8_t SerialInByte;
 extern int  SerialInByteCounter;
 extern char InputBuffer_Serial[INPUT_BUFFER_SIZE + 2];
@@ -19,6 +22,8 @@ void addToSerialBuffer(const String& line);
 
 void addNewlineToSerialBuffer();
 
+void addLogToSerialBuffer();
+
 void process_serialWriteBuffer();
 
 // For now, only send it to the serial buffer and try to process it.
@@ -12,6 +12,12 @@ bool C016_startCSVdump() {
   return ControllerCache.isInitialized();
 }
 
+bool C016_startCSVdump(const C016_cache_filter& filter) {
+  ControllerCache.resetpeek();
+  ControllerCache.setPeekFilter(filter);
+  return ControllerCache.isInitialized();
+}
+
 String C016_getCacheFileName(bool& islast) {
   return ControllerCache.getPeekCacheFileName(islast);
 }
@@ -16,6 +16,9 @@ extern ControllerCache_struct ControllerCache;
 //********************************************************************************
 bool C016_startCSVdump();
 
+// Only return the lines matching the filter from C016_getCSVline()
+bool C016_startCSVdump(const C016_cache_filter& filter);
+
 String C016_getCacheFileName(bool& islast);
 
 bool C016_deleteOldestCacheBlock();
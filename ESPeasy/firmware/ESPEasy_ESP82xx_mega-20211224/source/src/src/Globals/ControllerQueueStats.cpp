@@ -0,0 +1,14 @@
+#include "../Globals/ControllerQueueStats.h"
+
+#include "../Globals/CPlugins.h"
+
+
+ControllerQueueStatsStruct ControllerQueueStats[CONTROLLER_MAX];
+
+ControllerQueueStatsStruct* getControllerQueueStats(controllerIndex_t controller_idx)
+{
+  if (!validControllerIndex(controller_idx)) {
+    return nullptr;
+  }
+  return &ControllerQueueStats[controller_idx];
+}
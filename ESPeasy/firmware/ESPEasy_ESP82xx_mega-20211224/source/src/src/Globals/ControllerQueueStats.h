@@ -0,0 +1,17 @@
+#ifndef GLOBALS_CONTROLLERQUEUESTATS_H
+#define GLOBALS_CONTROLLERQUEUESTATS_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../CustomBuild/ESPEasyLimits.h"
+#include "../DataStructs/ControllerQueueStatsStruct.h"
+#include "../DataTypes/ControllerIndex.h"
+
+
+extern ControllerQueueStatsStruct ControllerQueueStats[CONTROLLER_MAX];
+
+// Return nullptr for an invalid controller index.
+ControllerQueueStatsStruct* getControllerQueueStats(controllerIndex_t controller_idx);
+
+
+#endif // GLOBALS_CONTROLLERQUEUESTATS_H
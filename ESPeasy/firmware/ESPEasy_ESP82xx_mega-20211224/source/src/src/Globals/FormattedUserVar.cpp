@@ -0,0 +1,5 @@
+#include "../Globals/FormattedUserVar.h"
+
+
+taskIndex_t          sendDataTaskIndex = INVALID_TASK_INDEX;
+FormattedUserVar_ptr sendDataFormattedUserVar;
@@ -0,0 +1,12 @@
+#ifndef GLOBALS_FORMATTEDUSERVAR_H
+#define GLOBALS_FORMATTEDUSERVAR_H
+
+#include "../DataStructs/FormattedUserVarStruct.h"
+
+// Task currently being sent to the controllers by sendData(), INVALID_TASK_INDEX when not sending.
+extern taskIndex_t sendDataTaskIndex;
+
+// Formatted values of sendDataTaskIndex, created on first use by one of the controllers.
+extern FormattedUserVar_ptr sendDataFormattedUserVar;
+
+#endif // GLOBALS_FORMATTEDUSERVAR_H
@@ -9,6 +9,8 @@ bool MQTTclient_should_reconnect        = true;
 bool MQTTclient_must_send_LWT_connected = false;
 bool MQTTclient_connected               = false;
 int  mqtt_reconnect_count               = 0;
+
+QueueDrainStatsStruct MQTT_queueDrainStats;
 #endif // USES_MQTT
 
 #ifdef USES_P037
@@ -9,6 +9,8 @@
 # include <WiFiClient.h>
 # include <PubSubClient.h>
 
+# include "../DataStructs/QueueDrainStatsStruct.h"
+
 // MQTT client
 extern WiFiClient   mqtt;
 extern PubSubClient MQTTclient;
@@ -16,6 +18,9 @@ extern bool MQTTclient_should_reconnect;
 extern bool MQTTclient_must_send_LWT_connected;
 extern bool MQTTclient_connected;
 extern int  mqtt_reconnect_count;
+
+// Throughput of sending the MQTT delay queue
+extern QueueDrainStatsStruct MQTT_queueDrainStats;
 #endif // USES_MQTT
 
 #ifdef USES_P037
@@ -1,52 +1,86 @@
 #include "../Helpers/CRC_functions.h"
 
 
+/*********************************************************************************************\
+* Lookup table generation
+* The tables are computed by the compiler, using C++11 compatible constexpr functions.
+\*********************************************************************************************/
+
+// Shift a byte through a CRC bit by bit, LSB first (reflected)
+constexpr uint32_t CRC_reflected_entry(uint32_t crc, uint32_t poly, uint8_t bits) {
+  return bits == 0 ? crc : CRC_reflected_entry((crc & 1) ? ((crc >> 1) ^ poly) : (crc >> 1), poly, bits - 1);
+}
+
+// Shift a byte through a CRC bit by bit, MSB first
+constexpr uint32_t CRC_normal_entry(uint32_t crc, uint32_t poly, uint32_t topbit, uint8_t bits) {
+  return bits == 0 ? crc : CRC_normal_entry((crc & topbit) ? ((crc << 1) ^ poly) : (crc << 1), poly, topbit, bits - 1);
+}
+
+#define CRC_TABLE_4(F, n)   F(n), F((n) + 1), F((n) + 2), F((n) + 3)
+#define CRC_TABLE_16(F, n)  CRC_TABLE_4(F, n), CRC_TABLE_4(F, (n) + 4), CRC_TABLE_4(F, (n) + 8), CRC_TABLE_4(F, (n) + 12)
+#define CRC_TABLE_64(F, n)  CRC_TABLE_16(F, n), CRC_TABLE_16(F, (n) + 16), CRC_TABLE_16(F, (n) + 32), CRC_TABLE_16(F, (n) + 48)
+#define CRC_TABLE_256(F)    CRC_TABLE_64(F, 0), CRC_TABLE_64(F, 64), CRC_TABLE_64(F, 128), CRC_TABLE_64(F, 192)
+
+#define CRC8_MAXIM_ENTRY(n)   static_cast<uint8_t>(CRC_reflected_entry(n, 0x8C, 8))
+#define CRC16_ARC_ENTRY(n)    static_cast<uint16_t>(CRC_reflected_entry(n, 0xA001, 8))
+#define CRC16_XMODEM_ENTRY(n) static_cast<uint16_t>(CRC_normal_entry(static_cast<uint32_t>(n) << 8, 0x1021, 0x8000, 8))
+#define CRC32_ENTRY(n)        static_cast<uint32_t>(CRC_normal_entry(static_cast<uint32_t>(n) << 24, 0x04c11db7, 0x80000000, 8))
+
+static const uint8_t  CRC8_Maxim_table[256] PROGMEM   = { CRC_TABLE_256(CRC8_MAXIM_ENTRY) };
+static const uint16_t CRC16_ARC_table[256] PROGMEM    = { CRC_TABLE_256(CRC16_ARC_ENTRY) };
+static const uint16_t CRC16_XMODEM_table[256] PROGMEM = { CRC_TABLE_256(CRC16_XMODEM_ENTRY) };
+static const uint32_t CRC32_table[256] PROGMEM        = { CRC_TABLE_256(CRC32_ENTRY) };
+
+#undef CRC8_MAXIM_ENTRY
+#undef CRC16_ARC_ENTRY
+#undef CRC16_XMODEM_ENTRY
+#undef CRC32_ENTRY
+#undef CRC_TABLE_256
+#undef CRC_TABLE_64
+#undef CRC_TABLE_16
+#undef CRC_TABLE_4
+
+
 int calc_CRC16(const String& text) {
   return calc_CRC16(text.c_str(), text.length());
 }
 
 int calc_CRC16(const char *ptr, int count)
 {
-  int crc;
-
-  crc = 0;
+  uint16_t crc = 0;
 
   while (--count >= 0)
   {
-    crc = crc ^ static_cast<int>(*ptr++) << 8;
-    char i = 8;
-
-    do
-    {
-      if (crc & 0x8000) {
-        crc = crc << 1 ^ 0x1021;
-      }
-      else {
-        crc = crc << 1;
-      }
-    } while(--i);
+    crc = (crc << 8) ^ pgm_read_word(&CRC16_XMODEM_table[((crc >> 8) ^ static_cast<uint8_t>(*ptr++)) & 0xFF]);
   }
   return crc;
 }
 
-uint32_t calc_CRC32(const uint8_t *data, size_t length) {
-  uint32_t crc = 0xffffffff;
-
+uint32_t calc_CRC32(const uint8_t *data, size_t length, uint32_t crc) {
   while (length--) {
-    uint8_t c = *data++;
-
-    for (uint32_t i = 0x80; i > 0; i >>= 1) {
-      bool bit = crc & 0x80000000;
+    crc = (crc << 8) ^ pgm_read_dword(&CRC32_table[((crc >> 24) ^ *data++) & 0xFF]);
+  }
+  return crc;
+}
 
-      if (c & i) {
-        bit = !bit;
-      }
-      crc <<= 1;
+uint8_t calc_CRC8_Maxim(const uint8_t *data, size_t length, uint8_t crc) {
+  while (length--) {
+    crc = pgm_read_byte(&CRC8_Maxim_table[crc ^ *data++]);
+  }
+  return crc;
+}
 
-      if (bit) {
-        crc ^= 0x04c11db7;
-      }
-    }
+uint16_t calc_CRC16_ARC(const uint8_t *data, size_t length, uint16_t crc) {
+  while (length--) {
+    crc = update_CRC16_ARC(crc, *data++);
   }
   return crc;
 }
+
+uint16_t update_CRC16_ARC(uint16_t crc, uint8_t data) {
+  return (crc >> 8) ^ pgm_read_word(&CRC16_ARC_table[(crc ^ data) & 0xFF]);
+}
+
+uint16_t calc_CRC16_Modbus(const uint8_t *data, size_t length, uint16_t crc) {
+  return calc_CRC16_ARC(data, length, crc);
+}
@@ -3,13 +3,41 @@
 
 #include <Arduino.h>
 
+/*********************************************************************************************\
+* CRC functions
+* All use a 256 entry lookup table in flash, generated at compile time.
+* The optional crc parameter allows to compute the CRC incrementally,
+* by passing the result of the previous call.
+\*********************************************************************************************/
+
+// CRC-16/XMODEM (poly 0x1021, init 0)
 int      calc_CRC16(const String& text);
 
 int      calc_CRC16(const char *ptr,
                     int         count);
 
+// CRC-32 as used for the RTC checksums (poly 0x04C11DB7, init 0xFFFFFFFF, not reflected, no final XOR)
 uint32_t calc_CRC32(const uint8_t *data,
-                    size_t         length);
+                    size_t         length,
+                    uint32_t       crc = 0xffffffff);
+
+// CRC-8/MAXIM, Dallas 1-Wire (poly 0x31 reflected, init 0)
+uint8_t  calc_CRC8_Maxim(const uint8_t *data,
+                         size_t         length,
+                         uint8_t        crc = 0);
+
+// CRC-16/ARC, also used by DSMR P1 meters (poly 0x8005 reflected, init 0)
+uint16_t calc_CRC16_ARC(const uint8_t *data,
+                        size_t         length,
+                        uint16_t       crc = 0);
+
+uint16_t update_CRC16_ARC(uint16_t crc,
+                          uint8_t  data);
+
+// CRC-16/MODBUS, same as CRC-16/ARC with init 0xFFFF
+uint16_t calc_CRC16_Modbus(const uint8_t *data,
+                           size_t         length,
+                           uint16_t       crc = 0xffff);
 
 
 #endif // ifndef HELPERS_CRC_FUNCTIONS_H
@@ -0,0 +1,152 @@
+#include "../Helpers/CompiledFormula.h"
+
+#include "../DataStructs/TimingStats.h"
+
+#include "../Globals/Device.h"
+#include "../Globals/ExtraTaskSettings.h"
+#include "../Globals/Plugins.h"
+#include "../Globals/RuntimeData.h"
+
+#include "../Helpers/Numerical.h"
+
+
+// Format the value as it would be inserted in the formula as text.
+static bool formatSlotValue(float value, uint8_t nrDecimals, char *buf)
+{
+  if (!isValidFloat(value) || (fabsf(value) >= 1e9f) || (nrDecimals > 6)) {
+    return false;
+  }
+
+  // Same formatting as used by toString(), so the value is rounded exactly the same.
+  dtostrf(value, 1, nrDecimals, buf);
+  return true;
+}
+
+bool CompiledFormulaCache::calculate(struct EventStruct *event, uint8_t varNr, float prevValue, double& result)
+{
+  if ((event == nullptr) || !validTaskIndex(event->TaskIndex) || (varNr >= VARS_PER_TASK)) {
+    return false;
+  }
+
+  // The values are inserted as formatted by formatUserVarNoCheck()
+  // Only regular float values can be handled without formatting them as String.
+  switch (event->getSensorType()) {
+    case Sensor_VType::SENSOR_TYPE_LONG:
+    case Sensor_VType::SENSOR_TYPE_STRING:
+      return false;
+    default:
+      break;
+  }
+
+  const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(event->TaskIndex);
+
+  if (!validDeviceIndex(DeviceIndex)) {
+    return false;
+  }
+
+  Entry& entry = get(event->TaskIndex, varNr, ExtraTaskSettings.TaskDeviceFormula[varNr]);
+
+  if (!entry.supported) {
+    return false;
+  }
+
+  uint8_t nrDecimals = ExtraTaskSettings.TaskDeviceValueDecimals[varNr];
+
+  if (!Device[DeviceIndex].configurableDecimals()) {
+    nrDecimals = 0;
+  }
+
+  const float values[CALCULATE_NR_SLOTS] = { UserVar[event->BaseVarIndex + varNr], prevValue };
+  double slotValues[CALCULATE_NR_SLOTS]  = { 0.0 };
+  uint8_t variant                        = 0;
+
+  for (uint8_t slot = 0; slot < CALCULATE_NR_SLOTS; ++slot) {
+    if (entry.programs[0].usedSlots[slot]) {
+      char buf[24];
+
+      if (!formatSlotValue(values[slot], nrDecimals, buf)) {
+        return false;
+      }
+      const char *number = buf;
+
+      if ((buf[0] == '-') && !entry.programs[0].negativeAllowed[slot]) {
+        // The '-' is parsed as operator, followed by the absolute value.
+        bitSet(variant, slot);
+        ++number;
+      }
+
+      // Same conversion as used by String::toDouble()
+      slotValues[slot] = atof(number);
+    }
+  }
+
+  if (!bitRead(entry.compiled, variant)) {
+    compile(entry, variant);
+  }
+
+  if (!bitRead(entry.valid, variant)) {
+    return false;
+  }
+  return !isError(RulesCalculate.evaluate(entry.programs[variant], slotValues, result));
+}
+
+void CompiledFormulaCache::clear()
+{
+  _entries.clear();
+}
+
+CompiledFormulaCache::Entry& CompiledFormulaCache::get(taskIndex_t taskIndex, uint8_t varNr, const char *formula)
+{
+  Entry& entry = _entries[taskIndex * VARS_PER_TASK + varNr];
+
+  if (!entry.formula.equals(formula)) {
+    entry.formula  = formula;
+    entry.compiled = 0;
+    entry.valid    = 0;
+
+    for (uint8_t variant = 0; variant < COMPILED_FORMULA_NR_VARIANTS; ++variant) {
+      entry.programs[variant].clear();
+    }
+
+    // Other markup is replaced by parseTemplate(), so such a formula cannot be compiled.
+    String remaining = entry.formula;
+    remaining.replace(F("%pvalue%"), EMPTY_STRING);
+    remaining.replace(F("%value%"),  EMPTY_STRING);
+
+    entry.supported = remaining.indexOf('%') == -1 &&
+                      remaining.indexOf('[') == -1 &&
+                      remaining.indexOf('{') == -1 &&
+                      remaining.indexOf('&') == -1 &&
+                      compile(entry, 0);
+  }
+  return entry;
+}
+
+bool CompiledFormulaCache::compile(Entry& entry, uint8_t variant)
+{
+  START_TIMER;
+
+  // Replace in the same order as done when computing the formula as text.
+  const __FlashStringHelper *placeholders[CALCULATE_NR_SLOTS] = { F("%value%"), F("%pvalue%") };
+  String expression                                          = entry.formula;
+
+  for (int slot = CALCULATE_NR_SLOTS - 1; slot >= 0; --slot) {
+    String replacement;
+
+    if (bitRead(variant, slot)) {
+      replacement += '-';
+    }
+    replacement += static_cast<char>(CALCULATE_SLOT_CHAR + slot);
+    expression.replace(placeholders[slot], replacement);
+  }
+
+  const bool success = !isError(RulesCalculate.compile(RulesCalculate_t::preProces(expression), entry.programs[variant]));
+
+  bitSet(entry.compiled, variant);
+
+  if (success) {
+    bitSet(entry.valid, variant);
+  }
+  STOP_TIMER(COMPUTE_FORMULA_COMPILE);
+  return success;
+}
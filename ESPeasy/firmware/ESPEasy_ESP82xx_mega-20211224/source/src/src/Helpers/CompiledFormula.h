@@ -0,0 +1,56 @@
+#ifndef HELPERS_COMPILEDFORMULA_H
+#define HELPERS_COMPILEDFORMULA_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../DataStructs/ESPEasy_EventStruct.h"
+#include "../Helpers/Rules_calculate.h"
+
+#include <map>
+
+
+// Number of compiled versions per formula.
+// Bit N of the index is set when a negative value in slot N is parsed as '-' operator followed by the absolute value.
+#define COMPILED_FORMULA_NR_VARIANTS  (1 << CALCULATE_NR_SLOTS)
+
+
+/*********************************************************************************************\
+* CompiledFormulaCache
+* Keeps the compiled (RPN) version of the task value formulas, with %value% and %pvalue% as slots,
+* so they do not need to be parsed via parseTemplate() and Calculate() for every PLUGIN_READ.
+\*********************************************************************************************/
+class CompiledFormulaCache {
+public:
+
+  // Compute the formula of a task value, using the value currently in UserVar.
+  // ExtraTaskSettings must be loaded for the task of the event.
+  // Return false when the formula must be computed via parseTemplate() and Calculate().
+  bool calculate(struct EventStruct *event,
+                 uint8_t             varNr,
+                 float               prevValue,
+                 double            & result);
+
+  void clear();
+
+private:
+
+  struct Entry {
+    String           formula;
+    CalculateProgram programs[COMPILED_FORMULA_NR_VARIANTS];
+    uint8_t          compiled  = 0; // Bit per variant, set when compiled
+    uint8_t          valid     = 0; // Bit per variant, set when successfully compiled
+    bool             supported = false;
+  };
+
+  Entry& get(taskIndex_t taskIndex,
+             uint8_t     varNr,
+             const char *formula);
+
+  static bool compile(Entry & entry,
+                      uint8_t variant);
+
+  std::map<uint16_t, Entry> _entries;
+};
+
+
+#endif // HELPERS_COMPILEDFORMULA_H
@@ -0,0 +1,336 @@
+#include "../Helpers/CompiledTemplate.h"
+
+#include "../../_Plugin_Helper.h"
+
+#include "../Commands/GPIO.h"
+
+#include "../DataStructs/TimingStats.h"
+
+#include "../Globals/RuntimeData.h"
+#include "../Globals/Settings.h"
+
+#include "../Helpers/ESPEasy_math.h"
+#include "../Helpers/Numerical.h"
+#include "../Helpers/StringConverter.h"
+#include "../Helpers/StringParser.h"
+
+#include <algorithm>
+
+
+/*********************************************************************************************\
+* CompiledTemplate
+\*********************************************************************************************/
+
+// Count the characters used to find [...#...] references.
+// System variables and special characters do not contain these, so when the count differs
+// after parsing system variables, these were introduced by a replaced value.
+static size_t countReferenceMarkers(const String& str)
+{
+  size_t count        = 0;
+  const size_t length = str.length();
+
+  for (size_t i = 0; i < length; ++i) {
+    switch (str[i]) {
+      case '[':
+      case ']':
+      case '#':
+        ++count;
+        break;
+      default:
+        break;
+    }
+  }
+  return count;
+}
+
+bool CompiledTemplate::compile(const String& source)
+{
+  _source = source;
+  _segments.clear();
+  _reserveSize        = 0;
+  _hasDynamicLiterals = false;
+
+  // Special characters are only replaced when the template contains accolades or HTML entities.
+  // This also replaces the Unicode degree C symbol, which may then occur outside a replaced token.
+  const bool hasSpecialCharacters =
+    (source.indexOf('{') != -1 && source.indexOf('}') != -1) ||
+    (source.indexOf('&') != -1 && source.indexOf(';') != -1);
+
+  int startpos     = 0;
+  int lastStartpos = 0;
+  int endpos       = 0;
+  String deviceName, valueName, format;
+
+  while (findNextDevValNameInString(source, startpos, endpos, deviceName, valueName, format)) {
+    // References must not contain markup which is replaced before the references are parsed.
+    for (int i = startpos; i <= endpos; ++i) {
+      switch (source[i]) {
+        case '%':
+        case '{':
+        case '}':
+        case '&':
+        case ';':
+          return false;
+        default:
+          break;
+      }
+    }
+
+    addLiteral(source, lastStartpos, startpos);
+
+    Segment segment;
+
+    // deviceName is lower case, so we can compare literal string (no need for equalsIgnoreCase)
+    if (deviceName.equals(F("plugin"))) {
+      segment.type  = SegmentType::PluginRequest;
+      segment.text  = valueName;
+      segment.text += '#';
+      segment.text += format;
+      segment.text.replace('#', ',');
+    } else if (deviceName.equals(F("var")) || deviceName.equals(F("int"))) {
+      if (validUIntFromString(valueName, segment.varNum)) {
+        segment.type   = deviceName.equals(F("int")) ? SegmentType::IntVariable : SegmentType::Variable;
+        segment.format = format;
+      }
+    } else {
+      const taskIndex_t taskIndex = findTaskIndexByName(deviceName);
+
+      if (validTaskIndex(taskIndex)) {
+        segment.taskIndex = taskIndex;
+        segment.format    = format;
+        segment.valueNr   = findDeviceValueIndexByName(valueName, taskIndex);
+
+        if (segment.valueNr != VARS_PER_TASK) {
+          segment.type = SegmentType::TaskValue;
+        } else {
+          segment.type = SegmentType::TaskGetConfig;
+          segment.text = valueName;
+        }
+      }
+    }
+    _segments.push_back(std::move(segment));
+    _reserveSize += 8;
+
+    lastStartpos = endpos + 1;
+    startpos     = endpos + 1;
+  }
+  addLiteral(source, lastStartpos, source.length());
+
+  if (hasSpecialCharacters) {
+    const char degreeC[4] = { 0xe2, 0x84, 0x83, 0 }; // Unicode degreeC symbol
+
+    if (source.indexOf(degreeC) != -1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CompiledTemplate::render(String& newString, uint8_t minimal_lineSize, bool useURLencode) const
+{
+  // Length of the template after replacing system variables, used for right aligned values.
+  size_t templateLength = _source.length();
+  std::vector<String> dynamicLiterals;
+
+  if (_hasDynamicLiterals) {
+    for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+      if (it->type == SegmentType::DynamicLiteral) {
+        String text(it->text);
+        parseSystemVariables(text, useURLencode);
+
+        if (countReferenceMarkers(text) != countReferenceMarkers(it->text)) {
+          // Replaced value may be interpreted as (part of) a reference.
+          return false;
+        }
+        templateLength += text.length();
+        templateLength -= it->text.length();
+        dynamicLiterals.push_back(std::move(text));
+      }
+    }
+  }
+
+  newString.reserve(std::max(static_cast<uint16_t>(minimal_lineSize), _reserveSize));
+
+  size_t dynamicIndex = 0;
+
+  for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+    switch (it->type) {
+      case SegmentType::Literal:
+        newString += it->text;
+        continue;
+      case SegmentType::DynamicLiteral:
+        newString += dynamicLiterals[dynamicIndex++];
+        continue;
+      case SegmentType::TaskValue:
+
+        if (Settings.TaskDeviceEnabled[it->taskIndex]) {
+          bool   isvalid;
+          String value = formatUserVar(it->taskIndex, it->valueNr, isvalid);
+
+          if (isvalid) {
+            String format(it->format);
+            transformValue(newString, minimal_lineSize, value, format, templateLength);
+          }
+        }
+        break;
+      case SegmentType::TaskGetConfig:
+
+        if (Settings.TaskDeviceEnabled[it->taskIndex]) {
+          struct EventStruct TempEvent(it->taskIndex);
+          String tmpName = it->text;
+
+          if (PluginCall(PLUGIN_GET_CONFIG, &TempEvent, tmpName))
+          {
+            String format(it->format);
+            transformValue(newString, minimal_lineSize, tmpName, format, templateLength);
+          }
+        }
+        break;
+      case SegmentType::Variable:
+      case SegmentType::IntVariable:
+      {
+        unsigned char nr_decimals = maxNrDecimals_double(getCustomFloatVar(it->varNum));
+        bool trimTrailingZeros    = true;
+
+        if (it->type == SegmentType::IntVariable) {
+          nr_decimals = 0;
+        } else if (!it->format.isEmpty())
+        {
+          // There is some formatting here, so do not throw away decimals
+          trimTrailingZeros = false;
+        }
+        String value = doubleToString(getCustomFloatVar(it->varNum), nr_decimals, trimTrailingZeros);
+        value.trim();
+        String format(it->format);
+        transformValue(newString, minimal_lineSize, value, format, templateLength);
+        break;
+      }
+      case SegmentType::PluginRequest:
+      {
+        String command(it->text);
+
+        if (getGPIOPinStateValues(command)) {
+          newString += command;
+        }
+        break;
+      }
+      case SegmentType::Empty:
+        break;
+    }
+
+    // This may have taken some time, so call delay()
+    delay(0);
+  }
+  return true;
+}
+
+void CompiledTemplate::addLiteral(const String& source, int start, int end)
+{
+  if (end <= start) {
+    return;
+  }
+  Segment segment;
+
+  segment.type = SegmentType::Literal;
+  segment.text = source.substring(start, end);
+
+  if ((segment.text.indexOf('%') != -1) ||
+      (segment.text.indexOf('{') != -1) ||
+      (segment.text.indexOf('&') != -1)) {
+    segment.type        = SegmentType::DynamicLiteral;
+    _hasDynamicLiterals = true;
+  }
+  _reserveSize += segment.text.length();
+  _segments.push_back(std::move(segment));
+}
+
+/*********************************************************************************************\
+* CompiledTemplateCache
+\*********************************************************************************************/
+const CompiledTemplate * CompiledTemplateCache::get(const String& source)
+{
+  if (source.isEmpty() || (source.length() > TEMPLATE_CACHE_MAX_LENGTH)) {
+    return nullptr;
+  }
+  const uint32_t hash = computeHash(source);
+
+  ++_useCounter;
+
+  for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+    if ((it->hash == hash) && it->compiled.getSource().equals(source)) {
+      it->lastUsed = _useCounter;
+      return it->valid ? &(it->compiled) : nullptr;
+    }
+  }
+
+  bool seenBefore = false;
+
+  for (uint8_t i = 0; i < TEMPLATE_CACHE_MAX_ENTRIES && !seenBefore; ++i) {
+    if (_seen[i] == hash) {
+      _seen[i]   = 0;
+      seenBefore = true;
+    }
+  }
+
+  if (!seenBefore) {
+    _seen[_seenIndex] = hash;
+    _seenIndex        = (_seenIndex + 1) % TEMPLATE_CACHE_MAX_ENTRIES;
+    return nullptr;
+  }
+
+  START_TIMER;
+
+  if (_entries.empty()) {
+    // Make sure returned pointers remain valid when entries are added.
+    _entries.reserve(TEMPLATE_CACHE_MAX_ENTRIES);
+  }
+
+  Entry *entry = nullptr;
+
+  if (_entries.size() < TEMPLATE_CACHE_MAX_ENTRIES) {
+    _entries.emplace_back();
+    entry = &_entries.back();
+  } else {
+    // Replace the least recently used entry
+    entry = &_entries[0];
+
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+      if (it->lastUsed < entry->lastUsed) {
+        entry = &(*it);
+      }
+    }
+  }
+  entry->hash     = hash;
+  entry->lastUsed = _useCounter;
+
+  // Templates which cannot be compiled are also kept, to not try to compile them again.
+  entry->valid = entry->compiled.compile(source);
+  STOP_TIMER(PARSE_TEMPLATE_COMPILE);
+
+  return entry->valid ? &(entry->compiled) : nullptr;
+}
+
+void CompiledTemplateCache::clear()
+{
+  _entries.clear();
+
+  for (uint8_t i = 0; i < TEMPLATE_CACHE_MAX_ENTRIES; ++i) {
+    _seen[i] = 0;
+  }
+}
+
+uint32_t CompiledTemplateCache::computeHash(const String& source)
+{
+  // FNV-1a
+  uint32_t hash         = 2166136261UL;
+  const size_t length   = source.length();
+  const char  *str      = source.c_str();
+
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(str[i]);
+    hash *= 16777619UL;
+  }
+
+  // 0 is used to mark an empty slot in the list of seen templates.
+  return hash == 0 ? 1 : hash;
+}
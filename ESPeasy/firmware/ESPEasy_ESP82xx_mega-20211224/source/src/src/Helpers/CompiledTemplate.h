@@ -0,0 +1,115 @@
+#ifndef HELPERS_COMPILEDTEMPLATE_H
+#define HELPERS_COMPILEDTEMPLATE_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../DataTypes/TaskIndex.h"
+
+#include <vector>
+
+
+// Maximum number of compiled templates kept in RAM.
+#ifndef TEMPLATE_CACHE_MAX_ENTRIES
+# ifdef ESP32
+#  define TEMPLATE_CACHE_MAX_ENTRIES  32
+# else // ifdef ESP32
+#  define TEMPLATE_CACHE_MAX_ENTRIES  12
+# endif // ifdef ESP32
+#endif // ifndef TEMPLATE_CACHE_MAX_ENTRIES
+
+// Longer templates (e.g. custom web pages) are always parsed.
+#ifndef TEMPLATE_CACHE_MAX_LENGTH
+# define TEMPLATE_CACHE_MAX_LENGTH    256
+#endif // ifndef TEMPLATE_CACHE_MAX_LENGTH
+
+
+/*********************************************************************************************\
+* CompiledTemplate
+* Template string split into literal text and [...#...] references with resolved task and
+* value indices, so it does not need to be parsed again for every call to parseTemplate.
+\*********************************************************************************************/
+struct CompiledTemplate {
+  // Split the template in segments.
+  // Return false when the template cannot be rendered via a compiled version.
+  bool compile(const String& source);
+
+  // Render the template up to the point where the legacy parser calls parseStandardConversions().
+  // Return false when the template must be parsed as a whole, newString is then undefined.
+  bool render(String& newString,
+              uint8_t minimal_lineSize,
+              bool    useURLencode) const;
+
+  const String& getSource() const {
+    return _source;
+  }
+
+private:
+
+  enum class SegmentType : uint8_t {
+    Literal,        // Static text
+    DynamicLiteral, // Text with system variables or special characters
+    TaskValue,      // [taskname#valuename]
+    TaskGetConfig,  // [taskname#config], handled via PLUGIN_GET_CONFIG
+    Variable,       // [var#N]
+    IntVariable,    // [int#N]
+    PluginRequest,  // [plugin#gpio#pinstate#N]
+    Empty           // Reference which will not result in any output
+  };
+
+  struct Segment {
+    String       text; // Literal text, PLUGIN_GET_CONFIG value name or plugin request command
+    String       format;
+    unsigned int varNum    = 0;
+    taskIndex_t  taskIndex = INVALID_TASK_INDEX;
+    uint8_t      valueNr   = 0;
+    SegmentType  type      = SegmentType::Empty;
+  };
+
+  void addLiteral(const String& source,
+                  int           start,
+                  int           end);
+
+  String               _source;
+  std::vector<Segment> _segments;
+  uint16_t             _reserveSize = 0;
+  bool                 _hasDynamicLiterals = false;
+};
+
+
+/*********************************************************************************************\
+* CompiledTemplateCache
+* Keeps the compiled version of templates which are parsed repeatedly, like display lines,
+* controller payloads and HTTP templates.
+\*********************************************************************************************/
+class CompiledTemplateCache {
+public:
+
+  // Get the compiled version of the template.
+  // A template is compiled when it is seen for the second time, to keep one-off strings out of the cache.
+  // Return nullptr when no compiled version is available.
+  const CompiledTemplate* get(const String& source);
+
+  // Must be called when task names or value names may have changed.
+  void                    clear();
+
+private:
+
+  struct Entry {
+    CompiledTemplate compiled;
+    uint32_t         hash     = 0;
+    uint32_t         lastUsed = 0;
+    bool             valid    = false;
+  };
+
+  static uint32_t computeHash(const String& source);
+
+  std::vector<Entry> _entries;
+
+  // Hashes of recently seen templates which are not (yet) compiled
+  uint32_t _seen[TEMPLATE_CACHE_MAX_ENTRIES] = { 0 };
+  uint8_t  _seenIndex                        = 0;
+  uint32_t _useCounter                       = 0;
+};
+
+
+#endif // HELPERS_COMPILEDTEMPLATE_H
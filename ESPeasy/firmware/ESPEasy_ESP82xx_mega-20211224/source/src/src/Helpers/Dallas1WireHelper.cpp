@@ -2,6 +2,7 @@
 
 #include "../../_Plugin_Helper.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Helpers/CRC_functions.h"
 #include "../Helpers/ESPEasy_Storage.h"
 #include "../Helpers/Misc.h"
 
@@ -996,23 +997,7 @@ bool Dallas_address_ROM(const uint8_t ROM[8], int8_t gpio_pin_rx, int8_t gpio_pi
 \*********************************************************************************************/
 bool Dallas_crc8(const uint8_t *addr)
 {
-  uint8_t crc = 0;
-  uint8_t len = 8;
-
-  while (len--)
-  {
-    uint8_t inbyte = *addr++; // from 0 to 7
-
-    for (uint8_t i = 8; i; i--)
-    {
-      uint8_t mix = (crc ^ inbyte) & 0x01;
-      crc >>= 1;
-
-      if (mix) { crc ^= 0x8C; }
-      inbyte >>= 1;
-    }
-  }
-  return crc == *addr; // addr 8
+  return calc_CRC8_Maxim(addr, 8) == addr[8];
 }
 
 /*********************************************************************************************\
@@ -1020,27 +1005,8 @@ bool Dallas_crc8(const uint8_t *addr)
 \*********************************************************************************************/
 uint16_t Dallas_crc16(const uint8_t *input, uint16_t len, uint16_t crc)
 {
-  static const uint8_t oddparity[16] =
-  { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
-
-  for (uint16_t i = 0; i < len; i++) {
-    // Even though we're just copying a byte from the input,
-    // we'll be doing 16-bit computation with it.
-    uint16_t cdata = input[i];
-    cdata = (cdata ^ crc) & 0xff;
-    crc >>= 8;
-
-    if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4]) {
-      crc ^= 0xC001;
-    }
-
-    cdata <<= 6;
-    crc    ^= cdata;
-    cdata <<= 1;
-    crc    ^= cdata;
-  }
-
-  return crc;
+  // The Dallas CRC16 is CRC-16/ARC, the caller inverts the result.
+  return calc_CRC16_ARC(input, len, crc);
 }
 
 #if defined(ESP32)
@@ -60,6 +60,9 @@ void stream_json_timing_stats(const TimingStats& stats, long timeSinceLastReset)
   json_number(F("min"),   String(minVal));
   json_number(F("max"),   String(maxVal));
   json_number(F("avg"),   String(stats.getAvg()));
+  json_number(F("p50"),   String(stats.getPercentile(50)));
+  json_number(F("p95"),   String(stats.getPercentile(95)));
+  json_number(F("p99"),   String(stats.getPercentile(99)));
   json_prop(F("unit"), F("usec"));
 }
 
@@ -153,28 +156,34 @@ void jsonStatistics(bool clearStats) {
 
 
   json_open(true, F("misc"));
-  for (auto& x: miscStats) {
-    if (!x.second.isEmpty()) {
+  for (int stat = 0; stat < TIMING_STATS_MISC_MAX; ++stat) {
+    TimingStats& stats = miscStats[stat];
+    if (!stats.isEmpty()) {
       json_open(); // open new misc item
-      json_prop(F("name"), getMiscStatsName(x.first));
-      json_prop(F("id"),   String(x.first));
+      json_prop(F("name"), getMiscStatsName(stat));
+      json_prop(F("id"),   String(stat));
       json_open(true, F("function")); // open function
       json_open(); // open first function element
       // Stream function timing stats
-      json_open(false, to_internal_string(getMiscStatsName(x.first), '-'));
+      json_open(false, to_internal_string(getMiscStatsName(stat), '-'));
       {
-        stream_json_timing_stats(x.second, timeSinceLastReset);
+        stream_json_timing_stats(stats, timeSinceLastReset);
       }
       json_close(false);
       json_close();     // close first function element
       json_close(true); // close function
       json_close();     // close misc item
-      if (clearStats) { x.second.reset(); }
+      if (clearStats) { stats.reset(); }
     }
   }
 
   json_close(true);   // Close misc list
 
+  // Time span covered by the stats
+  json_number(F("window"), String(timeSinceLastReset));
+  json_number(F("dropped"), String(pluginStats.droppedCount() + controllerStats.droppedCount()));
+  json_number(F("no_histogram"), String(TimingStats::getNoHistogramCount()));
+
   if (clearStats) {
     timingstats_last_reset = millis();
   }
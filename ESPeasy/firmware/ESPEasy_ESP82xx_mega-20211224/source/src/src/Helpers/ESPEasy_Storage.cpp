@@ -143,6 +143,11 @@ fs::File tryOpenFile(const String& fname, const String& mode) {
     }
     Cache.fileExistsMap.clear();
   }
+
+  if (!mode.startsWith(F("r"))) {
+    // File may be changed, make sure no outdated compiled rules will be used.
+    Cache.rulesHelper.invalidate(fname);
+  }
   f = ESPEASY_FS.open(patch_fname(fname), mode.c_str());
   STOP_TIMER(TRY_OPEN_FILE);
   return f;
@@ -785,6 +790,9 @@ String SaveTaskSettings(taskIndex_t TaskIndex)
     return F("Save error");
     #endif
   }
+  // Cached copy is no longer valid, it will be stored again on the next load.
+  Cache.extraTaskSettingsCache.clear(TaskIndex);
+
   String err = SaveToFile(SettingsType::Enum::TaskSettings_Type,
                           TaskIndex,
                           reinterpret_cast<const uint8_t *>(&ExtraTaskSettings),
@@ -813,6 +821,11 @@ String LoadTaskSettings(taskIndex_t TaskIndex)
   #endif
 
   START_TIMER
+
+  if (Cache.extraTaskSettingsCache.load(TaskIndex, ExtraTaskSettings)) {
+    STOP_TIMER(LOAD_TASK_SETTINGS_CACHED);
+    return String();
+  }
   ExtraTaskSettings.clear();
   const String result = LoadFromFile(SettingsType::Enum::TaskSettings_Type, TaskIndex, reinterpret_cast<uint8_t *>(&ExtraTaskSettings), sizeof(struct ExtraTaskSettingsStruct));
 
@@ -838,6 +851,10 @@ String LoadTaskSettings(taskIndex_t TaskIndex)
     PluginCall(PLUGIN_GET_DEVICEVALUENAMES, &TempEvent, tmp);
   }
   ExtraTaskSettings.validate();
+
+  if (result.isEmpty()) {
+    Cache.extraTaskSettingsCache.store(ExtraTaskSettings);
+  }
   STOP_TIMER(LOAD_TASK_SETTINGS);
 
   return result;
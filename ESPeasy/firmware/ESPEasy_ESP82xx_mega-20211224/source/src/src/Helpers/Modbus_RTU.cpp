@@ -2,11 +2,14 @@
 
 
 #include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Helpers/CRC_functions.h"
 #include "../Helpers/ESPEasy_time_calc.h"
 #include "../Helpers/StringConverter.h"
 
+#include <list>
 
-ModbusRTU_struct::ModbusRTU_struct() : easySerial(nullptr) {
+
+ModbusRTU_struct::ModbusRTU_struct() : _bus(nullptr) {
   reset();
 }
 
@@ -15,9 +18,10 @@ ModbusRTU_struct::~ModbusRTU_struct() {
 }
 
 void ModbusRTU_struct::reset() {
-  if (easySerial != nullptr) {
-    delete easySerial;
-    easySerial = nullptr;
+  if (_bus != nullptr) {
+    _bus->removeTransactions(this);
+    ModbusRTU_bus::release(_bus);
+    _bus = nullptr;
   }
   detected_device_description = "";
 
@@ -36,26 +40,21 @@ void ModbusRTU_struct::reset() {
   _reads_nodata     = 0;
 }
 
-bool ModbusRTU_struct::init(const ESPEasySerialPort port, const int16_t serial_rx, const int16_t serial_tx, int16_t baudrate, uint8_t address) {
+bool ModbusRTU_struct::init(const ESPEasySerialPort port, const int16_t serial_rx, const int16_t serial_tx, unsigned int baudrate, uint8_t address) {
   return init(port, serial_rx, serial_tx, baudrate, address, -1);
 }
 
-bool ModbusRTU_struct::init(const ESPEasySerialPort port, const int16_t serial_rx, const int16_t serial_tx, int16_t baudrate, uint8_t address, int8_t dere_pin) {
-  if ((serial_rx < 0) || (serial_tx < 0)) {
+bool ModbusRTU_struct::init(const ESPEasySerialPort port, const int16_t serial_rx, const int16_t serial_tx, unsigned int baudrate, uint8_t address, int8_t dere_pin) {
+  if ((serial_rx < 0) || (serial_tx < 0) || (baudrate == 0)) {
     return false;
   }
   reset();
-  easySerial = new (std::nothrow) ESPeasySerial(port, serial_rx, serial_tx);
-  if (easySerial == nullptr) { return false; }
-  easySerial->begin(baudrate);
+
+  // Tasks using the same serial port share the bus.
+  _bus = ModbusRTU_bus::acquire(port, serial_rx, serial_tx, baudrate, dere_pin);
 
   if (!isInitialized()) { return false; }
   _modbus_address = address;
-  _dere_pin       = dere_pin;
-
-  if (_dere_pin != -1) { // set output pin mode for DE/RE pin when used (for control MAX485)
-    pinMode(_dere_pin, OUTPUT);
-  }
 
   detected_device_description = getDevice_description(_modbus_address);
 
@@ -69,7 +68,7 @@ bool ModbusRTU_struct::init(const ESPEasySerialPort port, const int16_t serial_r
 }
 
 bool ModbusRTU_struct::isInitialized() const {
-  return easySerial != nullptr;
+  return (_bus != nullptr) && _bus->isInitialized();
 }
 
 void ModbusRTU_struct::getStatistics(uint32_t& pass, uint32_t& fail, uint32_t& nodata) const {
@@ -412,7 +411,7 @@ void ModbusRTU_struct::logModbusException(uint8_t value) {
     return log;
    }
  */
-uint8_t ModbusRTU_struct::processCommand() {
+void ModbusRTU_struct::appendCRC() {
   // CRC-calculation
   unsigned int crc =
     ModRTU_CRC(_sendframe, _sendframe_used);
@@ -424,6 +423,17 @@ uint8_t ModbusRTU_struct::processCommand() {
 
   _sendframe[_sendframe_used++] = checksumLo;
   _sendframe[_sendframe_used++] = checksumHi;
+}
+
+uint8_t ModbusRTU_struct::processCommand() {
+  if (!isInitialized()) {
+    return MODBUS_NODATA;
+  }
+  waitForTransaction();
+
+  unsigned int crc;
+
+  appendCRC();
 
   int  nrRetriesLeft = 2;
   uint8_t return_value  = 0;
@@ -432,12 +442,14 @@ uint8_t ModbusRTU_struct::processCommand() {
     return_value = 0;
 
     // Send the uint8_t array
-    startWrite();
-    easySerial->write(_sendframe, _sendframe_used);
+    if (_bus->startWrite()) {
+      delay(2); // Switching may take some time
+    }
+    _bus->easySerial->write(_sendframe, _sendframe_used);
 
     // sent all data from buffer
-    easySerial->flush();
-    startRead();
+    _bus->easySerial->flush();
+    _bus->startRead();
 
     // Read answer from sensor
     _recv_buf_used = 0;
@@ -454,11 +466,11 @@ uint8_t ModbusRTU_struct::processCommand() {
         invalidDueToTimeout = true;
       }
 
-      while (!invalidDueToTimeout && easySerial->available() && _recv_buf_used < MODBUS_RECEIVE_BUFFER) {
+      while (!invalidDueToTimeout && _bus->easySerial->available() && _recv_buf_used < MODBUS_RECEIVE_BUFFER) {
         if (timeOutReached(timeout)) {
           invalidDueToTimeout = true;
         }
-        _recv_buf[_recv_buf_used++] = easySerial->read();
+        _recv_buf[_recv_buf_used++] = _bus->easySerial->read();
       }
 
       if (_recv_buf_used > 2) {                                         // got length
@@ -506,11 +518,138 @@ uint8_t ModbusRTU_struct::processCommand() {
         break;
     }
     --nrRetriesLeft;
+    _bus->setBusActivity();
   }
   _last_error = return_value;
   return return_value;
 }
 
+bool ModbusRTU_struct::addTransaction(const ModbusRTU_transaction& transaction) {
+  if (!isInitialized()) {
+    return false;
+  }
+
+  switch (transaction.functionCode) {
+    case MODBUS_READ_HOLDING_REGISTERS:
+    case MODBUS_READ_INPUT_REGISTERS:
+    case MODBUS_WRITE_SINGLE_REGISTER:
+    case MODBUS_WRITE_MULTIPLE_REGISTERS:
+      break;
+    default:
+      return false;
+  }
+  return _bus->addTransaction(this, transaction);
+}
+
+void ModbusRTU_struct::loop() {
+  if (isInitialized()) {
+    _bus->loop();
+  }
+}
+
+bool ModbusRTU_struct::isIdle() const {
+  return !isInitialized() || _bus->isIdle(this);
+}
+
+void ModbusRTU_struct::removeTransactions(taskIndex_t taskIndex) {
+  if (isInitialized()) {
+    _bus->removeTransactions(this, taskIndex);
+  }
+}
+
+void ModbusRTU_struct::buildTransaction(const ModbusRTU_transaction& transaction) {
+  if (transaction.functionCode == MODBUS_WRITE_MULTIPLE_REGISTERS) {
+    buildWriteMult16bRegister(transaction.slaveAddress, transaction.startAddress, transaction.parameter);
+  } else {
+    buildFrame(transaction.slaveAddress, transaction.functionCode, transaction.startAddress, transaction.parameter);
+  }
+  appendCRC();
+  _recv_buf_used = 0;
+}
+
+uint16_t ModbusRTU_struct::getExpectedReplyLength() const {
+  if (_recv_buf_used < 3) {
+    return 0;
+  }
+  const uint8_t received_functionCode = _recv_buf[1];
+
+  if ((received_functionCode & 0x80) != 0) {
+    // Exception: address, function code, exception code, CRC
+    return 5;
+  }
+
+  switch (received_functionCode) {
+    case MODBUS_WRITE_SINGLE_REGISTER:
+    case MODBUS_WRITE_MULTIPLE_REGISTERS:
+      // address, function code, register address, value or nr registers, CRC
+      return 8;
+    default:
+      break;
+  }
+
+  // address, function code, nr bytes, data, CRC
+  return 3 + _recv_buf[2] + 2;
+}
+
+uint8_t ModbusRTU_struct::checkReply(bool timeout) {
+  if (timeout) {
+    ++_reads_nodata;
+    return (_recv_buf_used == 0) ? MODBUS_NODATA : MODBUS_TIMEOUT;
+  }
+
+  // crc16 is 0 for whole valid pkt
+  if ((ModRTU_CRC(_recv_buf, _recv_buf_used) != 0) || (_recv_buf[0] != _sendframe[0])) {
+    ++_reads_crc_failed;
+    return MODBUS_BADCRC;
+  }
+  ++_reads_pass;
+  _reads_nodata = 0;
+
+  if ((_recv_buf[1] & 0x80) != 0) {
+    return _recv_buf[2];
+  }
+  return 0;
+}
+
+void ModbusRTU_struct::finishTransaction(const ModbusRTU_transaction& transaction, uint8_t errorcode) {
+  _last_error = errorcode;
+
+  if (errorcode != 0) {
+    logModbusException(errorcode);
+  }
+
+  if (transaction.callback != nullptr) {
+    const uint8_t *data   = nullptr;
+    uint8_t        length = 0;
+
+    if (errorcode == 0) {
+      if ((transaction.functionCode == MODBUS_READ_HOLDING_REGISTERS) ||
+          (transaction.functionCode == MODBUS_READ_INPUT_REGISTERS)) {
+        data   = &_recv_buf[3];
+        length = _recv_buf[2];
+      } else {
+        // Echo of register address and value or nr registers
+        data   = &_recv_buf[2];
+        length = 4;
+      }
+    }
+    transaction.callback(transaction, errorcode, data, length);
+  }
+}
+
+void ModbusRTU_struct::waitForTransaction() {
+  // A running transaction of this instance uses the same buffers, so keep the frame to send.
+  uint8_t sendframe[sizeof(_sendframe)];
+  const uint8_t sendframe_used = _sendframe_used;
+
+  memcpy(sendframe, _sendframe, sizeof(_sendframe));
+
+  _bus->waitForTransaction();
+
+  memcpy(_sendframe, sendframe, sizeof(_sendframe));
+  _sendframe_used = sendframe_used;
+}
+
 uint32_t ModbusRTU_struct::read_32b_InputRegister(short address) {
   uint32_t result = 0;
   uint8_t     errorcode;
@@ -726,21 +865,7 @@ unsigned int ModbusRTU_struct::read_RAM_EEPROM(uint8_t command, uint8_t startAdd
 
 // Compute the MODBUS RTU CRC
 unsigned int ModbusRTU_struct::ModRTU_CRC(uint8_t *buf, int len) {
-  unsigned int crc = 0xFFFF;
-
-  for (int pos = 0; pos < len; pos++) {
-    crc ^= (unsigned int)buf[pos]; // XOR uint8_t into least sig. uint8_t of crc
-
-    for (int i = 8; i != 0; i--) { // Loop over each bit
-      if ((crc & 0x0001) != 0) {   // If the LSB is set
-        crc >>= 1;                 // Shift right and XOR 0xA001
-        crc  ^= 0xA001;
-      } else {                     // Else LSB is not set
-        crc >>= 1;                 // Just shift right
-      }
-    }
-  }
-  return crc;
+  return calc_CRC16_Modbus(buf, len);
 }
 
 uint32_t ModbusRTU_struct::readTypeId() {
@@ -759,14 +884,274 @@ uint32_t ModbusRTU_struct::getFailedReadsSinceLastValid() const {
   return _reads_nodata;
 }
 
-void ModbusRTU_struct::startWrite() {
+/*********************************************************************************************\
+* ModbusRTU_bus
+\*********************************************************************************************/
+
+// Function-local static, to not depend on the order of initialization.
+static std::list<ModbusRTU_bus *>& getModbusRTU_buses() {
+  static std::list<ModbusRTU_bus *> buses;
+
+  return buses;
+}
+
+ModbusRTU_bus * ModbusRTU_bus::acquire(const ESPEasySerialPort port,
+                                       const int16_t           serial_rx,
+                                       const int16_t           serial_tx,
+                                       unsigned int            baudrate,
+                                       int8_t                  dere_pin) {
+  std::list<ModbusRTU_bus *>& buses = getModbusRTU_buses();
+
+  for (auto it = buses.begin(); it != buses.end(); ++it) {
+    ModbusRTU_bus *bus = *it;
+
+    if ((bus->_port == port) && (bus->_serial_rx == serial_rx) && (bus->_serial_tx == serial_tx)) {
+      if ((bus->_baudrate != baudrate) ||
+          ((dere_pin != -1) && (bus->_dere_pin != -1) && (bus->_dere_pin != dere_pin))) {
+        addLog(LOG_LEVEL_ERROR, F("Modbus: Serial port already used with other baudrate or DE/RE pin"));
+        return nullptr;
+      }
+
+      if ((bus->_dere_pin == -1) && (dere_pin != -1)) {
+        bus->_dere_pin = dere_pin;
+        pinMode(dere_pin, OUTPUT);
+      }
+      ++bus->_nrUsers;
+      return bus;
+    }
+  }
+
+  ModbusRTU_bus *bus = new (std::nothrow) ModbusRTU_bus(port, serial_rx, serial_tx, baudrate, dere_pin);
+
+  if (bus == nullptr) {
+    return nullptr;
+  }
+
+  if (!bus->isInitialized()) {
+    delete bus;
+    return nullptr;
+  }
+  bus->_nrUsers = 1;
+  buses.push_back(bus);
+  return bus;
+}
+
+void ModbusRTU_bus::release(ModbusRTU_bus *bus) {
+  if (bus == nullptr) {
+    return;
+  }
+
+  if (bus->_nrUsers > 1) {
+    --bus->_nrUsers;
+    return;
+  }
+  getModbusRTU_buses().remove(bus);
+  delete bus;
+}
+
+ModbusRTU_bus::ModbusRTU_bus(const ESPEasySerialPort port,
+                             const int16_t           serial_rx,
+                             const int16_t           serial_tx,
+                             unsigned int            baudrate,
+                             int8_t                  dere_pin)
+  : _port(port), _serial_rx(serial_rx), _serial_tx(serial_tx), _baudrate(baudrate), _dere_pin(dere_pin)
+{
+  easySerial = new (std::nothrow) ESPeasySerial(port, serial_rx, serial_tx);
+
+  if (easySerial == nullptr) { return; }
+  easySerial->begin(baudrate);
+
+  // A character on the bus is 11 bits (start, 8 data, parity or stop, stop)
+  // Frames must be separated by 3.5 characters, using a fixed 1750 usec above 19200 baud.
+  const unsigned long charTime_usec = 11000000UL / baudrate;
+
+  _interFrameDelay_usec = (baudrate > 19200) ? 1750 : ((7 * charTime_usec) / 2);
+
+  if (_dere_pin != -1) { // set output pin mode for DE/RE pin when used (for control MAX485)
+    pinMode(_dere_pin, OUTPUT);
+  }
+}
+
+ModbusRTU_bus::~ModbusRTU_bus() {
+  if (easySerial != nullptr) {
+    delete easySerial;
+    easySerial = nullptr;
+  }
+}
+
+bool ModbusRTU_bus::isInitialized() const {
+  return easySerial != nullptr;
+}
+
+bool ModbusRTU_bus::addTransaction(ModbusRTU_struct *owner, const ModbusRTU_transaction& transaction) {
+  if ((owner == nullptr) || (_transactions.size() >= MODBUS_MAX_TRANSACTIONS)) {
+    return false;
+  }
+  _transactions.push_back({ owner, transaction });
+  return true;
+}
+
+void ModbusRTU_bus::loop() {
+  if (!isInitialized()) {
+    return;
+  }
+
+  switch (_state) {
+    case State::Idle:
+    {
+      if (_transactions.empty() ||
+          (usecPassedSince(_lastBusActivity) < static_cast<long>(_interFrameDelay_usec))) {
+        return;
+      }
+
+      // Discard data received outside a transaction
+      while (easySerial->available()) {
+        easySerial->read();
+      }
+      ModbusRTU_struct *owner = _transactions.front().owner;
+
+      owner->buildTransaction(_transactions.front().transaction);
+
+      // Unlike processCommand(), do not wait 2 msec after switching a RS485 driver to transmit.
+      // The driver enable time of a MAX485 is in the order of a usec, and is well within
+      // the time needed to write the frame to the UART.
+      startWrite();
+      easySerial->write(owner->_sendframe, owner->_sendframe_used);
+
+      // The slave replies 3.5 characters after the frame, so switch a RS485 driver to receive
+      // right after sending instead of on the next call.
+      // The frame is at most 12 bytes, so flush() waits at most 12 character times.
+      startRead();
+      _receiveTimeout = millis() + owner->_modbus_timeout;
+      _state          = State::Receiving;
+    }
+    // fall through - read what is already received
+    case State::Receiving:
+    {
+      ModbusRTU_struct *owner = _transactions.front().owner;
+
+      if (owner == nullptr) {
+        // Owner was removed, ignore the reply.
+        while (easySerial->available()) {
+          easySerial->read();
+          _lastBusActivity = micros();
+        }
+
+        if (timeOutReached(_receiveTimeout)) {
+          finishTransaction(MODBUS_NODATA);
+        }
+        return;
+      }
+
+      // _recv_buf_used is 8 bit, so stop 1 byte before the end of the buffer.
+      while (easySerial->available() && owner->_recv_buf_used < (MODBUS_RECEIVE_BUFFER - 1)) {
+        owner->_recv_buf[owner->_recv_buf_used++] = easySerial->read();
+        _lastBusActivity                          = micros();
+      }
+      const uint16_t expectedLength = owner->getExpectedReplyLength();
+      const bool     complete       = (owner->_recv_buf_used >= (MODBUS_RECEIVE_BUFFER - 1)) ||
+                                      ((expectedLength != 0) && (owner->_recv_buf_used >= expectedLength));
+
+      if (!complete && !timeOutReached(_receiveTimeout)) {
+        return;
+      }
+      const uint8_t errorcode = owner->checkReply(!complete);
+
+      switch (errorcode) {
+        case MODBUS_EXCEPTION_ACKNOWLEDGE:
+        case MODBUS_EXCEPTION_SLAVE_OR_SERVER_BUSY:
+        case MODBUS_BADCRC:
+        case MODBUS_TIMEOUT:
+
+          // Bad communication, makes sense to retry.
+          if (_nrRetriesLeft > 0) {
+            --_nrRetriesLeft;
+            _state           = State::Idle;
+            _lastBusActivity = micros();
+            return;
+          }
+          break;
+        default:
+          break;
+      }
+      finishTransaction(errorcode);
+      break;
+    }
+  }
+}
+
+bool ModbusRTU_bus::isIdle(const ModbusRTU_struct *owner) const {
+  for (auto it = _transactions.begin(); it != _transactions.end(); ++it) {
+    if (it->owner == owner) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ModbusRTU_bus::removeTransactions(const ModbusRTU_struct *owner, taskIndex_t taskIndex) {
+  auto it = _transactions.begin();
+
+  if ((it != _transactions.end()) && (_state != State::Idle)) {
+    // Running transaction, must still wait for the reply.
+    if ((it->owner == owner) && (it->transaction.taskIndex == taskIndex)) {
+      it->transaction.callback = nullptr;
+    }
+    ++it;
+  }
+
+  while (it != _transactions.end()) {
+    if ((it->owner == owner) && (it->transaction.taskIndex == taskIndex)) {
+      it = _transactions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ModbusRTU_bus::removeTransactions(const ModbusRTU_struct *owner) {
+  auto it = _transactions.begin();
+
+  if ((it != _transactions.end()) && (_state != State::Idle)) {
+    // Running transaction, the reply is received in the buffer of the owner.
+    if (it->owner == owner) {
+      it->owner = nullptr;
+    }
+    ++it;
+  }
+
+  while (it != _transactions.end()) {
+    if (it->owner == owner) {
+      it = _transactions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ModbusRTU_bus::waitForTransaction() {
+  while (_state != State::Idle) {
+    loop();
+    delay(0);
+  }
+
+  while (usecPassedSince(_lastBusActivity) < static_cast<long>(_interFrameDelay_usec)) {
+    delay(0);
+  }
+}
+
+void ModbusRTU_bus::setBusActivity() {
+  _lastBusActivity = micros();
+}
+
+bool ModbusRTU_bus::startWrite() {
   // transmit to device  -> DE Enable, /RE Disable (for control MAX485)
-  if ((_dere_pin == -1) || !isInitialized()) { return; }
+  if ((_dere_pin == -1) || !isInitialized()) { return false; }
   digitalWrite(_dere_pin, HIGH);
-  delay(2); // Switching may take some time
+  return true;
 }
 
-void ModbusRTU_struct::startRead() {
+void ModbusRTU_bus::startRead() {
   if (!isInitialized()) { return; }
   easySerial->flush(); // clear out tx buffer
 
@@ -775,3 +1160,22 @@ void ModbusRTU_struct::startRead() {
     digitalWrite(_dere_pin, LOW);
   }
 }
+
+void ModbusRTU_bus::finishTransaction(uint8_t errorcode) {
+  _state           = State::Idle;
+  _nrRetriesLeft   = 1;
+  _lastBusActivity = micros();
+
+  if (_transactions.empty()) {
+    return;
+  }
+
+  // Remove before calling the callback, so the callback may add new transactions.
+  const Transaction transaction = _transactions.front();
+
+  _transactions.pop_front();
+
+  if (transaction.owner != nullptr) {
+    transaction.owner->finishTransaction(transaction.transaction, errorcode);
+  }
+}
@@ -5,6 +5,10 @@
 #include <Arduino.h>
 #include <ESPeasySerial.h>
 
+#include <deque>
+
+#include "../DataTypes/TaskIndex.h"
+
 
 #define MODBUS_RECEIVE_BUFFER 256
 #define MODBUS_BROADCAST_ADDRESS 0xFE
@@ -42,6 +46,130 @@
 #define MODBUS_TIMEOUT  (MODBUS_EXCEPTION_GATEWAY_TARGET + 7)
 #define MODBUS_NODATA   (MODBUS_EXCEPTION_GATEWAY_TARGET + 8)
 
+// Max. number of queued asynchronous transactions per bus
+#ifndef MODBUS_MAX_TRANSACTIONS
+# define MODBUS_MAX_TRANSACTIONS 16
+#endif // ifndef MODBUS_MAX_TRANSACTIONS
+
+
+struct ModbusRTU_transaction;
+
+// Called when an asynchronous transaction is finished.
+// errorcode is 0 on success, data points to the data bytes of the reply
+// (e.g. the register values, MSB first) and is only valid during the call.
+typedef void (*ModbusRTU_callback_t)(const ModbusRTU_transaction& transaction,
+                                     uint8_t                      errorcode,
+                                     const uint8_t               *data,
+                                     uint8_t                      length);
+
+struct ModbusRTU_transaction {
+  ModbusRTU_callback_t callback     = nullptr;
+  taskIndex_t          taskIndex    = INVALID_TASK_INDEX;
+  uint8_t              index        = 0; // Free to use by the caller, e.g. the value index
+  uint8_t              slaveAddress = MODBUS_BROADCAST_ADDRESS;
+  uint8_t              functionCode = MODBUS_READ_HOLDING_REGISTERS;
+  uint16_t             startAddress = 0;
+  uint16_t             parameter    = 1; // Nr of registers to read, or the value to write
+};
+
+struct ModbusRTU_struct;
+
+
+/*********************************************************************************************\
+* ModbusRTU_bus
+* Serial port shared by all ModbusRTU_struct instances using the same port and pins,
+* e.g. several tasks reading devices with a different slave address on one RS485 bus.
+* The asynchronous transactions of all these instances are kept in a single queue,
+* so frames sent by different tasks never overlap.
+\*********************************************************************************************/
+struct ModbusRTU_bus {
+  // Return the bus of the serial port and pins, creating it when not yet in use.
+  // Return nullptr when the port is already in use with another baudrate or DE/RE pin.
+  static ModbusRTU_bus* acquire(const ESPEasySerialPort port,
+                                const int16_t           serial_rx,
+                                const int16_t           serial_tx,
+                                unsigned int            baudrate,
+                                int8_t                  dere_pin);
+
+  // Delete the bus when it is no longer used by any ModbusRTU_struct.
+  static void release(ModbusRTU_bus *bus);
+
+  ModbusRTU_bus(const ESPEasySerialPort port,
+                const int16_t           serial_rx,
+                const int16_t           serial_tx,
+                unsigned int            baudrate,
+                int8_t                  dere_pin);
+
+  ~ModbusRTU_bus();
+
+  // Not copyable, as it owns the serial port.
+  ModbusRTU_bus(const ModbusRTU_bus&)            = delete;
+  ModbusRTU_bus& operator=(const ModbusRTU_bus&) = delete;
+
+  bool isInitialized() const;
+
+  // Return false when the queue is full.
+  bool addTransaction(ModbusRTU_struct            *owner,
+                      const ModbusRTU_transaction& transaction);
+
+  void loop();
+
+  // Return true when no transaction of the owner is queued or running.
+  bool isIdle(const ModbusRTU_struct *owner) const;
+
+  // Remove all queued transactions of the owner for the task, without calling the callback.
+  void removeTransactions(const ModbusRTU_struct *owner,
+                          taskIndex_t             taskIndex);
+
+  // Remove all transactions of the owner, also a running one.
+  // The reply of a running transaction is still received, but ignored.
+  void removeTransactions(const ModbusRTU_struct *owner);
+
+  // Let a running transaction finish and wait for the inter-frame delay,
+  // before a synchronous transaction is sent.
+  void waitForTransaction();
+
+  // Mark the end of a frame, to wait for the inter-frame delay before sending the next one.
+  void setBusActivity();
+
+  // Switch a RS485 driver to transmit.
+  // Return true when a DE/RE pin is used.
+  bool startWrite();
+
+  // Wait for the frame to be sent and switch a RS485 driver to receive.
+  void startRead();
+
+  ESPeasySerial *easySerial = nullptr;
+
+private:
+
+  enum class State : uint8_t {
+    Idle,
+    Receiving
+  };
+
+  struct Transaction {
+    ModbusRTU_struct     *owner; // nullptr when the owner was removed while waiting for the reply
+    ModbusRTU_transaction transaction;
+  };
+
+  void finishTransaction(uint8_t errorcode);
+
+  std::deque<Transaction> _transactions; // Front is the running transaction
+  State         _state                = State::Idle;
+  uint8_t       _nrRetriesLeft        = 1; // Same as processCommand(), which tries twice
+  uint8_t       _nrUsers              = 0;
+  unsigned long _lastBusActivity      = 0; // micros()
+  unsigned long _receiveTimeout       = 0; // millis()
+  unsigned long _interFrameDelay_usec = 0;
+
+  const ESPEasySerialPort _port;
+  const int16_t           _serial_rx;
+  const int16_t           _serial_tx;
+  const unsigned int      _baudrate;
+  int8_t                  _dere_pin;
+};
+
 
 struct ModbusRTU_struct  {
   ModbusRTU_struct();
@@ -53,13 +181,13 @@ struct ModbusRTU_struct  {
   bool init(const ESPEasySerialPort port,
             const int16_t serial_rx,
             const int16_t serial_tx,
-            int16_t       baudrate,
+            unsigned int  baudrate,
             uint8_t          address);
 
   bool init(const ESPEasySerialPort port,
             const int16_t serial_rx,
             const int16_t serial_tx,
-            int16_t       baudrate,
+            unsigned int  baudrate,
             uint8_t          address,
             int8_t        dere_pin);
 
@@ -194,27 +322,62 @@ struct ModbusRTU_struct  {
 
   uint32_t            getFailedReadsSinceLastValid() const;
 
+  /*********************************************************************************************\
+  * Asynchronous transactions
+  * Transactions are queued on the bus and processed by loop(), which never waits for a reply.
+  * Only sending a frame waits until it is transmitted (max. 12 characters), to switch to receive in time.
+  * Call loop() often, e.g. from PLUGIN_FIFTY_PER_SECOND. It processes the transactions of all
+  * ModbusRTU_struct instances sharing the bus.
+  * A frame is only sent when the bus has been idle for the inter-frame delay (3.5 characters).
+  * The synchronous functions above first wait for a running transaction on the bus to finish.
+  \*********************************************************************************************/
+
+  // Queue a read (0x03, 0x04) or write (0x06, 0x10) of registers.
+  // Return false when the queue is full.
+  bool addTransaction(const ModbusRTU_transaction& transaction);
+
+  void loop();
+
+  // Return true when no transaction of this instance is queued or running.
+  bool isIdle() const;
+
+  // Remove all queued transactions of the task, without calling the callback.
+  void removeTransactions(taskIndex_t taskIndex);
+
   String detected_device_description;
 
 private:
 
-  void startWrite();
+  friend struct ModbusRTU_bus;
 
-  void startRead();
+  void appendCRC();
+
+  // Build the frame of an asynchronous transaction in _sendframe.
+  void     buildTransaction(const ModbusRTU_transaction& transaction);
+
+  // Number of bytes of the reply received so far in _recv_buf, 0 when not yet known.
+  uint16_t getExpectedReplyLength() const;
+
+  uint8_t  checkReply(bool timeout);
+
+  void     finishTransaction(const ModbusRTU_transaction& transaction,
+                             uint8_t                      errorcode);
+
+  // Used by the synchronous functions, to not mix up the replies.
+  void     waitForTransaction();
 
   uint8_t     _sendframe[12]                   = { 0 };
   uint8_t     _sendframe_used                  = 0;
   uint8_t     _recv_buf[MODBUS_RECEIVE_BUFFER] = { 0 };
   uint8_t     _recv_buf_used                   = 0;
   uint8_t     _modbus_address                  = MODBUS_BROADCAST_ADDRESS;
-  int8_t   _dere_pin                        = -1;
   uint32_t _reads_pass                      = 0;
   uint32_t _reads_crc_failed                = 0;
   uint32_t _reads_nodata                    = 0; // This will be reset as soon as a valid packet has been received.
   uint16_t _modbus_timeout                  = 180;
   uint8_t  _last_error                      = 0;
 
-  ESPeasySerial *easySerial = nullptr;
+  ModbusRTU_bus *_bus = nullptr;
 };
 
 
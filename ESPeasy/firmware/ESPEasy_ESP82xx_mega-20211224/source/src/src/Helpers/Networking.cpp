@@ -2,13 +2,16 @@
 
 #include "../../ESPEasy_common.h"
 #include "../Commands/InternalCommands.h"
+#include "../DataStructs/LogStruct.h"
 #include "../DataStructs/TimingStats.h"
 #include "../DataTypes/EventValueSource.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
 #include "../ESPEasyCore/ESPEasyNetwork.h"
 #include "../ESPEasyCore/ESPEasyWifi.h"
+#include "../Globals/Cache.h"
 #include "../Globals/ESPEasyWiFiEvent.h"
 #include "../Globals/ESPEasy_Scheduler.h"
+#include "../Globals/Logging.h"
 #include "../Globals/NetworkState.h"
 #include "../Globals/Nodes.h"
 #include "../Globals/Settings.h"
@@ -68,15 +71,48 @@ void etharp_gratuitous_r(struct netif *netif) {
 /*********************************************************************************************\
    Syslog client
 \*********************************************************************************************/
-void syslog(uint8_t logLevel, const char *message)
+void process_syslog()
 {
-  if ((Settings.Syslog_IP[0] != 0) && NetworkConnected())
-  {
-    IPAddress broadcastIP(Settings.Syslog_IP[0], Settings.Syslog_IP[1], Settings.Syslog_IP[2], Settings.Syslog_IP[3]);
+  if (!Logging.available(LogStruct::Sink::Syslog)) {
+    return;
+  }
+
+  if ((Settings.Syslog_IP[0] == 0) || (Settings.SyslogLevel == 0)) {
+    Logging.skipAll(LogStruct::Sink::Syslog);
+    return;
+  }
+
+  if (!NetworkConnected()) {
+    // Keep the lines until the network is back.
+    return;
+  }
+  IPAddress broadcastIP(Settings.Syslog_IP[0], Settings.Syslog_IP[1], Settings.Syslog_IP[2], Settings.Syslog_IP[3]);
+
+  // An RFC3164 compliant message must be formated like :  "<PRIO>[TimeStamp ]Hostname TaskName: Message"
+  // Using Settings.Name as the Hostname (Hostname must NOT content space)
+  // The part after the priority is the same for all lines, so only create it when the settings have changed.
+  if (Cache.syslogHeader.length() == 0) {
+    String hostname = NetworkCreateRFCCompliantHostname(true);
+    hostname.trim();
+    hostname.replace(' ', '_');
+    Cache.syslogHeader.reserve(hostname.length() + 10);
+    Cache.syslogHeader  = hostname;
+    Cache.syslogHeader += F(" EspEasy: ");
+  }
+
+  // RFC 5426 allows only a single message per UDP datagram, so send a few datagrams per call.
+  for (uint8_t i = 0; i < SYSLOG_MAX_LINES_PER_CALL; ++i) {
+    unsigned long timestamp;
+    String message;
+    uint8_t logLevel;
+
+    if (!Logging.getNext(LogStruct::Sink::Syslog, Settings.SyslogLevel, timestamp, message, logLevel)) {
+      return;
+    }
 
-    FeedSW_watchdog();
     if (portUDP.beginPacket(broadcastIP, Settings.SyslogPort) == 0) {
       // problem resolving the hostname or port
+      Logging.markLost(LogStruct::Sink::Syslog);
       return;
     }
     uint8_t prio = Settings.SyslogFacility * 8;
@@ -90,49 +126,16 @@ void syslog(uint8_t logLevel, const char *message)
     else {
       prio += 7;
     }
+    char str[8] = { 0 };
+    snprintf_P(str, sizeof(str), PSTR("<%u>"), prio);
 
-    // An RFC3164 compliant message must be formated like :  "<PRIO>[TimeStamp ]Hostname TaskName: Message"
+    portUDP.write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+    portUDP.write(reinterpret_cast<const uint8_t *>(Cache.syslogHeader.c_str()), Cache.syslogHeader.length());
+    portUDP.write(reinterpret_cast<const uint8_t *>(message.c_str()), message.length());
 
-    // Using Settings.Name as the Hostname (Hostname must NOT content space)
-    {
-      String header;
-      String hostname = NetworkCreateRFCCompliantHostname(true);
-      hostname.trim();
-      hostname.replace(' ', '_');
-      header.reserve(16 + hostname.length());
-      char str[8] = { 0 };
-      snprintf_P(str, sizeof(str), PSTR("<%u>"), prio);
-      header  = str;
-      header += hostname;
-      header += F(" EspEasy: ");
-      #ifdef ESP8266
-      portUDP.write(header.c_str(),            header.length());
-      #endif // ifdef ESP8266
-      #ifdef ESP32
-      portUDP.write(reinterpret_cast<const uint8_t *>(header.c_str()), header.length());
-      #endif // ifdef ESP32
+    if (portUDP.endPacket() == 0) {
+      Logging.markLost(LogStruct::Sink::Syslog);
     }
-    const char *c = message;
-    bool done     = false;
-
-    while (!done) {
-      // Must use PROGMEM aware functions here to process message
-      char ch = pgm_read_byte(c++);
-
-      if (ch == '\0') {
-        done = true;
-      } else {
-        #ifdef ESP8266
-        portUDP.write(ch);
-        #endif // ifdef ESP8266
-        #ifdef ESP32
-        portUDP.write((uint8_t)ch);
-        #endif // ifdef ESP32
-      }
-    }
-    portUDP.endPacket();
-    FeedSW_watchdog();
-    delay(0);
   }
 }
 
@@ -278,16 +281,10 @@ void checkUDP()
 
 #ifndef BUILD_NO_DEBUG
 
-                if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
-                  String log;
-                  log += F("UDP  : ");
-                  log += mac.toString();
-                  log += ',';
-                  log += formatIP(ip);
-                  log += ',';
-                  log += unit;
-                  addLog(LOG_LEVEL_DEBUG_MORE, log);
-                }
+                addLogFmt(LOG_LEVEL_DEBUG_MORE, LogFormat::Id::UDP_SysInfoReceived,
+                          mac,
+                          IPAddress(ip[0], ip[1], ip[2], ip[3]),
+                          unit);
 #endif // ifndef BUILD_NO_DEBUG
                 break;
               }
@@ -405,11 +402,7 @@ void sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
 
 #ifndef BUILD_NO_DEBUG
 
-  if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
-    String log = F("UDP  : Send UDP message to ");
-    log += unit;
-    addLog(LOG_LEVEL_DEBUG_MORE, log);
-  }
+  addLogFmt(LOG_LEVEL_DEBUG_MORE, LogFormat::Id::UDP_SendMessage, unit);
 #endif // ifndef BUILD_NO_DEBUG
 
   statusLED(true);
@@ -10,7 +10,12 @@
 /*********************************************************************************************\
    Syslog client
 \*********************************************************************************************/
-void syslog(uint8_t logLevel, const char *message);
+#ifndef SYSLOG_MAX_LINES_PER_CALL
+# define SYSLOG_MAX_LINES_PER_CALL 4
+#endif // ifndef SYSLOG_MAX_LINES_PER_CALL
+
+// Send new log lines to the syslog server, called from the background tasks.
+void process_syslog();
 
 
 /*********************************************************************************************\
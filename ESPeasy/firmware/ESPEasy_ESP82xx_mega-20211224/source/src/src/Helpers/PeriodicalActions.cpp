@@ -288,24 +288,63 @@ void processMQTTdelayQueue() {
   START_TIMER;
   MQTT_queue_element *element(MQTTDelayHandler->getNext());
 
-  if (element == nullptr) { return; }
+  if (element == nullptr) {
+    MQTT_queueDrainStats.finish();
+    return;
+  }
+  MQTT_queueDrainStats.start();
+
+  // Publish several messages in a single run when allowed by the burst size.
+  // Stop at the first failed publish, or when the burst limits are reached.
+  const unsigned long burstStart = millis();
+  uint32_t burstMessages         = 0;
+  uint32_t burstBytes            = 0;
+  bool     done                  = false;
+
+  while (!done && element != nullptr) {
+    const size_t messageSize = element->_topic.length() + element->_payload.length();
+
+    if (burstMessages > 0) {
+      if ((burstMessages >= MQTTDelayHandler->max_burst) ||
+          ((burstBytes + messageSize) > CONTROLLER_MQTT_BURST_MAX_BYTES) ||
+          (timePassedSince(burstStart) >= CONTROLLER_MQTT_BURST_MAX_DURATION)) {
+        break;
+      }
+#ifdef ESP8266
 
-  if (MQTTclient.publish(element->_topic.c_str(), element->_payload.c_str(), element->_retained)) {
-    if (WiFiEventData.connectionFailures > 0) {
-      --WiFiEventData.connectionFailures;
+      // Only continue the burst when the message fits in the TCP send buffer, so publish() will not block.
+      if (static_cast<size_t>(mqtt.availableForWrite()) < (messageSize + 5)) {
+        break;
+      }
+#endif // ifdef ESP8266
     }
-    MQTTDelayHandler->markProcessed(true);
-  } else {
-    MQTTDelayHandler->markProcessed(false);
+
+    if (MQTTclient.publish(element->_topic.c_str(), element->_payload.c_str(), element->_retained)) {
+      if (WiFiEventData.connectionFailures > 0) {
+        --WiFiEventData.connectionFailures;
+      }
+      MQTTDelayHandler->markProcessed(true);
+      ++burstMessages;
+      burstBytes += messageSize;
+      element     = MQTTDelayHandler->getNext();
+    } else {
+      MQTTDelayHandler->markProcessed(false);
+      done = true;
 #ifndef BUILD_NO_DEBUG
 
-    if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-      String log = F("MQTT : process MQTT queue not published, ");
-      log += MQTTDelayHandler->sendQueue.size();
-      log += F(" items left in queue");
-      addLog(LOG_LEVEL_DEBUG, log);
-    }
+      if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+        String log = F("MQTT : process MQTT queue not published, ");
+        log += MQTTDelayHandler->sendQueue.size();
+        log += F(" items left in queue");
+        addLog(LOG_LEVEL_DEBUG, log);
+      }
 #endif // ifndef BUILD_NO_DEBUG
+    }
+  }
+  MQTT_queueDrainStats.add(burstMessages, burstBytes);
+
+  if (MQTTDelayHandler->sendQueue.empty()) {
+    MQTT_queueDrainStats.finish();
   }
   Scheduler.setIntervalTimerOverride(ESPEasy_Scheduler::IntervalTimer_e::TIMER_MQTT, 10); // Make sure the MQTT is being processed as soon as possible.
   scheduleNextMQTTdelayQueue();
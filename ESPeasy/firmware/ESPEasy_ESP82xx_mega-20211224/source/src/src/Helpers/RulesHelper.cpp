@@ -0,0 +1,324 @@
+#include "../Helpers/RulesHelper.h"
+
+#include "../DataStructs/TimingStats.h"
+#include "../ESPEasyCore/ESPEasyRules.h"
+#include "../ESPEasyCore/ESPEasy_Log.h"
+#include "../Globals/Settings.h"
+#include "../Helpers/ESPEasy_Storage.h"
+#include "../Helpers/Memory.h"
+
+#include <FS.h>
+
+#include <algorithm>
+#include <iterator>
+
+
+bool RulesLine::canSkip(const String& event) const
+{
+  if (!isOn() || trigger.isEmpty() || trigger.equals(F("*"))) {
+    return false;
+  }
+  return !ruleMatch(event, trigger);
+}
+
+String RulesFile::getLine(size_t index) const
+{
+  if (index >= lines.size()) {
+    return EMPTY_STRING;
+  }
+  const RulesLine& line = lines[index];
+
+  return text.substring(line.offset, line.offset + line.length);
+}
+
+void RulesFile::clear()
+{
+  text = String();
+  lines.clear();
+  _eventIndex.clear();
+  _unindexed.clear();
+  _indexed = false;
+}
+
+const std::vector<uint16_t> * RulesFile::getCandidates(const String& event) const
+{
+  // Literal string events ('!') allow for wildcard matches on any part of the event.
+  if (!_indexed || (event.charAt(0) == '!')) {
+    return nullptr;
+  }
+  auto it = _eventIndex.find(RulesHelperClass::getEventIndexKey(event));
+
+  if (it != _eventIndex.end()) {
+    return &(it->second);
+  }
+  return &_unindexed;
+}
+
+void RulesFile::buildEventIndex()
+{
+  _eventIndex.clear();
+  _unindexed.clear();
+  _indexed = false;
+
+  bool inBlock = false;
+  const uint16_t nrLines = lines.size();
+
+  for (uint16_t i = 0; i < nrLines; ++i) {
+    const RulesLine& rulesLine = lines[i];
+
+    if (inBlock) {
+      // "on" lines within a block are not considered as "on" line
+      if (rulesLine.type == RulesLine::Type::EndOn) {
+        inBlock = false;
+      }
+      continue;
+    }
+
+    if (!rulesLine.isOn()) {
+      continue;
+    }
+
+    if (rulesLine.trigger.isEmpty()) {
+      // Trigger only known after parseTemplate(), which may also change
+      // whether it is a block or not. Thus we cannot tell which lines are reachable.
+      _eventIndex.clear();
+      _unindexed.clear();
+      return;
+    }
+
+    if (rulesLine.trigger.equals(F("*"))) {
+      _unindexed.push_back(i);
+    } else if (rulesLine.trigger.charAt(0) != '!') {
+      // Triggers for literal string events are never checked via the index.
+      _eventIndex[RulesHelperClass::getEventIndexKey(rulesLine.trigger)].push_back(i);
+    }
+
+    if (rulesLine.type == RulesLine::Type::OnBlock) {
+      inBlock = true;
+    }
+  }
+
+  if (!_unindexed.empty()) {
+    // Wildcard lines must be checked for every event, in file order.
+    for (auto it = _eventIndex.begin(); it != _eventIndex.end(); ++it) {
+      std::vector<uint16_t> merged;
+      merged.reserve(it->second.size() + _unindexed.size());
+      std::merge(it->second.begin(), it->second.end(),
+                 _unindexed.begin(), _unindexed.end(),
+                 std::back_inserter(merged));
+      it->second = std::move(merged);
+    }
+  }
+  _indexed = true;
+}
+
+const RulesFile * RulesHelperClass::getFile(const String& fileName)
+{
+  if (_invalidated && (_inUse == 0)) {
+    _files.clear();
+    _invalidated = false;
+  }
+
+  if (_invalidated) {
+    // Still processing rules using outdated files, so let the caller read the file itself.
+    return nullptr;
+  }
+
+  auto it = _files.find(fileName);
+
+  if (it != _files.end()) {
+    return &(it->second);
+  }
+
+  if (_files.size() >= RULES_CACHE_MAX_FILES) {
+    return nullptr;
+  }
+
+  RulesFile rulesFile;
+
+  if (!compile(fileName, rulesFile)) {
+    return nullptr;
+  }
+  auto res = _files.emplace(fileName, std::move(rulesFile));
+
+  return &(res.first->second);
+}
+
+void RulesHelperClass::invalidate()
+{
+  _invalidated = true;
+}
+
+void RulesHelperClass::invalidate(const String& fileName)
+{
+  String lcFileName = fileName;
+
+  lcFileName.toLowerCase();
+
+  if (lcFileName.indexOf(F("rules")) != -1) {
+    invalidate();
+  }
+}
+
+String RulesHelperClass::getEventIndexKey(const String& event)
+{
+  const size_t length = event.length();
+  size_t end          = length;
+
+  // Skip the first character, which may be '!' for literal string events.
+  for (size_t i = 1; i < length && end == length; ++i) {
+    switch (event[i]) {
+      case '#':
+      case '=':
+      case '<':
+      case '>':
+      case '!':
+        end = i;
+        break;
+      default:
+        break;
+    }
+  }
+  String key = event.substring(0, end);
+
+  key.trim();
+  key.toLowerCase();
+  return key;
+}
+
+void RulesHelperClass::beginProcessing()
+{
+  ++_inUse;
+}
+
+void RulesHelperClass::endProcessing()
+{
+  if (_inUse > 0) {
+    --_inUse;
+  }
+}
+
+// Determine the type of the line and, when possible, the event trigger of an "on" line.
+// Must interpret the line the same way as parseCompleteNonCommentLine() does.
+static void classifyRulesLine(const String& line, RulesLine& rulesLine)
+{
+  String lcLine = line;
+
+  rules_strip_trailing_comments(lcLine);
+  lcLine.toLowerCase();
+
+  if (lcLine.startsWith(F("on "))) {
+    const int split = lcLine.indexOf(F(" do"), 3);
+    String    action;
+
+    if (split != -1) {
+      action = lcLine.substring(split + 4);
+      action.trim();
+    }
+
+    rulesLine.type = action.isEmpty() ? RulesLine::Type::OnBlock : RulesLine::Type::OnSingleLine;
+
+    // Lines with system variables, task values or string functions
+    // must be processed via parseTemplate() before matching.
+    const bool isStatic =
+      (lcLine.indexOf('%') == -1) &&
+      (lcLine.indexOf('[') == -1) &&
+      (lcLine.indexOf('{') == -1);
+
+    if ((split != -1) && isStatic) {
+      rulesLine.trigger = lcLine.substring(3, split);
+      rulesLine.trigger.trim();
+    }
+  } else if (lcLine.equals(F("endon"))) {
+    rulesLine.type = RulesLine::Type::EndOn;
+  } else {
+    rulesLine.type = RulesLine::Type::Statement;
+  }
+}
+
+bool RulesHelperClass::compile(const String& fileName, RulesFile& rulesFile)
+{
+  START_TIMER;
+  rulesFile.clear();
+
+  fs::File f = tryOpenFile(fileName, "r");
+
+  if (!f) {
+    return false;
+  }
+
+  const size_t fileSize = f.size();
+
+  // Only keep a compiled version when there is plenty of memory left.
+  if ((fileSize >= 0xFFFF) ||
+      ((2 * fileSize) > getMaxFreeBlock()) ||
+      !rulesFile.text.reserve(fileSize)) {
+    f.close();
+    return false;
+  }
+
+  String line;
+
+  line.reserve(RULES_BUFFER_SIZE);
+  bool firstNonSpaceRead = false;
+  bool commentFound      = false;
+
+  std::vector<uint8_t> buf;
+  buf.resize(RULES_BUFFER_SIZE);
+
+  while (f.available()) {
+    const int len = f.read(&buf[0], RULES_BUFFER_SIZE);
+
+    for (int x = 0; x < len; x++) {
+      if (rules_append_char(static_cast<char>(buf[x]), line, firstNonSpaceRead, commentFound)) {
+        if (rules_finalize_line(line)) {
+          RulesLine rulesLine;
+          rulesLine.offset = rulesFile.text.length();
+          rulesLine.length = line.length();
+          classifyRulesLine(line, rulesLine);
+
+          rulesFile.text += line;
+          rulesFile.lines.push_back(std::move(rulesLine));
+        }
+        line = EMPTY_STRING;
+      }
+    }
+  }
+  f.close();
+
+  // Resolve where to continue when a line or block does not match.
+  const uint16_t nrLines   = rulesFile.lines.size();
+  uint16_t       nextOn    = nrLines;
+  uint16_t       nextEndOn = nrLines;
+
+  for (uint16_t i = nrLines; i > 0; --i) {
+    RulesLine& rulesLine = rulesFile.lines[i - 1];
+
+    if (rulesLine.type == RulesLine::Type::OnBlock) {
+      rulesLine.next = (nextEndOn < nrLines) ? rulesFile.lines[nextEndOn].next : nrLines;
+    } else {
+      rulesLine.next = nextOn;
+    }
+
+    if (rulesLine.type == RulesLine::Type::EndOn) {
+      nextEndOn = i - 1;
+    }
+
+    if (rulesLine.isOn()) {
+      nextOn = i - 1;
+    }
+  }
+  rulesFile.buildEventIndex();
+
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    String log = F("Rules: Compiled ");
+    log += fileName;
+    log += F(" lines: ");
+    log += nrLines;
+    log += F(" size: ");
+    log += rulesFile.text.length();
+    addLog(LOG_LEVEL_INFO, log);
+  }
+  STOP_TIMER(RULES_COMPILE_FILE);
+  return true;
+}
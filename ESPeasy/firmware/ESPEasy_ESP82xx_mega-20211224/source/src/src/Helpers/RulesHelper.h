@@ -0,0 +1,123 @@
+#ifndef HELPERS_RULESHELPER_H
+#define HELPERS_RULESHELPER_H
+
+#include "../../ESPEasy_common.h"
+
+#include <map>
+#include <vector>
+
+
+// Maximum number of rules files kept in RAM in their compiled form.
+#ifndef RULES_CACHE_MAX_FILES
+# define RULES_CACHE_MAX_FILES  8
+#endif // ifndef RULES_CACHE_MAX_FILES
+
+
+/*********************************************************************************************\
+* RulesLine
+* Compiled form of a single (trimmed, non comment) line of a rules file.
+\*********************************************************************************************/
+struct RulesLine {
+  enum class Type : uint8_t {
+    OnBlock,      // "on ... do" starting a block of actions, terminated by "endon"
+    OnSingleLine, // "on ... do <action>"
+    EndOn,        // "endon"
+    Statement     // Anything else, like actions and if/elseif/else/endif
+  };
+
+  bool isOn() const {
+    return type == Type::OnBlock || type == Type::OnSingleLine;
+  }
+
+  // Return true when this is an "on" line with a static event trigger which does not match the event.
+  bool canSkip(const String& event) const;
+
+  // Lower case event trigger of an "on" line.
+  // Only set when the line does not need to be parsed via parseTemplate() before matching.
+  String trigger;
+
+  // Position of the line in RulesFile::text
+  uint16_t offset = 0;
+  uint16_t length = 0;
+
+  // Index of the line to continue with when looking for the next "on" line.
+  // For an "on ... do" block this is the line right after its "endon".
+  uint16_t next = 0;
+
+  Type type = Type::Statement;
+};
+
+
+/*********************************************************************************************\
+* RulesFile
+* All lines of a rules file, stored in a single buffer to keep heap fragmentation low.
+\*********************************************************************************************/
+struct RulesFile {
+  String getLine(size_t index) const;
+
+  void   clear();
+
+  // Get the indices of the "on" lines which may match the event, in file order.
+  // Return nullptr when all lines must be checked.
+  const std::vector<uint16_t>* getCandidates(const String& event) const;
+
+  // Map the event name prefix of the "on" lines to the line indices.
+  // Must be called after the lines and their jump targets are set.
+  void buildEventIndex();
+
+  String                 text;
+  std::vector<RulesLine> lines;
+
+private:
+
+  typedef std::map<String, std::vector<uint16_t> > EventIndexMap;
+
+  // "on" lines per event name prefix, including the lines which cannot be indexed.
+  EventIndexMap _eventIndex;
+
+  // "on" lines which must be checked for any event, like "on * do"
+  std::vector<uint16_t> _unindexed;
+
+  bool _indexed = false;
+};
+
+
+/*********************************************************************************************\
+* RulesHelperClass
+* Keeps the compiled form of rules files in RAM, so they do not need to be read from
+* the file system and preprocessed for every event.
+\*********************************************************************************************/
+class RulesHelperClass {
+public:
+
+  // Get the compiled form of the rules file.
+  // Will compile the file when not yet present.
+  // Return nullptr when the file could not be compiled, e.g. due to lack of memory.
+  const RulesFile* getFile(const String& fileName);
+
+  // Mark all compiled files as outdated.
+  // Files are actually removed when no rules are being processed.
+  void             invalidate();
+
+  // Called when a file is written, to invalidate when it is a rules file.
+  void             invalidate(const String& fileName);
+
+  // Rules processing may be nested, make sure compiled files are not removed while in use.
+  void             beginProcessing();
+  void             endProcessing();
+
+  // Part of the event name (or event trigger) before '#', '=' or compare operator, in lower case.
+  static String    getEventIndexKey(const String& event);
+
+private:
+
+  static bool compile(const String& fileName,
+                      RulesFile   & rulesFile);
+
+  std::map<String, RulesFile> _files;
+  uint8_t                     _inUse       = 0;
+  bool                        _invalidated = false;
+};
+
+
+#endif // HELPERS_RULESHELPER_H
@@ -39,7 +39,8 @@ bool RulesCalculate_t::is_number(char oc, char c)
     isxdigit(c)  ||                                // HEX digit also includes normal decimal numbers
     ((oc == '0') && ((c == 'x') || (c == 'b'))) || // HEX (0x) or BIN (0b) prefixes.
     (c == '.')   ||                                // A decimal point of a floating point number.
-    (is_operator(oc) && (c == '-'))                // Beginning of a negative number after an operator.
+    (is_operator(oc) && (c == '-')) ||             // Beginning of a negative number after an operator.
+    is_slot(c)                                     // Placeholder in an expression being compiled.
   ;
 }
 
@@ -48,6 +49,11 @@ bool RulesCalculate_t::is_operator(char c)
   return c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%';
 }
 
+bool RulesCalculate_t::is_slot(char c)
+{
+  return c >= CALCULATE_SLOT_CHAR && c < (CALCULATE_SLOT_CHAR + CALCULATE_NR_SLOTS);
+}
+
 bool RulesCalculate_t::is_unary_operator(char c)
 {
   const UnaryOperator op = static_cast<UnaryOperator>(c);
@@ -225,6 +231,10 @@ CalculateReturnCode RulesCalculate_t::RPNCalculate(char *token)
     return ret; // Don't bother for an empty string
   }
 
+  if (_program != nullptr) {
+    return addToProgram(token);
+  }
+
   if (is_operator(token[0]) && (token[1] == 0))
   {
     double second = pop();
@@ -253,6 +263,34 @@ CalculateReturnCode RulesCalculate_t::RPNCalculate(char *token)
   return ret;
 }
 
+CalculateReturnCode RulesCalculate_t::addToProgram(const char *token)
+{
+  CalculateProgram::Token programToken;
+
+  if (is_operator(token[0]) && (token[1] == 0)) {
+    programToken.type = CalculateProgram::TokenType::Operator;
+    programToken.op   = token[0];
+  } else if (is_unary_operator(token[0]) && (token[1] == 0)) {
+    programToken.type = CalculateProgram::TokenType::UnaryOperator;
+    programToken.op   = token[0];
+  } else if (is_slot(token[0]) && (token[1] == 0)) {
+    programToken.type = CalculateProgram::TokenType::Slot;
+    programToken.op   = token[0] - CALCULATE_SLOT_CHAR;
+
+    _program->usedSlots[static_cast<uint8_t>(programToken.op)] = true;
+  } else {
+    for (const char *c = token; *c != 0; ++c) {
+      if (is_slot(*c)) {
+        // Inserted value would be concatenated with other characters to form a single number.
+        return CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+      }
+    }
+    validDoubleFromString(token, programToken.value);
+  }
+  _program->tokens.push_back(programToken);
+  return CalculateReturnCode::OK;
+}
+
 // operators
 // precedence   operators         associativity
 // 4            !                 right to left
@@ -470,7 +508,7 @@ CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, double *res
   error       = RPNCalculate(token);
   TokenPos    = token;
 
-  if (isError(error))
+  if (isError(error) || (_program != nullptr))
   {
     *result = 0;
     return error;
@@ -482,6 +520,110 @@ CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, double *res
   return CalculateReturnCode::OK;
 }
 
+CalculateReturnCode RulesCalculate_t::compile(const String& input, CalculateProgram& program)
+{
+  program.clear();
+
+  if (input[0] == '=') {
+    // doCalculate() skips the first character in a way which cannot be compiled.
+    return CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+  }
+
+  for (unsigned int i = 0; i < input.length(); ++i) {
+    if (is_slot(input[i]) && ((i == 0) || !is_operator(input[i - 1]))) {
+      program.negativeAllowed[input[i] - CALCULATE_SLOT_CHAR] = false;
+    }
+  }
+
+  double dummy                   = 0.0;
+  CalculateProgram *prevProgram  = _program;
+  _program                       = &program;
+  CalculateReturnCode returnCode = doCalculate(input.c_str(), &dummy);
+  _program                       = prevProgram;
+
+  // Check stack usage, to make sure the result is the same as when calculated via doCalculate()
+  int depth = 0;
+
+  for (auto it = program.tokens.begin(); !isError(returnCode) && it != program.tokens.end(); ++it) {
+    switch (it->type) {
+      case CalculateProgram::TokenType::Number:
+      case CalculateProgram::TokenType::Slot:
+        ++depth;
+
+        if (depth > STACK_SIZE) {
+          returnCode = CalculateReturnCode::ERROR_STACK_OVERFLOW;
+        }
+        break;
+      case CalculateProgram::TokenType::Operator:
+        depth = (depth > 2 ? depth - 2 : 0) + 1;
+        break;
+      case CalculateProgram::TokenType::UnaryOperator:
+        depth = (depth > 1 ? depth - 1 : 0) + 1;
+        break;
+    }
+  }
+
+  if (!isError(returnCode) && (depth == 0)) {
+    // Nothing to calculate
+    returnCode = CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+  }
+
+  if (isError(returnCode)) {
+    program.clear();
+  }
+  return returnCode;
+}
+
+CalculateReturnCode RulesCalculate_t::evaluate(const CalculateProgram& program, const double *slotValues, double& result)
+{
+  CalculateReturnCode ret = CalculateReturnCode::OK;
+
+  sp = globalstack - 1;
+
+  for (auto it = program.tokens.begin(); !isError(ret) && it != program.tokens.end(); ++it) {
+    switch (it->type) {
+      case CalculateProgram::TokenType::Number:
+        ret = push(it->value);
+        break;
+      case CalculateProgram::TokenType::Slot:
+        ret = push(slotValues[static_cast<uint8_t>(it->op)]);
+        break;
+      case CalculateProgram::TokenType::Operator:
+      {
+        double second = pop();
+        double first  = pop();
+
+        ret = push(apply_operator(it->op, first, second));
+        break;
+      }
+      case CalculateProgram::TokenType::UnaryOperator:
+      {
+        double first = pop();
+
+        ret = push(apply_unary_operator(it->op, first));
+        break;
+      }
+    }
+  }
+
+  if (isError(ret) || (sp == (globalstack - 1))) {
+    result = 0;
+    return isError(ret) ? ret : CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+  }
+  result = *sp;
+  return ret;
+}
+
+void CalculateProgram::clear()
+{
+  tokens.clear();
+
+  for (uint8_t slot = 0; slot < CALCULATE_NR_SLOTS; ++slot) {
+    usedSlots[slot]       = false;
+    negativeAllowed[slot] = true;
+  }
+}
+
 void preProcessReplace(String& input, UnaryOperator op) {
   String find = toString(op);
 
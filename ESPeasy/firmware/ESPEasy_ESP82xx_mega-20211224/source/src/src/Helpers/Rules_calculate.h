@@ -4,6 +4,8 @@
 
 #include "../../ESPEasy_common.h"
 
+#include <vector>
+
 /********************************************************************************************\
    Calculate function for simple expressions
  \*********************************************************************************************/
@@ -49,6 +51,39 @@ enum class UnaryOperator  {
   ArcTan_d   // Arc Tangent (degree)
 };
 
+/********************************************************************************************\
+   Expression compiled to Reverse Polish Notation (RPN)
+   Slots are placeholders in the expression, which are given a value when evaluating.
+   A slot is marked in the expression by a single character: CALCULATE_SLOT_CHAR + slot nr.
+ \*********************************************************************************************/
+#define CALCULATE_NR_SLOTS   2
+#define CALCULATE_SLOT_CHAR  1
+
+struct CalculateProgram {
+  enum class TokenType : uint8_t {
+    Number,
+    Slot,
+    Operator,
+    UnaryOperator
+  };
+
+  struct Token {
+    double    value = 0.0;
+    TokenType type  = TokenType::Number;
+    char      op    = 0; // Operator or slot nr
+  };
+
+  void clear();
+
+  std::vector<Token> tokens;
+
+  bool usedSlots[CALCULATE_NR_SLOTS] = { false };
+
+  // A negative value in a slot is only parsed as a negative number when preceded by an operator.
+  // Otherwise the '-' is handled as operator when the value is inserted as text.
+  bool negativeAllowed[CALCULATE_NR_SLOTS] = { true, true };
+};
+
 void   preProcessReplace(String      & input,
                          UnaryOperator op);
 bool   angleDegree(UnaryOperator op);
@@ -86,6 +121,14 @@ private:
 
   CalculateReturnCode RPNCalculate(char *token);
 
+  // Add a token to _program, used when compiling an expression.
+  CalculateReturnCode addToProgram(const char *token);
+
+  static bool         is_slot(char c);
+
+  // When set, doCalculate() will store the tokens in RPN order instead of calculating.
+  CalculateProgram *_program = nullptr;
+
   // operators
   // precedence   operators         associativity
   // 3            !                 right to left
@@ -104,6 +147,17 @@ public:
   CalculateReturnCode doCalculate(const char *input,
                                   double     *result);
 
+  // Compile the expression, using the same parsing as doCalculate().
+  // Input must already be pre-processed.
+  CalculateReturnCode compile(const String    & input,
+                              CalculateProgram& program);
+
+  // Calculate the result of a compiled expression.
+  // slotValues must contain CALCULATE_NR_SLOTS values.
+  CalculateReturnCode evaluate(const CalculateProgram& program,
+                               const double          *slotValues,
+                               double               & result);
+
   // Try to replace multi byte operators with single character ones.
   // For example log, sin, cos, tan.
   static String preProces(const String& input);
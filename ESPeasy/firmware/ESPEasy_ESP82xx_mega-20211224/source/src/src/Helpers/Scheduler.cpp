@@ -1049,16 +1049,15 @@ void ESPEasy_Scheduler::schedule_plugin_task_event_timer(deviceIndex_t DeviceInd
   }
 }
 
-void ESPEasy_Scheduler::schedule_mqtt_plugin_import_event_timer(deviceIndex_t DeviceIndex,
-                                                                taskIndex_t   TaskIndex,
-                                                                uint8_t       Function,
-                                                                char         *c_topic,
-                                                                uint8_t      *b_payload,
-                                                                unsigned int  length) {
+void ESPEasy_Scheduler::schedule_mqtt_plugin_import_event_timer(deviceIndex_t        DeviceIndex,
+                                                                uint8_t              Function,
+                                                                char                *c_topic,
+                                                                uint8_t             *b_payload,
+                                                                unsigned int         length,
+                                                                struct EventStruct&& event) {
   if (validDeviceIndex(DeviceIndex)) {
     const unsigned long mixedId = createSystemEventMixedId(PluginPtrType::TaskPlugin, DeviceIndex, static_cast<uint8_t>(Function));
-    EventStruct  event(TaskIndex);
-    const size_t topic_length = strlen_P(c_topic);
+    const size_t topic_length   = strlen_P(c_topic);
 
     if (!(event.String1.reserve(topic_length) && event.String2.reserve(length))) {
       addLog(LOG_LEVEL_ERROR, F("MQTT : Out of Memory! Cannot process MQTT message"));
@@ -1157,6 +1156,14 @@ void ESPEasy_Scheduler::process_system_event_queue() {
     case PluginPtrType::TaskPlugin:
 
       if (validDeviceIndex(Index)) {
+        #ifdef USES_P037
+
+        if (Function == PLUGIN_MQTT_IMPORT) {
+          // A single event is shared by all MQTT import tasks matching the topic.
+          process_mqtt_plugin_import_event(Index, ScheduledEventQueue.front().event);
+          break;
+        }
+        #endif // ifdef USES_P037
         LoadTaskSettings(ScheduledEventQueue.front().event.TaskIndex);
         Plugin_ptr[Index](Function, &ScheduledEventQueue.front().event, tmpString);
       }
@@ -1171,6 +1178,24 @@ void ESPEasy_Scheduler::process_system_event_queue() {
   ScheduledEventQueue.pop_front();
 }
 
+#ifdef USES_P037
+void ESPEasy_Scheduler::process_mqtt_plugin_import_event(deviceIndex_t DeviceIndex, struct EventStruct& event) {
+  String tmpString;
+
+  for (taskIndex_t taskIndex = 0; taskIndex < TASKS_MAX; taskIndex++) {
+    event.setTaskIndex(taskIndex);
+
+    if (Settings.TaskDeviceEnabled[taskIndex] &&
+        (getDeviceIndex_from_TaskIndex(taskIndex) == DeviceIndex) &&
+        (getMQTTimportVarMask(&event) != 0)) {
+      LoadTaskSettings(taskIndex);
+      Plugin_ptr[DeviceIndex](PLUGIN_MQTT_IMPORT, &event, tmpString);
+    }
+  }
+}
+
+#endif // ifdef USES_P037
+
 String ESPEasy_Scheduler::getQueueStats() {
   return msecTimerHandler.getQueueStats();
 }
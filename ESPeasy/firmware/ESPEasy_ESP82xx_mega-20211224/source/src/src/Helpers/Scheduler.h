@@ -251,12 +251,15 @@ public:
                                         uint8_t              Function,
                                         struct EventStruct&& event);
 
-  void schedule_mqtt_plugin_import_event_timer(deviceIndex_t DeviceIndex,
-                                               taskIndex_t   TaskIndex,
-                                               uint8_t       Function,
-                                               char         *c_topic,
-                                               uint8_t      *b_payload,
-                                               unsigned int  length);
+  // Schedule a single event for all tasks matching the topic.
+  // The matching task values are marked in the event, see getMQTTimportVarMask()
+  // Note: event will be moved
+  void schedule_mqtt_plugin_import_event_timer(deviceIndex_t        DeviceIndex,
+                                               uint8_t              Function,
+                                               char                *c_topic,
+                                               uint8_t             *b_payload,
+                                               unsigned int         length,
+                                               struct EventStruct&& event);
 
 
   // Note: the event will be moved
@@ -288,6 +291,11 @@ public:
 
   void process_system_event_queue();
 
+  #ifdef USES_P037
+  void process_mqtt_plugin_import_event(deviceIndex_t       DeviceIndex,
+                                        struct EventStruct& event);
+  #endif // ifdef USES_P037
+
 
   /*********************************************************************************************\
   * Statistics
@@ -295,6 +303,10 @@ public:
 
   String getQueueStats();
 
+  size_t getSystemEventQueueSize() const {
+    return ScheduledEventQueue.size();
+  }
+
   void   updateIdleTimeStats();
 
   float  getIdleTimePct() const;
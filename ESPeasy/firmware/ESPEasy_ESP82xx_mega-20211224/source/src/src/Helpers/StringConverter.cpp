@@ -12,6 +12,7 @@
 #include "../Globals/ESPEasyWiFiEvent.h"
 #include "../Globals/ESPEasy_time.h"
 #include "../Globals/ExtraTaskSettings.h"
+#include "../Globals/FormattedUserVar.h"
 #include "../Globals/MQTT.h"
 #include "../Globals/Plugins.h"
 #include "../Globals/Settings.h"
@@ -297,6 +298,34 @@ void replaceUnicodeByChar(String& line, char replChar) {
    Format a value to the set number of decimals
 \*********************************************************************************************/
 String doFormatUserVar(struct EventStruct *event, uint8_t rel_index, bool mustCheck, bool& isvalid) {
+  if ((event != nullptr) && validTaskIndex(event->TaskIndex) && (event->TaskIndex == sendDataTaskIndex)) {
+    // Values are being sent to the controllers, so use the values formatted for all controllers.
+    const FormattedUserVar_ptr formatted = getFormattedUserVar(event);
+
+    if (formatted && (rel_index < formatted->valueCount) && formatted->isvalid[rel_index]) {
+      // Checked or not makes no difference for valid values.
+      isvalid = true;
+      return formatted->txt[rel_index];
+    }
+  }
+  return formatUserVarUncached(event, rel_index, mustCheck, isvalid);
+}
+
+FormattedUserVar_ptr getFormattedUserVar(struct EventStruct *event) {
+  if (event == nullptr) {
+    return FormattedUserVar_ptr();
+  }
+
+  if (validTaskIndex(event->TaskIndex) && (event->TaskIndex == sendDataTaskIndex)) {
+    if (!sendDataFormattedUserVar || !sendDataFormattedUserVar->matches(event)) {
+      sendDataFormattedUserVar = FormattedUserVar_ptr(new (std::nothrow) FormattedUserVarStruct(event));
+    }
+    return sendDataFormattedUserVar;
+  }
+  return FormattedUserVar_ptr(new (std::nothrow) FormattedUserVarStruct(event));
+}
+
+String formatUserVarUncached(struct EventStruct *event, uint8_t rel_index, bool mustCheck, bool& isvalid) {
   if (event == nullptr) return EMPTY_STRING;
   isvalid = true;
 
@@ -6,6 +6,8 @@
 #include "../Globals/Plugins.h"
 #include "../Globals/CPlugins.h"
 
+#include "../DataStructs/FormattedUserVarStruct.h"
+
 #include "../Helpers/Convert.h"
 
 class IPAddress;
@@ -105,6 +107,16 @@ String doFormatUserVar(struct EventStruct *event,
                        bool                mustCheck,
                        bool              & isvalid);
 
+// Same as doFormatUserVar, but never uses the values formatted for sendData()
+String formatUserVarUncached(struct EventStruct *event,
+                             uint8_t             rel_index,
+                             bool                mustCheck,
+                             bool              & isvalid);
+
+// Get all values of the task formatted.
+// While sendData() is calling the controllers, all controllers share the same instance.
+FormattedUserVar_ptr getFormattedUserVar(struct EventStruct *event);
+
 String formatUserVarNoCheck(taskIndex_t TaskIndex,
                             uint8_t        rel_index);
 
@@ -11,6 +11,7 @@
 #include "../Globals/Plugins_other.h"
 #include "../Globals/RuntimeData.h"
 
+#include "../Helpers/CompiledTemplate.h"
 #include "../Helpers/ESPEasy_math.h"
 #include "../Helpers/ESPEasy_Storage.h"
 #include "../Helpers/Misc.h"
@@ -21,6 +22,11 @@
 
 #include <Arduino.h>
 
+static void parseTemplate_finalize(String& newString,
+                                   uint8_t currentTaskIndex,
+                                   uint8_t minimal_lineSize,
+                                   bool    useURLencode);
+
 /********************************************************************************************\
    Parse string template
  \*********************************************************************************************/
@@ -50,6 +56,17 @@ String parseTemplate_padded(String& tmpString, uint8_t minimal_lineSize, bool us
   uint8_t   currentTaskIndex = ExtraTaskSettings.TaskIndex;
   String newString;
 
+  if (parseTemplate_CallBack_ptr == nullptr) {
+    const CompiledTemplate *compiled = Cache.templateCache.get(tmpString);
+
+    if ((compiled != nullptr) && compiled->render(newString, minimal_lineSize, useURLencode)) {
+      parseTemplate_finalize(newString, currentTaskIndex, minimal_lineSize, useURLencode);
+      STOP_TIMER(PARSE_TEMPLATE_COMPILED);
+      return newString;
+    }
+    newString = String();
+  }
+
   newString.reserve(minimal_lineSize); // Our best guess of the new size.
 
 
@@ -160,6 +177,16 @@ String parseTemplate_padded(String& tmpString, uint8_t minimal_lineSize, bool us
 
   // Copy the rest of the string (or all if no replacements were done)
   newString += tmpString.substring(lastStartpos);
+
+  parseTemplate_finalize(newString, currentTaskIndex, minimal_lineSize, useURLencode);
+
+  STOP_TIMER(PARSE_TEMPLATE_PADDED);
+  return newString;
+}
+
+// Steps done after all [...#...] references are replaced.
+static void parseTemplate_finalize(String& newString, uint8_t currentTaskIndex, uint8_t minimal_lineSize, bool useURLencode)
+{
   #ifndef BUILD_NO_RAM_TRACKER
   checkRAM(F("parseTemplate2"));
   #endif // ifndef BUILD_NO_RAM_TRACKER
@@ -180,11 +207,9 @@ String parseTemplate_padded(String& tmpString, uint8_t minimal_lineSize, bool us
     newString += ' ';
   }
 
-  STOP_TIMER(PARSE_TEMPLATE_PADDED);
   #ifndef BUILD_NO_RAM_TRACKER
   checkRAM(F("parseTemplate3"));
   #endif // ifndef BUILD_NO_RAM_TRACKER
-  return newString;
 }
 
 /********************************************************************************************\
@@ -199,6 +224,16 @@ void transformValue(
   String        value,
   String      & valueFormat,
   const String& tmpString)
+{
+  transformValue(newString, lineSize, value, valueFormat, tmpString.length());
+}
+
+void transformValue(
+  String      & newString,
+  uint8_t       lineSize,
+  String        value,
+  String      & valueFormat,
+  size_t        templateLength)
 {
   // FIXME TD-er: This function does append to newString and uses its length to perform right aling.
   // Is this the way it is intended to use?
@@ -492,7 +527,7 @@ void transformValue(
 
       if (rightJustify)
       {
-        int filler = lineSize - newString.length() - value.length() - tmpString.length();
+        int filler = lineSize - newString.length() - value.length() - templateLength;
 
         for (uint8_t f = 0; f < filler; f++) {
           newString += ' ';
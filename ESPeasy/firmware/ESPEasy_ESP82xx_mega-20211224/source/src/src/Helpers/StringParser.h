@@ -34,6 +34,14 @@ void transformValue(
   String      & valueFormat,
   const String& tmpString);
 
+// Same as above, only the length of the template is needed to right align values.
+void transformValue(
+  String      & newString,
+  uint8_t       lineSize,
+  String        value,
+  String      & valueFormat,
+  size_t        templateLength);
+
 
 
 // Find the first (enabled) task with given name
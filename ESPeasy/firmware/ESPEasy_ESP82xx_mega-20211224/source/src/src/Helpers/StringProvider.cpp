@@ -15,6 +15,7 @@
 #endif
 
 #include "../Globals/ESPEasy_Scheduler.h"
+#include "../Globals/EventQueue.h"
 #include "../Globals/ESPEasy_time.h"
 #include "../Globals/ESPEasyWiFiEvent.h"
 #include "../Globals/NetworkState.h"
@@ -85,6 +86,7 @@ const __FlashStringHelper * getLabel(LabelType::Enum label) {
     case LabelType::ENABLE_TIMING_STATISTICS:  return F("Collect Timing Statistics");
     case LabelType::TASKVALUESET_ALL_PLUGINS:  return F("Allow TaskValueSet on all plugins");
     case LabelType::ENABLE_CLEAR_HUNG_I2C_BUS: return F("Try clear I2C bus when stuck");
+    case LabelType::ENABLE_RULES_CACHING:      return F("Enable Rules Cache");
 
     case LabelType::BOOT_TYPE:              return F("Last Boot Cause");
     case LabelType::BOOT_COUNT:             return F("Boot Count");
@@ -145,6 +147,12 @@ const __FlashStringHelper * getLabel(LabelType::Enum label) {
     case LabelType::I2C_BUS_STATE:          return F("I2C Bus State");
     case LabelType::I2C_BUS_CLEARED_COUNT:  return F("I2C bus cleared count");
 
+    case LabelType::EVENT_QUEUE_SIZE:       return F("Event Queue Size");
+    case LabelType::EVENT_QUEUE_HIGH_WATER: return F("Event Queue Max Size");
+    case LabelType::EVENT_QUEUE_DROPPED:    return F("Event Queue Dropped");
+    case LabelType::EVENT_QUEUE_COALESCED:  return F("Event Queue Coalesced");
+    case LabelType::EVENT_QUEUE_MERGED:     return F("Event Queue Merged");
+
     case LabelType::SYSLOG_LOG_LEVEL:       return F("Syslog Log Level");
     case LabelType::SERIAL_LOG_LEVEL:       return F("Serial Log Level");
     case LabelType::WEB_LOG_LEVEL:          return F("Web Log Level");
@@ -266,6 +274,7 @@ String getValue(LabelType::Enum label) {
     case LabelType::ENABLE_TIMING_STATISTICS:  return jsonBool(Settings.EnableTimingStats());
     case LabelType::TASKVALUESET_ALL_PLUGINS:  return jsonBool(Settings.AllowTaskValueSetAllPlugins());
     case LabelType::ENABLE_CLEAR_HUNG_I2C_BUS: return jsonBool(Settings.EnableClearHangingI2Cbus());
+    case LabelType::ENABLE_RULES_CACHING:      return jsonBool(Settings.EnableRulesCaching());
 
     case LabelType::BOOT_TYPE:              return getLastBootCauseString();
     case LabelType::BOOT_COUNT:             break;
@@ -333,6 +342,18 @@ String getValue(LabelType::Enum label) {
     case LabelType::GIT_HEAD:               return get_git_head();
     case LabelType::I2C_BUS_STATE:          return toString(I2C_state);
     case LabelType::I2C_BUS_CLEARED_COUNT:  return String(I2C_bus_cleared_count);
+
+    case LabelType::EVENT_QUEUE_SIZE:
+    {
+      String res = String(eventQueue.size());
+      res += F(" / ");
+      res += eventQueue.capacity();
+      return res;
+    }
+    case LabelType::EVENT_QUEUE_HIGH_WATER: return String(eventQueue.highWaterMark());
+    case LabelType::EVENT_QUEUE_DROPPED:    return String(eventQueue.droppedCount());
+    case LabelType::EVENT_QUEUE_COALESCED:  return String(eventQueue.coalescedCount());
+    case LabelType::EVENT_QUEUE_MERGED:     return String(eventQueue.mergedCount());
     case LabelType::SYSLOG_LOG_LEVEL:       return getLogLevelDisplayString(Settings.SyslogLevel);
     case LabelType::SERIAL_LOG_LEVEL:       return getLogLevelDisplayString(getSerialLogLevel());
     case LabelType::WEB_LOG_LEVEL:          return getLogLevelDisplayString(getWebLogLevel());
@@ -58,6 +58,7 @@ struct LabelType {
     ENABLE_TIMING_STATISTICS,
     TASKVALUESET_ALL_PLUGINS,
     ENABLE_CLEAR_HUNG_I2C_BUS,
+    ENABLE_RULES_CACHING,
 
     BOOT_TYPE,               // Cold boot
     BOOT_COUNT,              // 0
@@ -117,6 +118,12 @@ struct LabelType {
     I2C_BUS_STATE,
     I2C_BUS_CLEARED_COUNT,
 
+    EVENT_QUEUE_SIZE,        // 2 / 32
+    EVENT_QUEUE_HIGH_WATER,
+    EVENT_QUEUE_DROPPED,
+    EVENT_QUEUE_COALESCED,
+    EVENT_QUEUE_MERGED,
+
     SYSLOG_LOG_LEVEL,
     SERIAL_LOG_LEVEL,
     WEB_LOG_LEVEL,
@@ -30,6 +30,7 @@ const __FlashStringHelper * toString(ControllerSettingsStruct::VarType parameter
     case ControllerSettingsStruct::CONTROLLER_FULL_QUEUE_ACTION:        return  F("Full Queue Action");      
     case ControllerSettingsStruct::CONTROLLER_ALLOW_EXPIRE:             return  F("Allow Expire");           
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:              return  F("De-duplicate");           
+    case ControllerSettingsStruct::CONTROLLER_MQTT_BURST_SIZE:          return  F("Max Burst Size");
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:    return  F("Use Local System Time");
     
     case ControllerSettingsStruct::CONTROLLER_CHECK_REPLY:              return  F("Check Reply");            
@@ -207,6 +208,10 @@ void addControllerParameterForm(const ControllerSettingsStruct& ControllerSettin
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:
       addFormCheckBox(displayName, internalName, ControllerSettings.deduplicate());
       break;
+    case ControllerSettingsStruct::CONTROLLER_MQTT_BURST_SIZE:
+      addFormNumericBox(displayName, internalName, ControllerSettings.mqtt_burstSize(), 1, CONTROLLER_MQTT_BURST_MAX);
+      addFormNote(F("Messages published at once when the queue is not empty"));
+      break;
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:
       addFormCheckBox(displayName, internalName, ControllerSettings.useLocalSystemTime());
       break;      
@@ -337,6 +342,9 @@ void saveControllerParameterForm(ControllerSettingsStruct        & ControllerSet
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:
       ControllerSettings.deduplicate(isFormItemChecked(internalName));
       break;
+    case ControllerSettingsStruct::CONTROLLER_MQTT_BURST_SIZE:
+      ControllerSettings.mqtt_burstSize(getFormItemInt(internalName, ControllerSettings.mqtt_burstSize()));
+      break;
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:
       ControllerSettings.useLocalSystemTime(isFormItemChecked(internalName));
       break;
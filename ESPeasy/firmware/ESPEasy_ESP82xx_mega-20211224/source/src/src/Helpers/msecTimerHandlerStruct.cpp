@@ -8,9 +8,18 @@
 #define MAX_SCHEDULER_WAIT_TIME 5 // Max delay used in the scheduler for passing idle time.
 
   msecTimerHandlerStruct::msecTimerHandlerStruct() : get_called(0), get_called_ret_id(0), max_queue_length(0),
-    last_exec_time_usec(0), total_idle_time_usec(0),  idle_time_pct(0.0f), is_idle(false), eco_mode(true)
+    last_exec_time_usec(0), total_idle_time_usec(0),  idle_time_pct(0.0f), is_idle(false), eco_mode(true),
+    _freeList(INVALID_NODE), _cursor(0), _nrTimers(0)
   {
     last_log_start_time = millis();
+
+    for (size_t i = 0; i < MSEC_TIMER_WHEEL_SIZE; ++i) {
+      _wheel[i] = INVALID_NODE;
+    }
+
+    for (size_t i = 0; i < MSEC_TIMER_ID_HASH_SIZE; ++i) {
+      _idHash[i] = INVALID_NODE;
+    }
   }
 
   void msecTimerHandlerStruct::setEcoMode(bool enabled) {
@@ -18,9 +27,7 @@
   }
 
   void msecTimerHandlerStruct::registerAt(unsigned long id, unsigned long timer) {
-    timer_id_couple item(id, timer);
-
-    insert(item);
+    insert(id, timer);
   }
 
   // Check if timeout has been reached and also return its set timer.
@@ -28,7 +35,7 @@
   unsigned long msecTimerHandlerStruct::getNextId(unsigned long& timer) {
     ++get_called;
 
-    if (_timer_ids.empty()) {
+    if (_nrTimers == 0) {
       recordIdle();
 
       if (eco_mode) {
@@ -36,45 +43,48 @@
       }
       return 0;
     }
-    timer_id_couple item = _timer_ids.front();
-    const long passed    = timePassedSince(item._timer);
-
-    if (passed < 0) {
-      // No timeOutReached
-      recordIdle();
-
-      if (eco_mode) {
-        long waitTime = (-1 * passed) - 1; // will be non negative
+    const unsigned long now = millis();
+
+    // Advance the cursor one slot at a time, to keep the order of expired timers
+    // even when the cursor is lagging more than a full revolution.
+    while (true) {
+      const node_index_t index = findExpired(getSlot(_cursor), _cursor);
+
+      if (index != INVALID_NODE) {
+        recordRunning();
+
+        if (_nrTimers > max_queue_length) { max_queue_length = _nrTimers; }
+        const unsigned long id = _nodes[index]._id;
+        timer = _nodes[index]._timer;
+        remove(id);
+        ++get_called_ret_id;
+        return id;
+      }
 
-        if (waitTime > MAX_SCHEDULER_WAIT_TIME) {
-          waitTime = MAX_SCHEDULER_WAIT_TIME;
-        } else if (waitTime < 0) {  //-V547
-          // Should not happen, but just to be sure we will not wait forever.
-          waitTime = 0;
-        }
-        delay(waitTime);
+      if (_cursor == now) {
+        break;
       }
-      return 0;
+      ++_cursor;
     }
-    recordRunning();
-    unsigned long size = _timer_ids.size();
 
-    if (size > max_queue_length) { max_queue_length = size; }
-    _timer_ids.pop_front();
-    timer = item._timer;
-    ++get_called_ret_id;
-    return item._id;
+    // No timeOutReached
+    recordIdle();
+
+    if (eco_mode) {
+      delay(getWaitTime(now, MAX_SCHEDULER_WAIT_TIME));
+    }
+    return 0;
   }
 
 
   bool msecTimerHandlerStruct::getTimerForId(unsigned long id, unsigned long& timer) const {
-    for (auto it = _timer_ids.begin(); it != _timer_ids.end(); ++it) {
-      if (it->_id == id) {
-        timer = it->_timer;
-        return true;
-      }
+    const node_index_t index = findById(id);
+
+    if (index == INVALID_NODE) {
+      return false;
     }
-    return false;
+    timer = _nodes[index]._timer;
+    return true;
   }
 
   String msecTimerHandlerStruct::getQueueStats() {
@@ -106,31 +116,167 @@
     return idle_time_pct;
   }
 
-  struct match_id {
-    match_id(unsigned long id) : _id(id) {}
+  void msecTimerHandlerStruct::insert(unsigned long id, unsigned long timer) {
+    if (id == 0) { return; }
 
-    bool operator()(const timer_id_couple& item) {
-      return _id == item._id;
+    // Make sure only one is present with the same id.
+    remove(id);
+
+    if (_nrTimers == 0) {
+      _cursor = millis();
     }
 
-    unsigned long _id;
-  };
+    const node_index_t index = allocNode();
 
-  void msecTimerHandlerStruct::insert(const timer_id_couple& item) {
-    if (item._id == 0) { return; }
+    if (index == INVALID_NODE) { return; }
 
-    // Make sure only one is present with the same id.
-    _timer_ids.remove_if(match_id(item._id));
-    const bool mustSort = !_timer_ids.empty();
-    _timer_ids.push_front(item);
+    TimerNode& node = _nodes[index];
+    node._id    = id;
+    node._timer = timer;
+
+    const size_t bucket = getBucket(id);
+    node._nextById  = _idHash[bucket];
+    _idHash[bucket] = index;
+
+    linkInSlot(index);
+    ++_nrTimers;
+  }
+
+  bool msecTimerHandlerStruct::remove(unsigned long id) {
+    const size_t bucket = getBucket(id);
+    node_index_t prev   = INVALID_NODE;
+    node_index_t index  = _idHash[bucket];
+
+    while (index != INVALID_NODE) {
+      TimerNode& node = _nodes[index];
+
+      if (node._id == id) {
+        if (prev == INVALID_NODE) {
+          _idHash[bucket] = node._nextById;
+        } else {
+          _nodes[prev]._nextById = node._nextById;
+        }
+        unlinkFromSlot(index);
+        freeNode(index);
+        --_nrTimers;
+        return true;
+      }
+      prev  = index;
+      index = node._nextById;
+    }
+    return false;
+  }
+
+  msecTimerHandlerStruct::node_index_t msecTimerHandlerStruct::findById(unsigned long id) const {
+    node_index_t index = _idHash[getBucket(id)];
 
-    if (mustSort) {
-      _timer_ids.sort(); // TD-er: Must check if this is an expensive operation.
+    while (index != INVALID_NODE) {
+      if (_nodes[index]._id == id) {
+        return index;
+      }
+      index = _nodes[index]._nextById;
     }
+    return INVALID_NODE;
+  }
 
-    // It should be a relative light operation, to insert into a sorted list.
-    // Perhaps it is better to use std::set ????
-    // Keep in mind: order is based on timer, uniqueness is based on id.
+  msecTimerHandlerStruct::node_index_t msecTimerHandlerStruct::allocNode() {
+    if (_freeList == INVALID_NODE) {
+      // Grow the pool in chunks, existing nodes are referred to by index so they may be moved.
+      const size_t oldSize = _nodes.size();
+      size_t newSize       = oldSize + MSEC_TIMER_POOL_CHUNK_SIZE;
+
+      if (newSize > INVALID_NODE) {
+        newSize = INVALID_NODE;
+      }
+
+      if (newSize <= oldSize) {
+        return INVALID_NODE;
+      }
+      _nodes.resize(newSize);
+
+      for (size_t i = newSize; i > oldSize; --i) {
+        freeNode(i - 1);
+      }
+    }
+    const node_index_t index = _freeList;
+
+    _freeList = _nodes[index]._next;
+    return index;
+  }
+
+  void msecTimerHandlerStruct::freeNode(node_index_t index) {
+    TimerNode& node = _nodes[index];
+
+    node._id       = 0;
+    node._prev     = INVALID_NODE;
+    node._nextById = INVALID_NODE;
+    node._next     = _freeList;
+    _freeList      = index;
+  }
+
+  void msecTimerHandlerStruct::linkInSlot(node_index_t index) {
+    TimerNode& node = _nodes[index];
+
+    // Timers which should already have been run are placed at the cursor,
+    // since slots before the cursor will not be checked until the next revolution.
+    const unsigned long slotTime = (timeDiff(_cursor, node._timer) < 0) ? _cursor : node._timer;
+    const size_t slot            = getSlot(slotTime);
+
+    node._slot = slot;
+    node._prev = INVALID_NODE;
+    node._next = _wheel[slot];
+
+    if (node._next != INVALID_NODE) {
+      _nodes[node._next]._prev = index;
+    }
+    _wheel[slot] = index;
+  }
+
+  void msecTimerHandlerStruct::unlinkFromSlot(node_index_t index) {
+    TimerNode& node = _nodes[index];
+
+    if (node._prev != INVALID_NODE) {
+      _nodes[node._prev]._next = node._next;
+    } else {
+      _wheel[node._slot] = node._next;
+    }
+
+    if (node._next != INVALID_NODE) {
+      _nodes[node._next]._prev = node._prev;
+    }
+    node._prev = INVALID_NODE;
+    node._next = INVALID_NODE;
+  }
+
+  msecTimerHandlerStruct::node_index_t msecTimerHandlerStruct::findExpired(size_t slot, unsigned long cursor) const {
+    node_index_t found     = INVALID_NODE;
+    long         maxPassed = -1;
+    node_index_t index     = _wheel[slot];
+
+    while (index != INVALID_NODE) {
+      const long passed = timeDiff(_nodes[index]._timer, cursor);
+
+      if (passed > maxPassed) {
+        maxPassed = passed;
+        found     = index;
+      }
+      index = _nodes[index]._next;
+    }
+    return found;
+  }
+
+  long msecTimerHandlerStruct::getWaitTime(unsigned long now, long maxWait) const {
+    for (long wait = 1; wait <= maxWait; ++wait) {
+      node_index_t index = _wheel[getSlot(now + wait)];
+
+      while (index != INVALID_NODE) {
+        if (timeDiff(now, _nodes[index]._timer) <= wait) {
+          return wait - 1;
+        }
+        index = _nodes[index]._next;
+      }
+    }
+    return maxWait;
   }
 
   void msecTimerHandlerStruct::recordIdle() {
@@ -3,11 +3,33 @@
 
 
 #include <Arduino.h>
-#include <list>
+#include <vector>
 
-#include "../DataStructs/timer_id_couple.h"
 
+// Number of slots in the timing wheel, must be a power of 2.
+// Each slot covers 1 msec, timers further away stay in their slot for more revolutions.
+#ifndef MSEC_TIMER_WHEEL_SIZE
+# define MSEC_TIMER_WHEEL_SIZE      256
+#endif // ifndef MSEC_TIMER_WHEEL_SIZE
 
+// Number of buckets to look up a timer by its ID, must be a power of 2.
+#ifndef MSEC_TIMER_ID_HASH_SIZE
+# define MSEC_TIMER_ID_HASH_SIZE    64
+#endif // ifndef MSEC_TIMER_ID_HASH_SIZE
+
+// Number of timers allocated at once when the pool of timers is exhausted.
+#ifndef MSEC_TIMER_POOL_CHUNK_SIZE
+# define MSEC_TIMER_POOL_CHUNK_SIZE 32
+#endif // ifndef MSEC_TIMER_POOL_CHUNK_SIZE
+
+
+/*********************************************************************************************\
+* msecTimerHandlerStruct
+* Hashed timing wheel to keep track of scheduled IDs.
+* Set timers are taken from a pool and linked in the slot of the wheel matching their timer
+* and in a bucket matching their ID, so insert, lookup and removal do not depend on the
+* number of set timers and do not allocate memory per timer.
+\*********************************************************************************************/
 struct msecTimerHandlerStruct {
   msecTimerHandlerStruct();
 
@@ -33,7 +55,51 @@ struct msecTimerHandlerStruct {
 
 private:
 
-  void insert(const timer_id_couple& item);
+  typedef uint16_t node_index_t;
+
+  static const node_index_t INVALID_NODE = 0xFFFF;
+
+  struct TimerNode {
+    unsigned long _id       = 0;
+    unsigned long _timer    = 0;
+    node_index_t  _prev     = INVALID_NODE; // Previous node in the same wheel slot
+    node_index_t  _next     = INVALID_NODE; // Next node in the same wheel slot, or next free node
+    node_index_t  _nextById = INVALID_NODE; // Next node in the same ID bucket
+    uint16_t      _slot     = 0;
+  };
+
+  void         insert(unsigned long id,
+                      unsigned long timer);
+
+  // Remove the timer with given ID, return true when it was present.
+  bool         remove(unsigned long id);
+
+  node_index_t findById(unsigned long id) const;
+
+  node_index_t allocNode();
+
+  void         freeNode(node_index_t index);
+
+  void         linkInSlot(node_index_t index);
+
+  void         unlinkFromSlot(node_index_t index);
+
+  // Find the timer in the slot which expired the longest time before the cursor.
+  // Timers of a later revolution of the wheel are ignored.
+  node_index_t findExpired(size_t        slot,
+                           unsigned long cursor) const;
+
+  // Number of msec until the first timer will expire, limited to maxWait.
+  long         getWaitTime(unsigned long now,
+                           long          maxWait) const;
+
+  static size_t getSlot(unsigned long timer) {
+    return timer & (MSEC_TIMER_WHEEL_SIZE - 1);
+  }
+
+  static size_t getBucket(unsigned long id) {
+    return (id ^ (id >> 16)) & (MSEC_TIMER_ID_HASH_SIZE - 1);
+  }
 
   void recordIdle();
 
@@ -52,8 +118,13 @@ private:
   bool          is_idle;
   bool          eco_mode;
 
-  // The list of set timers
-  std::list<timer_id_couple>_timer_ids;
+  // The set timers
+  std::vector<TimerNode> _nodes;
+  node_index_t           _wheel[MSEC_TIMER_WHEEL_SIZE];
+  node_index_t           _idHash[MSEC_TIMER_ID_HASH_SIZE];
+  node_index_t           _freeList;
+  unsigned long          _cursor; // All slots before this moment have been processed
+  unsigned long          _nrTimers;
 };
 
 #endif // HELPERS_MSECTIMERHANDLERSTRUCT_H
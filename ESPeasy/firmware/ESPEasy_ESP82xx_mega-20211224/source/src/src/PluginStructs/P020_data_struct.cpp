@@ -5,17 +5,69 @@
 # include "../ESPEasyCore/Serial.h"
 # include "../ESPEasyCore/ESPEasyNetwork.h"
 
+# include "../Globals/ESPEasy_Scheduler.h"
 # include "../Globals/EventQueue.h"
 
 # include "../Helpers/ESPEasy_Storage.h"
 # include "../Helpers/Misc.h"
 
+# include <algorithm>
+
+# if defined(ESP32)
+#  include <lwip/sockets.h>
+# endif // if defined(ESP32)
+
 # define P020_RX_WAIT              PCONFIG(4)
 # define P020_RX_BUFFER            PCONFIG(7)
 
 
+void P020_RingBuffer::allocate(size_t capacity) {
+  _buffer.resize(capacity);
+  clear();
+}
+
+void P020_RingBuffer::clear() {
+  _head = 0;
+  _size = 0;
+}
+
+uint8_t * P020_RingBuffer::writeSpan(size_t& length) {
+  if (space() == 0) {
+    length = 0;
+    return nullptr;
+  }
+  const size_t tail = (_head + _size) % _buffer.size();
+
+  // Free space is either up to the end of the buffer, or up to the head.
+  length = (tail >= _head) ? _buffer.size() - tail : _head - tail;
+  return &_buffer[tail];
+}
+
+void P020_RingBuffer::commit(size_t length) {
+  _size += std::min(length, space());
+}
+
+const uint8_t * P020_RingBuffer::readSpan(size_t& length, size_t offset) const {
+  if (offset >= _size) {
+    length = 0;
+    return nullptr;
+  }
+  const size_t start = (_head + offset) % _buffer.size();
+
+  length = std::min(_size - offset, _buffer.size() - start);
+  return &_buffer[start];
+}
+
+void P020_RingBuffer::consume(size_t length) {
+  length = std::min(length, _size);
+  _size -= length;
+  _head  = (_size == 0) ? 0 : (_head + length) % _buffer.size();
+}
+
+
 P020_Task::P020_Task(taskIndex_t taskIndex) : _taskIndex(taskIndex) {
-  clearBuffer();
+  serial_buffer.allocate(P020_DATAGRAM_MAX_SIZE);
+  net_buffer.allocate(P020_DATAGRAM_MAX_SIZE);
 }
 
 P020_Task::~P020_Task() {
@@ -80,6 +132,10 @@ bool P020_Task::hasClientConnected() {
     if (ser2netClient) { ser2netClient.stop(); }
     ser2netClient = ser2netServer->available();
     ser2netClient.setTimeout(CONTROLLER_CLIENTTIMEOUT_DFLT);
+
+    // Data is already collected in sendSerialBuffer(), so do not wait for more in the TCP stack.
+    ser2netClient.setNoDelay(true);
+    clearBuffer();
     sendConnectedEvent(true);
     addLog(LOG_LEVEL_INFO, F("Ser2Net   : Client connected!"));
   }
@@ -93,6 +149,7 @@ bool P020_Task::hasClientConnected() {
     if (clientConnected) // there was a client connected before...
     {
       clientConnected = false;
+      clearBuffer();
       sendConnectedEvent(false);
       addLog(LOG_LEVEL_INFO, F("Ser2net   : Client disconnected!"));
     }
@@ -109,8 +166,18 @@ void P020_Task::discardClientIn() {
 }
 
 void P020_Task::clearBuffer() {
-  serial_buffer = "";
-  serial_buffer.reserve(P020_DATAGRAM_MAX_SIZE);
+  serial_buffer.clear();
+  net_buffer.clear();
+}
+
+void P020_Task::setRxBufferSize(size_t size) {
+  if (size < P020_DATAGRAM_MAX_SIZE) {
+    size = P020_DATAGRAM_MAX_SIZE;
+  }
+
+  if (size != serial_buffer.capacity()) {
+    serial_buffer.allocate(size);
+  }
 }
 
 void P020_Task::serialBegin(const ESPEasySerialPort port, int16_t rxPin, int16_t txPin, unsigned long baud, uint8_t config) {
@@ -120,6 +187,9 @@ void P020_Task::serialBegin(const ESPEasySerialPort port, int16_t rxPin, int16_t
     ser2netSerial = new (std::nothrow) ESPeasySerial(port, rxPin, txPin);
 
     if (nullptr != ser2netSerial) {
+      serial_baudrate     = baud;
+      serial_tx_pending   = 0;
+      serial_tx_timestamp = micros();
         # if defined(ESP8266)
       ser2netSerial->begin(baud, (SerialConfig)config);
         # elif defined(ESP32)
@@ -134,55 +204,154 @@ void P020_Task::serialEnd() {
   if (nullptr != ser2netSerial) {
     delete ser2netSerial;
     clearBuffer();
+    serial_rules_line = "";
+    serial_rules_overflow = false;
     ser2netSerial = nullptr;
     addLog(LOG_LEVEL_DEBUG, F("Ser2net   : Serial closed"));
   }
 }
 
 void P020_Task::handleClientIn(struct EventStruct *event) {
-  int count      = ser2netClient.available();
-  int bytes_read = 0;
-  uint8_t net_buf[P020_DATAGRAM_MAX_SIZE];
-
-  if (count > 0) {
-    if (count > P020_DATAGRAM_MAX_SIZE) { count = P020_DATAGRAM_MAX_SIZE; }
-    bytes_read = ser2netClient.read(net_buf, count);
-    ser2netSerial->write(net_buf, bytes_read);
-    ser2netSerial->flush();             // Waits for the transmission of outgoing serial data to
-
-    while (ser2netClient.available()) { // flush overflow data if available
-      ser2netClient.read();
+  // Only read what fits in the buffer.
+  // The rest is left in the TCP receive window, which slows down the client instead of losing data.
+  int available = ser2netClient.available();
+
+  while (available > 0) {
+    size_t   length = 0;
+    uint8_t *span   = net_buffer.writeSpan(length);
+
+    if (length == 0) { break; }
+
+    if (length > static_cast<size_t>(available)) { length = available; }
+    const int bytes_read = ser2netClient.read(span, length);
+
+    if (bytes_read <= 0) { break; }
+    net_buffer.commit(bytes_read);
+    available -= bytes_read;
+  }
+  writeNetBuffer();
+}
+
+void P020_Task::writeNetBuffer() {
+  if ((nullptr == ser2netSerial) || net_buffer.empty()) { return; }
+
+  // Only write what fits in the UART TX buffer, as a write to a full buffer blocks until there is room.
+  // The rest is written when part of it is sent.
+  // When the serial port can not tell, estimate how much of the FIFO is sent since the last write, 10 bits per byte.
+  const unsigned long now     = micros();
+  const unsigned long elapsed = now - serial_tx_timestamp;
+  const unsigned long sent    = (serial_baudrate == 0) ? serial_tx_pending
+                                : static_cast<unsigned long>((static_cast<uint64_t>(elapsed) * serial_baudrate) / 10000000ull);
+
+  serial_tx_timestamp = now;
+  serial_tx_pending   = (sent >= serial_tx_pending) ? 0 : serial_tx_pending - sent;
+
+  const int canWrite = ser2netSerial->availableForWrite();
+  size_t    budget   = (canWrite >= 0) ? canWrite : P020_SERIAL_TX_FIFO_SIZE - serial_tx_pending;
+
+  while (budget > 0 && !net_buffer.empty()) {
+    size_t length = 0;
+    const uint8_t *span = net_buffer.readSpan(length);
+
+    if (length > budget) { length = budget; }
+    const size_t written = ser2netSerial->write(span, length);
+
+    if (written == 0) { break; }
+    net_buffer.consume(written);
+    serial_tx_pending += written;
+    budget            -= written;
+  }
+
+  if (!net_buffer.empty()) {
+    // Do not wait for the next PLUGIN_FIFTY_PER_SECOND, but continue when half the FIFO is sent.
+    unsigned long delay_msec = 1;
+
+    if (serial_baudrate != 0) {
+      delay_msec = std::max(1ul, ((P020_SERIAL_TX_FIFO_SIZE / 2) * 10000ul) / serial_baudrate);
     }
+    Scheduler.setPluginTaskTimer(delay_msec, _taskIndex, _taskIndex);
   }
 }
 
+size_t P020_Task::clientWrite(const uint8_t *data, size_t length) {
+  # if defined(ESP8266)
+  const size_t canWrite = ser2netClient.availableForWrite();
+
+  if (length > canWrite) { length = canWrite; }
+
+  if (length == 0) { return 0; }
+  return ser2netClient.write(data, length);
+  # elif defined(ESP32)
+
+  // WiFiClient::write() waits when the socket send buffer is full, write to the socket without waiting.
+  const int sent = send(ser2netClient.fd(), data, length, MSG_DONTWAIT);
+
+  return (sent > 0) ? sent : 0;
+  # endif // if defined(ESP8266)
+}
+
 void P020_Task::handleSerialIn(struct EventStruct *event) {
   if (nullptr == ser2netSerial) { return; }
-  int RXWait  = P020_RX_WAIT;
-  int timeOut = RXWait;
-
-  do {
-    if (ser2netSerial->available()) {
-      if (serial_buffer.length() > static_cast<size_t>(P020_RX_BUFFER)) {
-        addLog(LOG_LEVEL_DEBUG, F("Ser2Net   : Error: Buffer overflow, discarded input."));
-        ser2netSerial->read();
+
+  // Read in bulk, as much as fits in the buffer.
+  // When the buffer is full, data is left in the serial receive buffer until the client accepts more.
+  int available = ser2netSerial->available();
+
+  while (available > 0) {
+    size_t   length = 0;
+    uint8_t *span   = serial_buffer.writeSpan(length);
+
+    if (length == 0) {
+      if (!serial_overflow_logged) {
+        serial_overflow_logged = true;
+        addLog(LOG_LEVEL_DEBUG, F("Ser2Net   : RX buffer full, client is too slow"));
       }
-      else { serial_buffer += (char)ser2netSerial->read(); }
-      timeOut = RXWait; // if serial received, reset timeout counter
-    } else {
-      if (timeOut <= 0) { break; }
-      delay(1);
-      --timeOut;
+      break;
     }
-  } while (true);
 
-  if (serial_buffer.length() > 0) {
-    ser2netClient.print(serial_buffer);
-    rulesEngine(serial_buffer);
-    ser2netClient.flush();
-    clearBuffer();
-    addLog(LOG_LEVEL_DEBUG, F("Ser2Net   : data send!"));
-  } // done
+    if (length > static_cast<size_t>(available)) { length = available; }
+    const size_t bytes_read = ser2netSerial->readBytes(span, length);
+
+    if (bytes_read == 0) { break; }
+
+    if (serial_buffer.empty()) {
+      serial_first_received = millis();
+    }
+    processRulesInput(span, bytes_read);
+    serial_buffer.commit(bytes_read);
+    serial_last_received = millis();
+    available           -= bytes_read;
+  }
+  sendSerialBuffer(P020_RX_WAIT);
+}
+
+void P020_Task::sendSerialBuffer(int rxWait) {
+  if (serial_buffer.empty()) { return; }
+
+  const bool halfFull    = serial_buffer.size() >= (serial_buffer.capacity() / 2);
+  const bool idle        = timePassedSince(serial_last_received) >= rxWait;
+  const bool heldTooLong = timePassedSince(serial_first_received) >= P020_MAX_SEND_DELAY;
+
+  if (!halfFull && !idle && !heldTooLong) {
+    // Collect more data, to send fewer and larger packets.
+    return;
+  }
+
+  while (!serial_buffer.empty()) {
+    size_t length = 0;
+    const uint8_t *span = serial_buffer.readSpan(length);
+    const size_t   sent = clientWrite(span, length);
+
+    if (sent == 0) { break; }
+    serial_buffer.consume(sent);
+  }
+
+  if (serial_buffer.empty()) {
+    serial_overflow_logged = false;
+  } else {
+    // Remaining data is sent next time, count its age from now.
+    serial_first_received = millis();
+  }
 }
 
 void P020_Task::discardSerialIn() {
@@ -191,14 +360,43 @@ void P020_Task::discardSerialIn() {
       ser2netSerial->read();
     }
   }
+  serial_buffer.clear();
+  serial_rules_line = "";
+  serial_rules_overflow = false;
 }
 
-// We can also use the rules engine for local control!
-void P020_Task::rulesEngine(String message) {
-  if (!(Settings.UseRules)) { return; }
-  int NewLinePos = message.indexOf(F("\r\n"));
+void P020_Task::processRulesInput(const uint8_t *data, size_t length) {
+  // Only create a String when needed for the rules.
+  if ((serial_processing == 0) || !Settings.UseRules) { return; }
 
-  if (NewLinePos > 0) { message = message.substring(0, NewLinePos); }
+  for (size_t i = 0; i < length; ++i) {
+    const char c = static_cast<char>(data[i]);
+
+    if ((c == '\n') && serial_rules_line.endsWith(F("\r"))) {
+      if (serial_rules_overflow) {
+        serial_rules_overflow = false;
+      } else {
+        serial_rules_line.remove(serial_rules_line.length() - 1);
+        rulesEngine(serial_rules_line);
+      }
+      serial_rules_line = "";
+    } else if (serial_rules_line.length() < serial_buffer.capacity()) {
+      serial_rules_line += c;
+    } else {
+      // Keep the last character, to detect the "\r\n" ending the line.
+      if (!serial_rules_overflow) {
+        serial_rules_overflow = true;
+        addLog(LOG_LEVEL_DEBUG, F("Ser2Net   : Line too long for the rules, ignored"));
+      }
+      serial_rules_line.setCharAt(serial_rules_line.length() - 1, c);
+    }
+  }
+}
+
+// We can also use the rules engine for local control!
+void P020_Task::rulesEngine(const String& line) {
+  if (!(Settings.UseRules) || (line.length() == 0)) { return; }
+  String message = line;
   String eventString;
 
   switch (serial_processing) {
@@ -7,12 +7,71 @@
 
 # include <ESPeasySerial.h>
 
+# include <vector>
+
 # ifndef PLUGIN_020_DEBUG
   #  define PLUGIN_020_DEBUG                 false  // extra logging in serial out
 # endif // ifndef PLUGIN_020_DEBUG
 
 # define P020_STATUS_LED                    12
 # define P020_DATAGRAM_MAX_SIZE             256
+
+// Max. time (msec) received serial data is held to collect more data before sending it to the client,
+// even when the serial port does not become idle.
+# ifndef P020_MAX_SEND_DELAY
+#  define P020_MAX_SEND_DELAY                50
+# endif // ifndef P020_MAX_SEND_DELAY
+
+// Size of the UART TX FIFO, max. bytes written to the serial port in one go without blocking.
+// Only used when the serial port can not tell how much can be written (e.g. software serial).
+# ifndef P020_SERIAL_TX_FIFO_SIZE
+#  define P020_SERIAL_TX_FIFO_SIZE           128
+# endif // ifndef P020_SERIAL_TX_FIFO_SIZE
+
+
+// Fixed size byte ring buffer.
+// Data is written and read in contiguous spans, so it can be passed directly to the serial port and the client.
+struct P020_RingBuffer {
+  void    allocate(size_t capacity);
+
+  void    clear();
+
+  size_t  capacity() const {
+    return _buffer.size();
+  }
+
+  size_t  size() const {
+    return _size;
+  }
+
+  size_t  space() const {
+    return _buffer.size() - _size;
+  }
+
+  bool    empty() const {
+    return _size == 0;
+  }
+
+  // Return the first contiguous free span, call commit() with the number of bytes written to it.
+  uint8_t* writeSpan(size_t& length);
+
+  void     commit(size_t length);
+
+  // Return the first contiguous span of data, call consume() with the number of bytes used.
+  // Use offset to skip data at the start.
+  const uint8_t* readSpan(size_t& length,
+                          size_t  offset = 0) const;
+
+  void           consume(size_t length);
+
+private:
+
+  std::vector<uint8_t>_buffer;
+  size_t              _head = 0; // Index of the first byte of data
+  size_t              _size = 0;
+};
+
+
 struct P020_Task : public PluginTaskData_base {
   P020_Task(taskIndex_t taskIndex);
   ~P020_Task();
@@ -32,6 +91,8 @@ struct P020_Task : public PluginTaskData_base {
 
   void               clearBuffer();
 
+  void               setRxBufferSize(size_t size);
+
   void               serialBegin(const ESPEasySerialPort port,
                                  int16_t                 rxPin,
                                  int16_t                 txPin,
@@ -42,7 +103,25 @@ struct P020_Task : public PluginTaskData_base {
 
   void handleSerialIn(struct EventStruct *event);
   void handleClientIn(struct EventStruct *event);
-  void rulesEngine(String message);
+
+  // Collect received serial data in serial_rules_line and call rulesEngine() for each complete line.
+  // Lines end with "\r\n", regardless of how the data is sent to the client.
+  void processRulesInput(const uint8_t *data,
+                         size_t         length);
+
+  void rulesEngine(const String& line);
+
+  // Send the received serial data to the client, when the serial port is idle for rxWait msec,
+  // the buffer is half full or the data is held for P020_MAX_SEND_DELAY msec.
+  void sendSerialBuffer(int rxWait);
+
+  // Write the data received from the client to the serial port, without blocking on a full UART.
+  // When not all data fits, a PLUGIN_TIMER_IN is scheduled to write the rest.
+  void writeNetBuffer();
+
+  // Write to the client without blocking, return the number of bytes written.
+  size_t clientWrite(const uint8_t *data,
+                     size_t         length);
 
   void discardSerialIn();
 
@@ -50,16 +129,24 @@ struct P020_Task : public PluginTaskData_base {
 
   void sendConnectedEvent(bool connected);
 
-  WiFiServer    *ser2netServer = nullptr;
-  uint16_t       gatewayPort   = 0;
-  WiFiClient     ser2netClient;
-  bool           clientConnected = false;
-  String         serial_buffer;
-  String         net_buffer;
-  int            checkI            = 0;
-  ESPeasySerial *ser2netSerial     = nullptr;
-  uint8_t           serial_processing = 0;
-  taskIndex_t    _taskIndex = INVALID_TASK_INDEX;
+  WiFiServer     *ser2netServer = nullptr;
+  uint16_t        gatewayPort   = 0;
+  WiFiClient      ser2netClient;
+  bool            clientConnected = false;
+  P020_RingBuffer serial_buffer;              // Serial -> client
+  P020_RingBuffer net_buffer;                 // Client -> serial
+  String          serial_rules_line;             // Incomplete line received for the rules
+  bool            serial_rules_overflow  = false; // Line too long for the rules, ignored until the next "\r\n"
+  unsigned long   serial_first_received  = 0; // Time of the oldest byte in serial_buffer
+  unsigned long   serial_last_received   = 0;
+  unsigned long   serial_tx_pending      = 0; // Estimated bytes in the UART TX FIFO
+  unsigned long   serial_tx_timestamp    = 0; // Time in usec of the last update of serial_tx_pending
+  unsigned long   serial_baudrate        = 0;
+  bool            serial_overflow_logged = false;
+  int             checkI                 = 0;
+  ESPeasySerial  *ser2netSerial          = nullptr;
+  uint8_t         serial_processing      = 0;
+  taskIndex_t     _taskIndex             = INVALID_TASK_INDEX;
 };
 
 #endif // ifdef USES_P020
@@ -7,11 +7,10 @@
 
 #include "../Globals/EventQueue.h"
 
+#include "../Helpers/CRC_functions.h"
 #include "../Helpers/ESPEasy_Storage.h"
 #include "../Helpers/Misc.h"
 
-#define P044_RX_WAIT              PCONFIG(0)
-
 
 P044_Task::P044_Task() {
   clearBuffer();
@@ -118,16 +117,17 @@ void P044_Task::checkBlinkLED() {
 }
 
 void P044_Task::clearBuffer() {
-  if (serial_buffer.length() > maxMessageSize) {
-    maxMessageSize = _min(serial_buffer.length(), P044_DATAGRAM_MAX_SIZE);
-  }
-
-  serial_buffer = "";
-  serial_buffer.reserve(maxMessageSize);
+  telegram_length = 0;
+  line_start      = 0;
+  crc             = 0;
+  checksum        = 0;
+  received_found  = 0;
 }
 
 void P044_Task::addChar(char ch) {
-  serial_buffer += ch;
+  if (telegram_length < P044_DATAGRAM_MAX_SIZE) {
+    telegram[telegram_length++] = ch;
+  }
 }
 
 /*  checkDatagram
@@ -135,55 +135,120 @@ void P044_Task::addChar(char ch) {
     attached to the telegram
  */
 bool P044_Task::checkDatagram() const {
-  int endChar = serial_buffer.length() - 1;
-
-  if (CRCcheck) {
-    endChar -= P044_CHECKSUM_LENGTH;
-  }
-
-  if ((endChar < 0) || (serial_buffer[0] != P044_DATAGRAM_START_CHAR) ||
-      (serial_buffer[endChar] != P044_DATAGRAM_END_CHAR)) { return false; }
+  if ((telegram_length == 0) || (telegram[0] != P044_DATAGRAM_START_CHAR)) { return false; }
 
   if (!CRCcheck) { return true; }
 
-  const int checksumStartIndex = endChar + 1;
+  // The CRC is calculated while receiving, up to and including the end char.
+  return checksum == crc;
+}
 
-  #ifdef PLUGIN_044_DEBUG
-    for (unsigned int cnt = 0; cnt < serial_buffer.length(); ++cnt) {
-      serialPrint(serial_buffer.substring(cnt, 1));
+namespace {
+// Parse a decimal value like "001234.567", stops at the first other character.
+bool P044_parseDecimal(const char *str, const char *end, float& value) {
+  double result    = 0.0;
+  double divider   = 1.0;
+  bool   decimals  = false;
+  bool   hasDigits = false;
+
+  for (; str < end; ++str) {
+    if (isdigit(*str)) {
+      result = result * 10.0 + (*str - '0');
+
+      if (decimals) { divider *= 10.0; }
+      hasDigits = true;
+    } else if ((*str == '.') && !decimals) {
+      decimals = true;
+    } else {
+      break;
     }
-  #endif
+  }
+
+  if (hasDigits) {
+    value = result / divider;
+  }
+  return hasDigits;
+}
+
+// Compare the OBIS code (without the leading "x-y:" part) of a line
+bool P044_matchObis(const char *obis, const char *obis_end, const __FlashStringHelper *code) {
+  const size_t length = strlen_P(reinterpret_cast<PGM_P>(code));
 
-  // calculate the CRC and check if it equals the hexadecimal one attached to the datagram
-  unsigned int crc = CRC16(serial_buffer, checksumStartIndex);
-  return strtoul(serial_buffer.substring(checksumStartIndex).c_str(), NULL, 16) == crc;
+  return (static_cast<size_t>(obis_end - obis) == length) &&
+         (strncmp_P(obis, reinterpret_cast<PGM_P>(code), length) == 0);
+}
 }
 
 /*
-   CRC16
-      based on code written by Jan ten Hove
-     https://github.com/jantenhove/P1-Meter-ESP8266
+   parseLine
+     Extract the value of known OBIS codes from the last received line of the telegram.
+     A line looks like "1-0:1.8.1(001234.567*kWh)", the gas meter has a timestamp first:
+     "0-1:24.2.1(101209112500W)(12785.123*m3)"
  */
-unsigned int P044_Task::CRC16(const String& buf, int len)
-{
-  unsigned int crc = 0;
+void P044_Task::parseLine(size_t start, size_t end) {
+  const char *line     = &telegram[start];
+  const char *line_end = &telegram[end];
+  const char *bracket  = static_cast<const char *>(memchr(line, '(', line_end - line));
+  const char *colon    = static_cast<const char *>(memchr(line, ':', line_end - line));
 
-  for (int pos = 0; pos < len; pos++)
-  {
-    crc ^= static_cast<const unsigned int>(buf[pos]); // XOR byte into least sig. byte of crc
+  if ((bracket == nullptr) || (colon == nullptr) || (colon > bracket)) {
+    return;
+  }
 
-    for (int i = 8; i != 0; i--) {                    // Loop over each bit
-      if ((crc & 0x0001) != 0) {                      // If the LSB is set
-        crc >>= 1;                                    // Shift right and XOR 0xA001
-        crc  ^= 0xA001;
-      }
-      else {                                          // Else LSB is not set
-        crc >>= 1;                                    // Just shift right
-      }
+  // Only check the part after "x-y:", as the channel of the gas meter may differ.
+  const char *obis = colon + 1;
+  uint8_t     index;
+
+  if (strncmp_P(line, PSTR("1-0:"), 4) == 0) {
+    if (P044_matchObis(obis, bracket, F("1.7.0"))) {
+      index = POWER_DELIVERED;
+    } else if (P044_matchObis(obis, bracket, F("2.7.0"))) {
+      index = POWER_RETURNED;
+    } else if (P044_matchObis(obis, bracket, F("1.8.1"))) {
+      index = TARIFF1;
+    } else if (P044_matchObis(obis, bracket, F("1.8.2"))) {
+      index = TARIFF2;
+    } else {
+      return;
     }
+  } else if (P044_matchObis(obis, bracket, F("24.2.1"))) {
+    index = GAS;
+  } else {
+    return;
+  }
+
+  // The value is in the last pair of brackets
+  const char *value_start = bracket;
+
+  for (const char *pos = bracket; pos < line_end; ++pos) {
+    if (*pos == '(') { value_start = pos; }
   }
 
-  return crc;
+  if (P044_parseDecimal(value_start + 1, line_end, received_values[index])) {
+    received_found |= (1 << index);
+  }
+}
+
+void P044_Task::setTaskValues(struct EventStruct *event) {
+  if (!newValues) { return; }
+
+  if (valid_found & ((1 << POWER_DELIVERED) | (1 << POWER_RETURNED))) {
+    UserVar[event->BaseVarIndex + P044_VALUE_POWER] = valid_values[POWER_DELIVERED] - valid_values[POWER_RETURNED];
+  }
+
+  if (valid_found & (1 << TARIFF1)) {
+    UserVar[event->BaseVarIndex + P044_VALUE_TARIFF1] = valid_values[TARIFF1];
+  }
+
+  if (valid_found & (1 << TARIFF2)) {
+    UserVar[event->BaseVarIndex + P044_VALUE_TARIFF2] = valid_values[TARIFF2];
+  }
+
+  if (valid_found & (1 << GAS)) {
+    UserVar[event->BaseVarIndex + P044_VALUE_GAS] = valid_values[GAS];
+  }
+  newValues          = false;
+  newValuesSinceRead = true;
 }
 
 /*
@@ -243,30 +308,27 @@ void P044_Task::serialEnd() {
 
 void P044_Task::handleSerialIn(struct EventStruct *event) {
   if (nullptr == P1EasySerial) { return; }
-  int  RXWait  = P044_RX_WAIT;
-  bool done    = false;
-  int  timeOut = RXWait;
 
-  do {
-    if (P1EasySerial->available()) {
-      digitalWrite(P044_STATUS_LED, 1);
-      done = handleChar(P1EasySerial->read());
-      digitalWrite(P044_STATUS_LED, 0);
+  // The parser keeps its state between calls, so only process what is already received.
+  int available = P1EasySerial->available();
 
-      if (done) { break; }
-      timeOut = RXWait; // if serial received, reset timeout counter
-    } else {
-      if (timeOut <= 0) { break; }
-      delay(1);
-      --timeOut;
-    }
-  } while (true);
+  if (available <= 0) { return; }
+  digitalWrite(P044_STATUS_LED, 1);
+
+  bool done = false;
+
+  while (available-- > 0 && !done) {
+    done = handleChar(P1EasySerial->read());
+  }
+  digitalWrite(P044_STATUS_LED, 0);
 
   if (done) {
-    P1GatewayClient.print(serial_buffer);
-    P1GatewayClient.flush();
+    setTaskValues(event);
 
-    addLog(LOG_LEVEL_DEBUG, F("P1   : data send!"));
+    if (hasClientConnected()) {
+      P1GatewayClient.write(reinterpret_cast<const uint8_t *>(telegram), telegram_length);
+      addLog(LOG_LEVEL_DEBUG, F("P1   : data send!"));
+    }
     blinkLED();
 
     if (Settings.UseRules)
@@ -280,7 +342,7 @@ void P044_Task::handleSerialIn(struct EventStruct *event) {
 }
 
 bool P044_Task::handleChar(char ch) {
-  if (serial_buffer.length() >= P044_DATAGRAM_MAX_SIZE - 2) { // room for cr/lf
+  if (telegram_length >= P044_DATAGRAM_MAX_SIZE - 2) { // room for cr/lf
     addLog(LOG_LEVEL_DEBUG, F("P1   : Error: Buffer overflow, discarded input."));
     state = ParserState::WAITING;                             // reset
   }
@@ -294,6 +356,7 @@ bool P044_Task::handleChar(char ch) {
       if (ch == P044_DATAGRAM_START_CHAR)  {
         clearBuffer();
         addChar(ch);
+        crc   = update_CRC16_ARC(crc, ch);
         state = ParserState::READING;
       } // else ignore data
       break;
@@ -301,8 +364,15 @@ bool P044_Task::handleChar(char ch) {
 
       if (validP1char(ch)) {
         addChar(ch);
+        crc = update_CRC16_ARC(crc, ch);
+
+        if (ch == '\n') {
+          parseLine(line_start, telegram_length);
+          line_start = telegram_length;
+        }
       } else if (ch == P044_DATAGRAM_END_CHAR) {
         addChar(ch);
+        crc = update_CRC16_ARC(crc, ch);
 
         if (CRCcheck) {
           checkI = 0;
@@ -320,8 +390,9 @@ bool P044_Task::handleChar(char ch) {
       break;
     case ParserState::CHECKSUM:
 
-      if (validP1char(ch)) {
+      if (isHexadecimalDigit(ch)) {
         addChar(ch);
+        checksum = (checksum << 4) | (isdigit(ch) ? ch - '0' : (toupper(ch) - 'A' + 10));
         ++checkI;
 
         if (checkI == P044_CHECKSUM_LENGTH) {
@@ -353,6 +424,14 @@ bool P044_Task::handleChar(char ch) {
       // from serial as the datagram has already been validated
       addChar('\r');
       addChar('\n');
+
+      for (uint8_t i = 0; i < NR_OBIS_VALUES; ++i) {
+        if (received_found & (1 << i)) {
+          valid_values[i] = received_values[i];
+        }
+      }
+      valid_found |= received_found;
+      newValues    = true;
     } else if (CRCcheck) {
       addLog(LOG_LEVEL_DEBUG, F("P1   : Error: Invalid CRC, dropped data"));
     } else {
@@ -15,6 +15,13 @@
 #define P044_DATAGRAM_END_CHAR             '!'
 #define P044_DATAGRAM_MAX_SIZE             2048u
 
+// Task values
+#define P044_NR_OUTPUT_VALUES              4
+#define P044_VALUE_POWER                   0 // 1-0:1.7.0 - 1-0:2.7.0 (kW)
+#define P044_VALUE_TARIFF1                 1 // 1-0:1.8.1 (kWh)
+#define P044_VALUE_TARIFF2                 2 // 1-0:1.8.2 (kWh)
+#define P044_VALUE_GAS                     3 // 0-n:24.2.1 (m3)
+
 
 struct P044_Task : public PluginTaskData_base {
   enum class ParserState : uint8_t {
@@ -55,12 +62,14 @@ struct P044_Task : public PluginTaskData_base {
   bool                checkDatagram() const;
 
   /*
-     CRC16
-        based on code written by Jan ten Hove
-       https://github.com/jantenhove/P1-Meter-ESP8266
+     parseLine
+       Extract the value of known OBIS codes from the last received line of the telegram.
    */
-  static unsigned int CRC16(const String& buf,
-                            int           len);
+  void                parseLine(size_t start,
+                                size_t end);
+
+  // Copy the values of the last valid telegram to the task values.
+  void                setTaskValues(struct EventStruct *event);
 
   /*
      validP1char
@@ -89,13 +98,38 @@ struct P044_Task : public PluginTaskData_base {
   uint16_t       gatewayPort     = 0;
   WiFiClient     P1GatewayClient;
   bool           clientConnected = false;
-  String         serial_buffer;
   ParserState    state             = ParserState::WAITING;
   int            checkI            = 0;
   boolean        CRCcheck          = false;
   ESPeasySerial *P1EasySerial      = nullptr;
   unsigned long  blinkLEDStartTime = 0;
-  size_t         maxMessageSize    = P044_DATAGRAM_MAX_SIZE / 4;
+
+  // Telegram as received, forwarded to the client when valid
+  char           telegram[P044_DATAGRAM_MAX_SIZE];
+  size_t         telegram_length = 0;
+  size_t         line_start      = 0; // Start of the line being received
+  uint16_t       crc             = 0; // CRC of the data received so far
+  uint16_t       checksum        = 0; // CRC received at the end of the telegram
+
+  enum ObisValue : uint8_t {
+    POWER_DELIVERED,
+    POWER_RETURNED,
+    TARIFF1,
+    TARIFF2,
+    GAS,
+    NR_OBIS_VALUES
+  };
+
+  // Values found in the telegram being received and in the last valid telegram.
+  // Bit n of the found flags is set when value n is found.
+  float          received_values[NR_OBIS_VALUES] = {};
+  uint8_t        received_found                  = 0;
+  float          valid_values[NR_OBIS_VALUES]    = {};
+  uint8_t        valid_found                     = 0;
+  bool           newValues                       = false;
+
+  // Set when the task values are updated, cleared by PLUGIN_READ.
+  bool           newValuesSinceRead              = false;
 };
 
 #endif
@@ -0,0 +1,128 @@
+#include "../PluginStructs/P078_data_struct.h"
+
+#ifdef USES_P078
+
+# include <algorithm>
+
+std::vector<P078_read_block>P078_planReads(std::vector<uint16_t>registers) {
+  std::vector<P078_read_block> blocks;
+
+  std::sort(registers.begin(), registers.end());
+  registers.erase(std::unique(registers.begin(), registers.end()), registers.end());
+
+  for (auto it = registers.begin(); it != registers.end(); ++it) {
+    const uint16_t reg = *it;
+
+    if (!blocks.empty()) {
+      P078_read_block& block    = blocks.back();
+      const uint16_t   blockEnd = block.startRegister + 2 * block.nrValues;
+
+      // Only merge values aligned with the block, as each value is 2 registers.
+      if ((reg >= blockEnd) && (((reg - block.startRegister) % 2) == 0) &&
+          ((reg - blockEnd) <= P078_MAX_REGISTER_GAP)) {
+        const uint16_t nrValues = ((reg - block.startRegister) / 2) + 1;
+
+        if (nrValues <= SDM_MAX_READ_VALUES) {
+          block.nrValues = nrValues;
+          continue;
+        }
+      }
+    }
+    P078_read_block block;
+    block.startRegister = reg;
+    block.nrValues      = 1;
+    blocks.push_back(block);
+  }
+  return blocks;
+}
+
+bool P078_meter_cache::update(SDM& sdm, uint8_t node, const std::vector<uint16_t>& registers) {
+  std::vector<uint16_t> toRead;
+
+  for (auto it = registers.begin(); it != registers.end(); ++it) {
+    if (!isFresh(node, *it)) {
+      toRead.push_back(*it);
+    }
+  }
+
+  if (toRead.empty()) {
+    return true;
+  }
+  bool success = true;
+  const std::vector<P078_read_block> blocks = P078_planReads(toRead);
+
+  for (auto block = blocks.begin(); block != blocks.end(); ++block) {
+    float values[SDM_MAX_READ_VALUES];
+
+    if (readBlock(sdm, node, *block, values) == SDM_ERR_NO_ERROR) {
+      // Only keep the requested values, not the ones read to fill the gaps.
+      for (auto reg = toRead.begin(); reg != toRead.end(); ++reg) {
+        if ((*reg >= block->startRegister) && (*reg < (block->startRegister + 2 * block->nrValues))) {
+          set(node, *reg, values[(*reg - block->startRegister) / 2]);
+        }
+      }
+    } else if (block->nrValues > 1) {
+      // The meter may not allow reading some registers in the gaps,
+      // so read the requested values one by one.
+      for (auto reg = toRead.begin(); reg != toRead.end(); ++reg) {
+        if ((*reg >= block->startRegister) && (*reg < (block->startRegister + 2 * block->nrValues))) {
+          P078_read_block single;
+          single.startRegister = *reg;
+          single.nrValues      = 1;
+
+          if (readBlock(sdm, node, single, values) == SDM_ERR_NO_ERROR) {
+            set(node, *reg, values[0]);
+          } else {
+            success = false;
+          }
+        }
+      }
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool P078_meter_cache::get(uint8_t node, uint16_t reg, float& value) const {
+  auto it = _values.find((static_cast<uint32_t>(node) << 16) | reg);
+
+  // Do not return old values when the last update failed.
+  if ((it == _values.end()) || (timePassedSince(it->second.timestamp) >= P078_CACHE_MAX_AGE)) {
+    return false;
+  }
+  value = it->second.value;
+  return true;
+}
+
+void P078_meter_cache::clear() {
+  _values.clear();
+}
+
+bool P078_meter_cache::isFresh(uint8_t node, uint16_t reg) const {
+  auto it = _values.find((static_cast<uint32_t>(node) << 16) | reg);
+
+  return it != _values.end() && timePassedSince(it->second.timestamp) < P078_CACHE_MAX_AGE;
+}
+
+void P078_meter_cache::set(uint8_t node, uint16_t reg, float value) {
+  CachedValue& cached = _values[(static_cast<uint32_t>(node) << 16) | reg];
+
+  cached.value     = value;
+  cached.timestamp = millis();
+}
+
+uint16_t P078_meter_cache::readBlock(SDM& sdm, uint8_t node, P078_read_block block, float *values) {
+  uint16_t errorcode = SDM_ERR_NO_ERROR;
+
+  for (uint8_t i = 0; i < P078_NR_TRIES; ++i) {
+    errorcode = sdm.readValues(block.startRegister, block.nrValues, values, node);
+
+    if (errorcode == SDM_ERR_NO_ERROR) {
+      return errorcode;
+    }
+  }
+  return errorcode;
+}
+
+#endif // ifdef USES_P078
@@ -0,0 +1,77 @@
+#ifndef PLUGINSTRUCTS_P078_DATA_STRUCT_H
+#define PLUGINSTRUCTS_P078_DATA_STRUCT_H
+
+#include "../../_Plugin_Helper.h"
+#ifdef USES_P078
+
+# include <SDM.h>
+
+# include <map>
+# include <vector>
+
+// Max. number of registers not asked for, which may be read to merge 2 blocks.
+// Reading a few extra values takes less time than another request.
+# ifndef P078_MAX_REGISTER_GAP
+#  define P078_MAX_REGISTER_GAP  4
+# endif // ifndef P078_MAX_REGISTER_GAP
+
+// Values read for another P078 task of the same meter are used when not older than this (msec)
+# ifndef P078_CACHE_MAX_AGE
+#  define P078_CACHE_MAX_AGE     1000
+# endif // ifndef P078_CACHE_MAX_AGE
+
+// Number of tries per request
+# define P078_NR_TRIES           3
+
+
+struct P078_read_block {
+  uint16_t startRegister = 0;
+  uint8_t  nrValues      = 0; // Each value is a float in 2 registers
+};
+
+// Merge the registers into the fewest contiguous block reads (function 0x04).
+std::vector<P078_read_block>P078_planReads(std::vector<uint16_t>registers);
+
+
+// Last read values of all meters, shared by all P078 tasks.
+// Several tasks may read the same meter, to output more than 4 values of a meter.
+struct P078_meter_cache {
+  // Read the registers not read recently from the meter, using as few requests as possible.
+  // Return false when not all registers could be read.
+  bool update(SDM                        & sdm,
+              uint8_t                      node,
+              const std::vector<uint16_t>& registers);
+
+  // Return false when the value was not read recently.
+  bool get(uint8_t  node,
+           uint16_t reg,
+           float  & value) const;
+
+  void clear();
+
+private:
+
+  bool isFresh(uint8_t  node,
+               uint16_t reg) const;
+
+  void set(uint8_t  node,
+           uint16_t reg,
+           float    value);
+
+  // Read a block, retry on errors.
+  static uint16_t readBlock(SDM           & sdm,
+                            uint8_t         node,
+                            P078_read_block block,
+                            float          *values);
+
+  struct CachedValue {
+    float         value;
+    unsigned long timestamp;
+  };
+
+  // Key: node << 16 | register
+  std::map<uint32_t, CachedValue>_values;
+};
+
+#endif // ifdef USES_P078
+#endif // ifndef PLUGINSTRUCTS_P078_DATA_STRUCT_H
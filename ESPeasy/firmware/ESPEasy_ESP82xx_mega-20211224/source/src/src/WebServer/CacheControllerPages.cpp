@@ -11,8 +11,10 @@
 #include "../DataTypes/TaskIndex.h"
 #include "../Globals/C016_ControllerCache.h"
 #include "../Globals/ExtraTaskSettings.h"
+#include "../Helpers/Convert.h"
 #include "../Helpers/ESPEasy_math.h"
 #include "../Helpers/ESPEasy_Storage.h"
+#include "../Helpers/Numerical.h"
 
 
 // ********************************************************************************
@@ -93,9 +95,35 @@ void handle_dumpcache() {
   TXBuffer.endStream();
 }
 
+// Optional arguments to limit the returned samples:
+//   from : UNIX timestamp of the first sample
+//   to   : UNIX timestamp of the last sample
+//   task : Task number (1 ... TASKS_MAX)
+// Cache files and blocks outside the selection are skipped without decoding.
+static C016_cache_filter get_cache_json_filter() {
+  C016_cache_filter filter;
+  unsigned int value = 0;
+
+  if (validUIntFromString(webArg(F("from")), value)) {
+    filter.from = value;
+  }
+
+  if (validUIntFromString(webArg(F("to")), value)) {
+    filter.to = value;
+  }
+
+  if (validUIntFromString(webArg(F("task")), value) && (value > 0) && (value <= TASKS_MAX)) {
+    filter.taskMask = 0;
+    bitSet(filter.taskMask, value - 1);
+  }
+  return filter;
+}
+
 void handle_cache_json() {
   if (!isLoggedIn()) { return; }
 
+  const C016_cache_filter filter = get_cache_json_filter();
+
   TXBuffer.startJsonStream();
   addHtml(F("{\"columns\": ["));
 
@@ -135,6 +163,49 @@ void handle_cache_json() {
     }
   }
   addHtml(F("],\n"));
+
+  // Cache files are stored compressed, so send the decoded samples.
+  // Each sample: [UNIX timestamp, task index, value 1 ... value 4]
+  C016_startCSVdump(filter);
+  addHtml(F("\"samples\": ["));
+  {
+    unsigned long timestamp;
+    uint8_t  controller_idx;
+    uint8_t  TaskIndex;
+    Sensor_VType  sensorType;
+    uint8_t  valueCount;
+    float values[VARS_PER_TASK];
+    bool  first = true;
+
+    while (C016_getCSVline(timestamp, controller_idx, TaskIndex, sensorType,
+                           valueCount, values[0], values[1], values[2], values[3])) {
+      String html;
+      html.reserve(80);
+
+      if (!first) {
+        html += F(",\n");
+      }
+      first = false;
+      html += '[';
+      html += timestamp;
+      html += ',';
+      html += TaskIndex;
+
+      for (int i = 0; i < VARS_PER_TASK; ++i) {
+        html += ',';
+
+        if (isValidFloat(values[i])) {
+          html += doubleToString(values[i], 6, true);
+        } else {
+          html += F("null");
+        }
+      }
+      html += ']';
+      addHtml(html);
+      delay(0);
+    }
+  }
+  addHtml(F("],\n"));
   stream_last_json_object_value(F("nrfiles"), String(filenr));
   addHtml(F("\n"));
   TXBuffer.endStream();
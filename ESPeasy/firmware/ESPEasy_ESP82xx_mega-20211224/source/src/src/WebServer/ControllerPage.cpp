@@ -330,6 +330,11 @@ void handle_controllers_ControllerSettingsPage(controllerIndex_t controllerindex
               addControllerParameterForm(ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_ALLOW_EXPIRE);
             }
             addControllerParameterForm(ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_DEDUPLICATE);
+            #ifdef USES_MQTT
+            if (Protocol[ProtocolIndex].usesMQTT) {
+              addControllerParameterForm(ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_MQTT_BURST_SIZE);
+            }
+            #endif // USES_MQTT
           }
 
           if (Protocol[ProtocolIndex].usesCheckReply) {
@@ -337,6 +337,7 @@ void handle_devices_CopySubmittedSettings(taskIndex_t taskIndex, pluginID_t task
   Settings.TaskDevicePort[taskIndex] = getFormItemInt(F("TDP"), 0);
   update_whenset_FormItemInt(F("remoteFeed"), Settings.TaskDeviceDataFeed[taskIndex]);
   Settings.CombineTaskValues_SingleEvent(taskIndex, isFormItemChecked(F("TVSE")));
+  Settings.CoalesceTaskEvents(taskIndex, isFormItemChecked(F("TVCE")));
 
   for (controllerIndex_t controllerNr = 0; controllerNr < CONTROLLER_MAX; controllerNr++)
   {
@@ -1206,6 +1207,10 @@ void devicePage_show_controller_config(taskIndex_t taskIndex, deviceIndex_t Devi
     addRowLabel(F("Single event with all values"));
     addCheckBox(F("TVSE"), Settings.CombineTaskValues_SingleEvent(taskIndex));
     addFormNote(F("Unchecked: Send event per value. Checked: Send single event (taskname#All) containing all values "));
+
+    addRowLabel(F("Latest value wins"));
+    addCheckBox(F("TVCE"), Settings.CoalesceTaskEvents(taskIndex));
+    addFormNote(F("Checked: A new event replaces the event of this task still waiting to be processed by the rules"));
     addFormSeparator(2);
 
     for (controllerIndex_t controllerNr = 0; controllerNr < CONTROLLER_MAX; controllerNr++)
@@ -473,7 +473,8 @@ void handle_timingstats_json() {
   json_init();
   json_open();
   # ifdef USES_TIMING_STATS
-  jsonStatistics(false);
+  // With "reset", the stats start a new window after being sent.
+  jsonStatistics(web_server.hasArg(F("reset")));
   # endif // ifdef USES_TIMING_STATS
   json_close();
   TXBuffer.endStream();
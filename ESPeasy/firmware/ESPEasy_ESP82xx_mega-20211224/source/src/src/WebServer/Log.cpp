@@ -71,22 +71,24 @@ void handle_log_JSON() {
   int  nrEntries               = 0;
   unsigned long firstTimeStamp = 0;
   unsigned long lastTimeStamp  = 0;
+  size_t nrBytes               = 0;
 
   while (logLinesAvailable) {
     String message;
     uint8_t loglevel;
     if (Logging.getNext(logLinesAvailable, lastTimeStamp, message, loglevel)) {
+      if (nrEntries != 0) {
+        addHtml(F(",\n"));
+      }
       addHtml('{');
       stream_next_json_object_value(F("timestamp"), String(lastTimeStamp));
       stream_next_json_object_value(F("text"),  message);
       stream_last_json_object_value(F("level"), String(loglevel));
-      if (logLinesAvailable) {
-        addHtml(F(",\n"));
-      }
       if (nrEntries == 0) {
         firstTimeStamp = lastTimeStamp;
       }
       ++nrEntries;
+      nrBytes += message.length();
     }
 
     // Do we need to do something here and maybe limit number of lines at once?
@@ -99,7 +101,9 @@ void handle_log_JSON() {
   if ((nrEntries > 2) && (logTimeSpan > 1)) {
     // May need to lower the TTL for refresh when time needed
     // to fill half the log is lower than current TTL
-    newOptimum = logTimeSpan * (LOG_STRUCT_MESSAGE_LINES / 2);
+    // The number of lines fitting in the log buffer depends on the average line length.
+    const long avgRecordSize = 8 + nrBytes / nrEntries;
+    newOptimum = logTimeSpan * ((LOG_STRUCT_BUFFER_SIZE / avgRecordSize) / 2);
     newOptimum = newOptimum / (nrEntries - 1);
   }
 
@@ -122,3 +126,27 @@ void handle_log_JSON() {
   handleNotFound();
   #endif // ifdef WEBSERVER_LOG
 }
+
+// ********************************************************************************
+// Web Interface log dump
+// All records in the log buffer as hex, one record per line.
+// Lines using deferred formatting (see LogFormat.h) are stored unformatted,
+// use tools/log_decoder.py to decode them.
+// ********************************************************************************
+#ifdef WEBSERVER_LOG
+static void addLogDumpLine(const String& line) {
+  addHtml(line);
+  addHtml('\n');
+}
+#endif // ifdef WEBSERVER_LOG
+
+void handle_log_dump() {
+  if (!isLoggedIn()) { return; }
+  #ifdef WEBSERVER_LOG
+  TXBuffer.startStream(F("text/plain"), F("*"));
+  Logging.dump(addLogDumpLine);
+  TXBuffer.endStream();
+  #else // ifdef WEBSERVER_LOG
+  handleNotFound();
+  #endif // ifdef WEBSERVER_LOG
+}
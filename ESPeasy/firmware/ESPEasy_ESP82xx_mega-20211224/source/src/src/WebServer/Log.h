@@ -14,6 +14,11 @@ void handle_log();
 // ********************************************************************************
 void handle_log_JSON();
 
+// ********************************************************************************
+// Web Interface log dump, to be decoded by tools/log_decoder.py
+// ********************************************************************************
+void handle_log_dump();
+
 
 
 #endif
\ No newline at end of file
@@ -2,9 +2,18 @@
 # include "../WebServer/WebServer.h"
 # include "../../ESPEasy-Globals.h"
 # include "../Commands/Diagnostic.h"
+# include "../DataStructs/LogStruct.h"
+# include "../DataStructs/TimingStats.h"
 # include "../ESPEasyCore/ESPEasyNetwork.h"
 # include "../ESPEasyCore/ESPEasyWifi.h"
 # include "../../_Plugin_Helper.h"
+# include "../Globals/Cache.h"
+# include "../Globals/ControllerQueueStats.h"
+# include "../Globals/CPlugins.h"
+# include "../Globals/ESPEasy_Scheduler.h"
+# include "../Globals/EventQueue.h"
+# include "../Globals/Logging.h"
+# include "../Globals/Protocol.h"
 # include "../Helpers/ESPEasyStatistics.h"
 # include "../Static/WebStaticData.h"
 
@@ -21,8 +30,8 @@ void handle_metrics() {
     addHtml(F("# HELP espeasy_uptime current device uptime in minutes\n"));
     addHtml(F("# TYPE espeasy_uptime counter\n"));
     addHtml(F("espeasy_uptime "));
-    addHtml(getValue(LabelType::UPTIME));       
-    addHtml('\n');    
+    addHtml(getValue(LabelType::UPTIME));
+    addHtml('\n');
 
     //load
     addHtml(F("# HELP espeasy_load device percentage load\n"));
@@ -31,6 +40,13 @@ void handle_metrics() {
     addHtml(getValue(LabelType::LOAD_PCT));
     addHtml('\n');
 
+    //Scheduler idle time
+    addHtml(F("# HELP espeasy_scheduler_idle_pct Percentage of time the scheduler was idle\n"));
+    addHtml(F("# TYPE espeasy_scheduler_idle_pct gauge\n"));
+    addHtml(F("espeasy_scheduler_idle_pct "));
+    addHtml(String(Scheduler.getIdleTimePct(), 2));
+    addHtml('\n');
+
     //Free RAM
     addHtml(F("# HELP espeasy_free_ram device amount of RAM free in Bytes\n"));
     addHtml(F("# TYPE espeasy_free_ram gauge\n"));
@@ -45,6 +61,9 @@ void handle_metrics() {
     addHtml(getValue(LabelType::FREE_STACK));
     addHtml('\n');
 
+    //Heap fragmentation
+    handle_metrics_heap();
+
     //Wifi strength
     addHtml(F("# HELP espeasy_wifi_rssi Wifi connection Strength\n"));
     addHtml(F("# TYPE espeasy_wifi_rssi gauge\n"));
@@ -66,52 +85,403 @@ void handle_metrics() {
     addHtml(getValue(LabelType::NUMBER_RECONNECTS));
     addHtml('\n');
 
+    //Log lines lost per log destination
+    addMetricsHeader(F("espeasy_log_lost_total"), F("Log lines not sent to the log destination, as they were overwritten or failed to send"), F("counter"));
+    addHtml(F("espeasy_log_lost_total{sink=\"serial\"} "));
+    addHtml(String(Logging.getLostCount(LogStruct::Sink::Serial)));
+    addHtml(F("\nespeasy_log_lost_total{sink=\"syslog\"} "));
+    addHtml(String(Logging.getLostCount(LogStruct::Sink::Syslog)));
+    addHtml(F("\nespeasy_log_lost_total{sink=\"web\"} "));
+    addHtml(String(Logging.getLostCount(LogStruct::Sink::Web)));
+    #ifdef FEATURE_SD
+    addHtml(F("\nespeasy_log_lost_total{sink=\"sd\"} "));
+    addHtml(String(Logging.getLostCount(LogStruct::Sink::SDcard)));
+    #endif
+    addHtml('\n');
+
+    //event queues
+    handle_metrics_event_queue();
+
+    //controllers
+    handle_metrics_controllers();
+
     //devices
     handle_metrics_devices();
 
+    //timing stats
+    handle_metrics_timing_stats();
+
       TXBuffer.endStream();
 }
 
+/*********************************************************************************************\
+ * Helpers to format metric names and labels
+\*********************************************************************************************/
+
+// Metric names may only contain [a-zA-Z0-9_]
+String metrics_name(const String& name) {
+    String res(name);
+    for (size_t i = 0; i < res.length(); ++i) {
+        const char c = res[i];
+        if (!isAlphaNumeric(c) && c != '_') {
+            res.setCharAt(i, '_');
+        }
+    }
+    return res;
+}
+
+void addMetricsLabelValue(const String& value) {
+    String res;
+    res.reserve(value.length() + 2);
+    res += '"';
+    for (size_t i = 0; i < value.length(); ++i) {
+        const char c = value[i];
+        switch (c) {
+            case '\\': res += F("\\\\"); break;
+            case '"':  res += F("\\\"");  break;
+            case '\n': res += F("\\n");   break;
+            default:   res += c;          break;
+        }
+    }
+    res += '"';
+    addHtml(res);
+}
+
+void addMetricsHeader(const __FlashStringHelper * name, const __FlashStringHelper * help, const __FlashStringHelper * type) {
+    addHtml(F("# HELP "));
+    addHtml(name);
+    addHtml(' ');
+    addHtml(help);
+    addHtml(F("\n# TYPE "));
+    addHtml(name);
+    addHtml(' ');
+    addHtml(type);
+    addHtml('\n');
+}
+
+void addMetricsValue(const __FlashStringHelper * name, const String& value) {
+    addHtml(name);
+    addHtml(' ');
+    addHtml(value);
+    addHtml('\n');
+}
+
+void handle_metrics_heap() {
+    #if defined(CORE_POST_2_5_0) || defined(ESP32)
+    # ifdef ESP32
+    const uint32_t maxFreeBlock = ESP.getMaxAllocHeap();
+    const uint32_t freeHeap     = ESP.getFreeHeap();
+    const uint8_t  fragmentation = freeHeap == 0 ? 0 : 100 - (static_cast<uint64_t>(maxFreeBlock) * 100) / freeHeap;
+    # else // ifdef ESP32
+    const uint32_t maxFreeBlock  = ESP.getMaxFreeBlockSize();
+    const uint8_t  fragmentation = ESP.getHeapFragmentation();
+    # endif // ifdef ESP32
+    addMetricsHeader(F("espeasy_heap_max_free_block"), F("Largest block of RAM which can be allocated in Bytes"), F("gauge"));
+    addMetricsValue(F("espeasy_heap_max_free_block"), String(maxFreeBlock));
+    addMetricsHeader(F("espeasy_heap_fragmentation"), F("Heap fragmentation in percent"), F("gauge"));
+    addMetricsValue(F("espeasy_heap_fragmentation"), String(fragmentation));
+    #endif // if defined(CORE_POST_2_5_0) || defined(ESP32)
+}
+
+void handle_metrics_event_queue() {
+    addMetricsHeader(F("espeasy_event_queue_length"), F("Number of rules events waiting to be processed"), F("gauge"));
+    addMetricsValue(F("espeasy_event_queue_length"), String(eventQueue.size()));
+    addMetricsHeader(F("espeasy_event_queue_capacity"), F("Max. number of queued rules events"), F("gauge"));
+    addMetricsValue(F("espeasy_event_queue_capacity"), String(eventQueue.capacity()));
+    addMetricsHeader(F("espeasy_event_queue_high_water_mark"), F("Highest number of queued rules events since boot"), F("gauge"));
+    addMetricsValue(F("espeasy_event_queue_high_water_mark"), String(eventQueue.highWaterMark()));
+    addMetricsHeader(F("espeasy_event_queue_dropped_total"), F("Rules events dropped as the queue was full"), F("counter"));
+    addMetricsValue(F("espeasy_event_queue_dropped_total"), String(eventQueue.droppedCount()));
+    addMetricsHeader(F("espeasy_event_queue_coalesced_total"), F("Rules events replaced by a newer value of the same event"), F("counter"));
+    addMetricsValue(F("espeasy_event_queue_coalesced_total"), String(eventQueue.coalescedCount()));
+    addMetricsHeader(F("espeasy_event_queue_merged_total"), F("Rules events merged into a queued event with the same name"), F("counter"));
+    addMetricsValue(F("espeasy_event_queue_merged_total"), String(eventQueue.mergedCount()));
+    addMetricsHeader(F("espeasy_system_event_queue_length"), F("Number of scheduled system events waiting to be processed"), F("gauge"));
+    addMetricsValue(F("espeasy_system_event_queue_length"), String(Scheduler.getSystemEventQueueSize()));
+}
+
+/*********************************************************************************************\
+ * Controller delay queues
+\*********************************************************************************************/
+enum class MetricsQueueValue {
+    Depth,
+    Sent,
+    Retries,
+    DroppedFull,
+    DroppedOldest,
+    DroppedRetries,
+    DroppedExpired
+};
+
+void handle_metrics_controller_queue(const __FlashStringHelper * name, MetricsQueueValue value) {
+    for (controllerIndex_t x = 0; x < CONTROLLER_MAX; x++)
+    {
+        const ControllerQueueStatsStruct* stats = getControllerQueueStats(x);
+        if (stats == nullptr || !Settings.ControllerEnabled[x]) {
+            continue;
+        }
+        const cpluginID_t cpluginID = getCPluginID_from_ControllerIndex(x);
+        if (!validCPluginID(cpluginID)) {
+            continue;
+        }
+        addHtml(name);
+        addHtml(F("{controller=\""));
+        addHtml(get_formatted_Controller_number(cpluginID));
+        addHtml(F("\",idx=\""));
+        addHtmlInt(x + 1);
+        addHtml('"');
+
+        uint32_t count = 0;
+        switch (value) {
+            case MetricsQueueValue::Depth:          count = stats->depth;          break;
+            case MetricsQueueValue::Sent:           count = stats->sent;           break;
+            case MetricsQueueValue::Retries:        count = stats->retries;        break;
+            case MetricsQueueValue::DroppedFull:    count = stats->droppedFull;    addHtml(F(",reason=\"full\""));    break;
+            case MetricsQueueValue::DroppedOldest:  count = stats->droppedOldest;  addHtml(F(",reason=\"oldest\""));  break;
+            case MetricsQueueValue::DroppedRetries: count = stats->droppedRetries; addHtml(F(",reason=\"retries\"")); break;
+            case MetricsQueueValue::DroppedExpired: count = stats->droppedExpired; addHtml(F(",reason=\"expired\"")); break;
+        }
+        addHtml(F("} "));
+        addHtml(String(count));
+        addHtml('\n');
+    }
+}
+
+void handle_metrics_controllers() {
+    addMetricsHeader(F("espeasy_controller_queue_depth"), F("Number of messages in the controller delay queue"), F("gauge"));
+    handle_metrics_controller_queue(F("espeasy_controller_queue_depth"), MetricsQueueValue::Depth);
+    addMetricsHeader(F("espeasy_controller_sent_total"), F("Messages successfully processed by the controller"), F("counter"));
+    handle_metrics_controller_queue(F("espeasy_controller_sent_total"), MetricsQueueValue::Sent);
+    addMetricsHeader(F("espeasy_controller_retries_total"), F("Failed attempts to send a message which is kept for a retry"), F("counter"));
+    handle_metrics_controller_queue(F("espeasy_controller_retries_total"), MetricsQueueValue::Retries);
+    addMetricsHeader(F("espeasy_controller_dropped_total"), F("Messages removed from the controller delay queue without being sent"), F("counter"));
+    handle_metrics_controller_queue(F("espeasy_controller_dropped_total"), MetricsQueueValue::DroppedFull);
+    handle_metrics_controller_queue(F("espeasy_controller_dropped_total"), MetricsQueueValue::DroppedOldest);
+    handle_metrics_controller_queue(F("espeasy_controller_dropped_total"), MetricsQueueValue::DroppedRetries);
+    handle_metrics_controller_queue(F("espeasy_controller_dropped_total"), MetricsQueueValue::DroppedExpired);
+}
+
+/*********************************************************************************************\
+ * Task values
+ * Names and decimals are taken from the cache, so a scrape does not need to read the task settings.
+\*********************************************************************************************/
 void handle_metrics_devices(){
     for (taskIndex_t x = 0; validTaskIndex(x); x++)
-    {        
+    {
         const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(x);
         const bool pluginID_set         = INVALID_PLUGIN_ID != Settings.TaskDeviceNumber[x];
-         if (pluginID_set){
-            LoadTaskSettings(x);            
-            if (Settings.TaskDeviceEnabled[x]){
-                String deviceName = ExtraTaskSettings.TaskDeviceName;
-                addHtml(F("# HELP espeasy_device_"));
-                addHtml(deviceName);
-                addHtml(F(" Values from connected device\n"));
-                addHtml(F("# TYPE espeasy_device_"));
+         if (pluginID_set && Settings.TaskDeviceEnabled[x] && validDeviceIndex(DeviceIndex)){
+            const ExtraTaskSettingsCache::TaskNames* names = Cache.extraTaskSettingsCache.getTaskNames(x);
+            if (names == nullptr) {
+                continue;
+            }
+            struct EventStruct TempEvent(x);
+            const Sensor_VType sensorType = TempEvent.getSensorType();
+            if (sensorType == Sensor_VType::SENSOR_TYPE_STRING) {
+                // Not a numerical value
+                continue;
+            }
+            const String deviceName = metrics_name(names->taskName);
+            addHtml(F("# HELP espeasy_device_"));
+            addHtml(deviceName);
+            addHtml(F(" Values from connected device\n"));
+            addHtml(F("# TYPE espeasy_device_"));
+            addHtml(deviceName);
+            addHtml(F(" gauge\n"));
+
+            const uint8_t valueCount = getValueCountForTask(x);
+            for (uint8_t varNr = 0; varNr < valueCount; varNr++)
+            {
+                addHtml(F("espeasy_device_"));
                 addHtml(deviceName);
-                addHtml(F(" gauge\n"));
-                if (validDeviceIndex(DeviceIndex)) {
-                    String customValuesString;
-                    //const bool customValues = PluginCall(PLUGIN_WEBFORM_SHOW_VALUES, &TempEvent, customValuesString);
-                    const bool customValues = 0; //TODO: handle custom values
-                    if (!customValues)
-                    {
-                        const uint8_t valueCount = getValueCountForTask(x);
-                        for (uint8_t varNr = 0; varNr < valueCount; varNr++)
-                        {
-                            if (validPluginID_fullcheck(Settings.TaskDeviceNumber[x]))
-                            {
-                                addHtml(F("espeasy_device_"));
-                                addHtml(deviceName);
-                                addHtml(F("{valueName=\""));
-                                addHtml(ExtraTaskSettings.TaskDeviceValueNames[varNr]);
-                                addHtml(F("\"} "));
-                                addHtml(formatUserVarNoCheck(x, varNr));
-                                addHtml('\n');
-                                
-                            }
-                        }
+                addHtml(F("{valueName="));
+                addMetricsLabelValue(names->valueNames[varNr]);
+                addHtml(F("} "));
+                if (sensorType == Sensor_VType::SENSOR_TYPE_LONG) {
+                    addHtml(String(UserVar.getSensorTypeLong(x)));
+                } else {
+                    const float f = UserVar[TempEvent.BaseVarIndex + varNr];
+                    if (isValidFloat(f)) {
+                        const uint8_t nrDecimals = Device[DeviceIndex].configurableDecimals() ? names->decimals[varNr] : 0;
+                        String value = toString(f, nrDecimals);
+                        value.trim();
+                        addHtml(value);
+                    } else {
+                        addHtml(F("NaN"));
                     }
                 }
+                addHtml('\n');
             }
-         }
+        }
+    }
+}
+
+/*********************************************************************************************\
+ * Timing statistics
+ * Exported as a summary with the p50/p95/p99 quantiles taken from the histogram, and a gauge for the max. duration.
+ * The sum and count are counted since timing stats were enabled and are not cleared when the timing stats page is viewed.
+ * The quantiles and max. duration cover the samples since the last reset of the timing stats.
+\*********************************************************************************************/
+#ifdef USES_TIMING_STATS
+
+enum class MetricsStatsType {
+    Plugin,
+    Controller,
+    Misc
+};
+
+// Return the stats at position index, or nullptr when past the end.
+TimingStats* getMetricsStats(MetricsStatsType type, size_t index, int& key) {
+    switch (type) {
+        case MetricsStatsType::Plugin:
+            if (pluginStats.begin() + index >= pluginStats.end()) { return nullptr; }
+            key = pluginStats.begin()[index].first;
+            return &pluginStats.begin()[index].second;
+        case MetricsStatsType::Controller:
+            if (controllerStats.begin() + index >= controllerStats.end()) { return nullptr; }
+            key = controllerStats.begin()[index].first;
+            return &controllerStats.begin()[index].second;
+        case MetricsStatsType::Misc:
+            if (index >= TIMING_STATS_MISC_MAX) { return nullptr; }
+            key = index;
+            return &miscStats[index];
     }
+    return nullptr;
 }
+
+// Return false when the key does not refer to a known plugin or controller.
+bool validMetricsStatsKey(MetricsStatsType type, int key) {
+    switch (type) {
+        case MetricsStatsType::Plugin:     return validDeviceIndex(static_cast<deviceIndex_t>(key / 256));
+        case MetricsStatsType::Controller: return validProtocolIndex(static_cast<protocolIndex_t>(key / 256));
+        case MetricsStatsType::Misc:       break;
+    }
+    return true;
+}
+
+// quantile: Add the quantile label when not 0
+void addMetricsStatsLabels(MetricsStatsType type, int key, uint8_t quantile = 0) {
+    switch (type) {
+        case MetricsStatsType::Plugin:
+        {
+            const deviceIndex_t deviceIndex = static_cast<deviceIndex_t>(key / 256);
+            addHtml(F("{plugin="));
+            addMetricsLabelValue(getPluginNameFromDeviceIndex(deviceIndex));
+            addHtml(F(",pluginID=\""));
+            addHtmlInt(Device[deviceIndex].Number);
+            addHtml(F("\",function="));
+            addMetricsLabelValue(getPluginFunctionName(key % 256));
+            break;
+        }
+        case MetricsStatsType::Controller:
+        {
+            const protocolIndex_t ProtocolIndex = key / 256;
+            addHtml(F("{controller="));
+            addMetricsLabelValue(getCPluginNameFromProtocolIndex(ProtocolIndex));
+            addHtml(F(",controllerID=\""));
+            addHtmlInt(Protocol[ProtocolIndex].Number);
+            addHtml(F("\",function="));
+            addMetricsLabelValue(getCPluginCFunctionName(static_cast<CPlugin::Function>(key % 256)));
+            break;
+        }
+        case MetricsStatsType::Misc:
+            addHtml(F("{name="));
+            addMetricsLabelValue(getMiscStatsName(key));
+            break;
+    }
+    if (quantile != 0) {
+        addHtml(F(",quantile=\"0."));
+        addHtmlInt(quantile);
+        addHtml('"');
+    }
+    addHtml(F("} "));
+}
+
+void handle_metrics_timing_stats(MetricsStatsType           type,
+                                 const __FlashStringHelper * name,
+                                 const __FlashStringHelper * help) {
+    const uint8_t quantiles[] = { 50, 95, 99 };
+    int key = 0;
+
+    addHtml(F("# HELP "));
+    addHtml(name);
+    addHtml(F("_seconds "));
+    addHtml(help);
+    addHtml(F("\n# TYPE "));
+    addHtml(name);
+    addHtml(F("_seconds summary\n"));
+
+    for (size_t i = 0; ; ++i) {
+        const TimingStats* stats = getMetricsStats(type, i, key);
+        if (stats == nullptr) {
+            break;
+        }
+        uint64_t totalTime = 0;
+        const uint32_t count = stats->getTotals(totalTime);
+        if ((count == 0) || !validMetricsStatsKey(type, key)) {
+            continue;
+        }
+
+        for (const uint8_t quantile : quantiles) {
+            addHtml(name);
+            addHtml(F("_seconds"));
+            addMetricsStatsLabels(type, key, quantile);
+            addHtml(String(stats->getPercentile(quantile) / 1000000.0, 6));
+            addHtml('\n');
+        }
+        addHtml(name);
+        addHtml(F("_seconds_sum"));
+        addMetricsStatsLabels(type, key);
+        addHtml(String(totalTime / 1000000.0, 6));
+        addHtml('\n');
+        addHtml(name);
+        addHtml(F("_seconds_count"));
+        addMetricsStatsLabels(type, key);
+        addHtml(String(count));
+        addHtml('\n');
+    }
+
+    addHtml(F("# HELP "));
+    addHtml(name);
+    addHtml(F("_max_seconds Max. duration since the timing stats were reset\n# TYPE "));
+    addHtml(name);
+    addHtml(F("_max_seconds gauge\n"));
+
+    for (size_t i = 0; ; ++i) {
+        const TimingStats* stats = getMetricsStats(type, i, key);
+        if (stats == nullptr) {
+            break;
+        }
+        if (stats->isEmpty() || !validMetricsStatsKey(type, key)) {
+            continue;
+        }
+        unsigned long minVal, maxVal;
+        stats->getMinMax(minVal, maxVal);
+
+        addHtml(name);
+        addHtml(F("_max_seconds"));
+        addMetricsStatsLabels(type, key);
+        addHtml(String(maxVal / 1000000.0, 6));
+        addHtml('\n');
+    }
+}
+
+void handle_metrics_timing_stats() {
+    if (!Settings.EnableTimingStats()) {
+        return;
+    }
+    handle_metrics_timing_stats(MetricsStatsType::Plugin,
+                                F("espeasy_plugin_call_duration"), F("Duration of plugin calls"));
+    handle_metrics_timing_stats(MetricsStatsType::Controller,
+                                F("espeasy_controller_call_duration"), F("Duration of controller calls"));
+    handle_metrics_timing_stats(MetricsStatsType::Misc,
+                                F("espeasy_misc_duration"), F("Duration of internal functions"));
+}
+
+#else // ifdef USES_TIMING_STATS
+
+void handle_metrics_timing_stats() {}
+
+#endif // ifdef USES_TIMING_STATS
+
 #endif // WEBSERVER_METRICS
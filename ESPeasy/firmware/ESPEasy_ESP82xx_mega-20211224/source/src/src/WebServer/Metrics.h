@@ -6,7 +6,11 @@
 #ifdef WEBSERVER_METRICS
 
 void handle_metrics();
+void handle_metrics_heap();
+void handle_metrics_event_queue();
+void handle_metrics_controllers();
 void handle_metrics_devices();
+void handle_metrics_timing_stats();
 
 #endif    // ifdef WEBSERVER_METRICS
 
@@ -530,6 +530,12 @@ void handle_sysinfo_SystemStatus() {
     addRowLabelValue(LabelType::I2C_BUS_STATE);
     addRowLabelValue(LabelType::I2C_BUS_CLEARED_COUNT);
   }
+
+  addRowLabelValue(LabelType::EVENT_QUEUE_SIZE);
+  addRowLabelValue(LabelType::EVENT_QUEUE_HIGH_WATER);
+  addRowLabelValue(LabelType::EVENT_QUEUE_DROPPED);
+  addRowLabelValue(LabelType::EVENT_QUEUE_COALESCED);
+  addRowLabelValue(LabelType::EVENT_QUEUE_MERGED);
 }
 
 void handle_sysinfo_NetworkServices() {
@@ -545,6 +551,28 @@ void handle_sysinfo_NetworkServices() {
   if (validControllerIndex(firstEnabledMQTT_ControllerIndex())) {
     addRowLabel(F("MQTT Client Connected"));
     addEnabled(MQTTclient_connected);
+
+    if (MQTT_queueDrainStats.totalMessages > 0) {
+      addRowLabel(F("MQTT Queue Drain"));
+      String html;
+      html.reserve(64);
+      html += MQTT_queueDrainStats.lastMessages;
+      html += F(" msg in ");
+      html += MQTT_queueDrainStats.lastDuration;
+      html += F(" ms (");
+      html += MQTT_queueDrainStats.getMessagesPerSecond();
+      html += F(" msg/s, ");
+      html += MQTT_queueDrainStats.getBytesPerSecond();
+      html += F(" bytes/s)");
+      addHtml(html);
+
+      addRowLabel(F("MQTT Messages Sent"));
+      html  = String(MQTT_queueDrainStats.totalMessages);
+      html += F(" (max. burst ");
+      html += MQTT_queueDrainStats.maxBurst;
+      html += ')';
+      addHtml(html);
+    }
   }
   #endif
 }
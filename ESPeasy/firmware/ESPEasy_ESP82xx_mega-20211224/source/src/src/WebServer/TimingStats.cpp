@@ -34,6 +34,9 @@ void handle_timingstats() {
   html_table_header(F("min (ms)"));
   html_table_header(F("Avg (ms)"));
   html_table_header(F("max (ms)"));
+  html_table_header(F("p50 (ms)"));
+  html_table_header(F("p95 (ms)"));
+  html_table_header(F("p99 (ms)"));
 
   long timeSinceLastReset = stream_timing_statistics(true);
   html_end_table();
@@ -48,6 +51,10 @@ void handle_timingstats() {
   addRowLabel(F("Time span"));
   addHtml(String(timespan));
   addHtml(F(" sec"));
+  addRowLabel(F("Dropped samples"));
+  addHtmlInt(pluginStats.droppedCount() + controllerStats.droppedCount());
+  addRowLabel(F("Stats without histogram"));
+  addHtmlInt(TimingStats::getNoHistogramCount());
   addRowLabel(F("*"));
   addHtml(F("Duty cycle based on average < 1 msec is highly unreliable"));
   html_end_table();
@@ -101,6 +108,12 @@ void stream_html_timing_stats(const TimingStats& stats, long timeSinceLastReset)
   format_using_threshhold(avg);
   html_TD();
   format_using_threshhold(maxVal);
+  html_TD();
+  format_using_threshhold(stats.getPercentile(50));
+  html_TD();
+  format_using_threshhold(stats.getPercentile(95));
+  html_TD();
+  format_using_threshhold(stats.getPercentile(99));
 }
 
 long stream_timing_statistics(bool clearStats) {
@@ -161,18 +174,20 @@ long stream_timing_statistics(bool clearStats) {
     }
   }
 
-  for (auto& x: miscStats) {
-    if (!x.second.isEmpty()) {
-      if (x.second.thresholdExceeded(TIMING_STATS_THRESHOLD)) {
+  for (int stat = 0; stat < TIMING_STATS_MISC_MAX; ++stat) {
+    TimingStats& stats = miscStats[stat];
+
+    if (!stats.isEmpty()) {
+      if (stats.thresholdExceeded(TIMING_STATS_THRESHOLD)) {
         html_TR_TD_highlight();
       } else {
         html_TR_TD();
       }
-      addHtml(getMiscStatsName(x.first));
+      addHtml(getMiscStatsName(stat));
       html_TD();
-      stream_html_timing_stats(x.second, timeSinceLastReset);
+      stream_html_timing_stats(stats, timeSinceLastReset);
 
-      if (clearStats) { x.second.reset(); }
+      if (clearStats) { stats.reset(); }
     }
   }
 
@@ -349,6 +349,7 @@ void WebServerInit()
   web_server.on(F("/csv"),             handle_csvval);
   web_server.on(F("/log"),             handle_log);
   web_server.on(F("/logjson"),         handle_log_JSON); // Also part of WEBSERVER_NEW_UI
+  web_server.on(F("/logdump"),         handle_log_dump);
 #ifdef USES_NOTIFIER
   web_server.on(F("/notifications"),   handle_notifications);
 #endif // ifdef USES_NOTIFIER
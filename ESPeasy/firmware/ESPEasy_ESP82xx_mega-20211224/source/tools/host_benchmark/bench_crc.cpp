@@ -0,0 +1,139 @@
+#include "benchmark.h"
+
+#include "../../src/src/Helpers/CRC_functions.h"
+
+#include <random>
+
+/*********************************************************************************************\
+* CRC functions, compared to the bitwise versions they replaced.
+* Reported per byte of a 4 kB buffer.
+\*********************************************************************************************/
+namespace {
+constexpr size_t bufferSize = 4096;
+
+// Bitwise versions, as they were before the lookup tables were used.
+uint16_t bitwise_CRC16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0;
+
+  while (length--) {
+    crc ^= static_cast<uint16_t>(*data++) << 8;
+
+    for (uint8_t i = 8; i; i--) {
+      crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint32_t bitwise_CRC32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xffffffff;
+
+  while (length--) {
+    const uint8_t c = *data++;
+
+    for (uint32_t i = 0x80; i > 0; i >>= 1) {
+      bool bit = crc & 0x80000000;
+
+      if (c & i) { bit = !bit; }
+      crc <<= 1;
+
+      if (bit) { crc ^= 0x04c11db7; }
+    }
+  }
+  return crc;
+}
+
+uint8_t bitwise_CRC8_Maxim(const uint8_t *data, size_t length) {
+  uint8_t crc = 0;
+
+  while (length--) {
+    uint8_t inbyte = *data++;
+
+    for (uint8_t i = 8; i; i--) {
+      const uint8_t mix = (crc ^ inbyte) & 0x01;
+      crc >>= 1;
+
+      if (mix) { crc ^= 0x8C; }
+      inbyte >>= 1;
+    }
+  }
+  return crc;
+}
+
+uint16_t bitwise_CRC16_ARC(const uint8_t *data, size_t length, uint16_t crc) {
+  while (length--) {
+    crc ^= *data++;
+
+    for (uint8_t i = 8; i; i--) {
+      crc = (crc & 0x0001) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+void check(Benchmark& bench, const char *name, uint32_t result, uint32_t expected) {
+  if (result != expected) {
+    bench.fail(std::string(name) + " = " + std::to_string(result) + ", expected " + std::to_string(expected));
+  }
+}
+
+void checkResults(Benchmark& bench, const std::vector<uint8_t>& buffer) {
+  // Check values of the CRC catalogue, for "123456789"
+  const uint8_t checkData[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+  check(bench, "calc_CRC16 check",        calc_CRC16(reinterpret_cast<const char *>(checkData), 9), 0x31C3);
+  check(bench, "calc_CRC32 check",        calc_CRC32(checkData, 9),                                 0x0376E6E7);
+  check(bench, "calc_CRC8_Maxim check",   calc_CRC8_Maxim(checkData, 9),                            0xA1);
+  check(bench, "calc_CRC16_ARC check",    calc_CRC16_ARC(checkData, 9),                             0xBB3D);
+  check(bench, "calc_CRC16_Modbus check", calc_CRC16_Modbus(checkData, 9),                          0x4B37);
+
+  // Same result as the bitwise versions, for all lengths and incremental use.
+  for (size_t length = 0; length < 300; ++length) {
+    const uint8_t *data  = buffer.data();
+    const size_t   split = length / 3;
+    const uint16_t init  = static_cast<uint16_t>(length * 257);
+
+    check(bench, "calc_CRC16", calc_CRC16(reinterpret_cast<const char *>(data), length), bitwise_CRC16(data, length));
+    check(bench, "calc_CRC32", calc_CRC32(data, length),                                bitwise_CRC32(data, length));
+    check(bench, "calc_CRC32 incremental",
+          calc_CRC32(data + split, length - split, calc_CRC32(data, split)),
+          bitwise_CRC32(data, length));
+    check(bench, "calc_CRC8_Maxim",   calc_CRC8_Maxim(data, length),         bitwise_CRC8_Maxim(data, length));
+    check(bench, "calc_CRC16_ARC",    calc_CRC16_ARC(data, length, init),    bitwise_CRC16_ARC(data, length, init));
+    check(bench, "calc_CRC16_Modbus", calc_CRC16_Modbus(data, length),       bitwise_CRC16_ARC(data, length, 0xffff));
+  }
+}
+}
+
+void bench_crc(Benchmark& bench) {
+  std::vector<uint8_t> buffer(bufferSize);
+  std::mt19937 generator(42);
+
+  for (uint8_t& value : buffer) {
+    value = static_cast<uint8_t>(generator());
+  }
+
+  checkResults(bench, buffer);
+
+  // Keep the results, so the calls are not optimized away.
+  volatile uint32_t sink = 0;
+
+  bench.run("CRC32 (bitwise, per byte)", bufferSize, [&]() {
+    sink = sink + bitwise_CRC32(buffer.data(), bufferSize);
+  });
+  bench.run("calc_CRC32 (per byte)", bufferSize, [&]() {
+    sink = sink + calc_CRC32(buffer.data(), bufferSize);
+  });
+  bench.run("CRC16 Modbus (bitwise, per byte)", bufferSize, [&]() {
+    sink = sink + bitwise_CRC16_ARC(buffer.data(), bufferSize, 0xffff);
+  });
+  bench.run("calc_CRC16_Modbus (per byte)", bufferSize, [&]() {
+    sink = sink + calc_CRC16_Modbus(buffer.data(), bufferSize);
+  });
+  bench.run("CRC8 Maxim (bitwise, per byte)", bufferSize, [&]() {
+    sink = sink + bitwise_CRC8_Maxim(buffer.data(), bufferSize);
+  });
+  bench.run("calc_CRC8_Maxim (per byte)", bufferSize, [&]() {
+    sink = sink + calc_CRC8_Maxim(buffer.data(), bufferSize);
+  });
+}
@@ -0,0 +1,122 @@
+#include "benchmark.h"
+#include "host_stubs.h"
+
+#include "../../src/src/Globals/Plugins_other.h"
+#include "../../src/src/Helpers/Rules_calculate.h"
+#include "../../src/src/Helpers/StringParser.h"
+
+#include <math.h>
+
+/*********************************************************************************************\
+* parseTemplate() and Calculate(), replaying the lines in data/templates.txt and data/expressions.txt
+\*********************************************************************************************/
+namespace {
+void setupTasks() {
+  host_addTask(0, "bme",   "Temperature,Humidity,Pressure", 2);
+  host_addTask(1, "power", "Watt,Voltage,Current,Energy",   1);
+  host_addTask(2, "door",  "State",                         0);
+  host_addTask(3, "light", "State",                         0);
+
+  host_setTaskValue(0, 0, 21.5f);
+  host_setTaskValue(0, 1, 45.25f);
+  host_setTaskValue(0, 2, 1013.2f);
+  host_setTaskValue(1, 0, 1842.5f);
+  host_setTaskValue(1, 1, 230.1f);
+  host_setTaskValue(1, 2, 8.0f);
+  host_setTaskValue(1, 3, 12345.6f);
+  host_setTaskValue(2, 0, 1.0f);
+  host_setTaskValue(3, 0, 0.0f);
+}
+
+// Any callback makes parseTemplate() skip the compiled templates.
+void interpretTemplates(String& tmpString, bool useURLencode) {}
+
+void checkTemplate(Benchmark& bench, const char *input, const char *expected) {
+  String tmpString(input);
+  const String result = parseTemplate(tmpString);
+
+  if (!result.equals(expected)) {
+    bench.fail(std::string("parseTemplate(\"") + input + "\") = \"" + result.c_str() + "\", expected \"" + expected + "\"");
+  }
+}
+
+void checkCalculate(Benchmark& bench, const char *input, double expected) {
+  double result = 0.0;
+
+  if (isError(Calculate(input, result)) || (fabs(result - expected) > 1e-6)) {
+    bench.fail(std::string("Calculate(\"") + input + "\") = " + std::to_string(result) + ", expected " + std::to_string(expected));
+  }
+}
+
+void checkResults(Benchmark& bench) {
+  // Each check runs twice, the second call uses the compiled template.
+  for (int i = 0; i < 2; ++i) {
+    checkTemplate(bench, "[bme#Temperature]",                    "21.50");
+    checkTemplate(bench, "T=[bme#temperature#D3.1] [door#State#C]", "T=021.5  OPEN");
+    checkTemplate(bench, "[power#Watt#F] W",                     "1842 W");
+    checkTemplate(bench, "[unknown#Value]",                      "");
+  }
+  checkCalculate(bench, "21.5*2", 43.0);
+  checkCalculate(bench, "(1+2)*3-4/2", 7.0);
+  checkCalculate(bench, "1+sq(3)", 10.0);
+  checkCalculate(bench, "abs(-1)", 1.0);
+}
+}
+
+void bench_parser(Benchmark& bench) {
+  setupTasks();
+  checkResults(bench);
+
+  const std::vector<std::string> templateLines = bench.readLines("templates.txt");
+  std::vector<String> templates;
+
+  for (const std::string& line : templateLines) {
+    templates.emplace_back(line.c_str());
+  }
+
+  bench.run("parseTemplate (compiled)", templates.size(), [&]() {
+    for (const String& line : templates) {
+      String tmpString(line);
+      parseTemplate(tmpString);
+    }
+  });
+
+  parseTemplate_CallBack_ptr = interpretTemplates;
+  bench.run("parseTemplate (interpreted)", templates.size(), [&]() {
+    for (const String& line : templates) {
+      String tmpString(line);
+      parseTemplate(tmpString);
+    }
+  });
+  parseTemplate_CallBack_ptr = nullptr;
+
+  const std::vector<std::string> expressionLines = bench.readLines("expressions.txt");
+  std::vector<String> expressions;
+
+  for (const std::string& line : expressionLines) {
+    expressions.emplace_back(line.c_str());
+  }
+
+  bench.run("Calculate", expressions.size(), [&]() {
+    double result;
+
+    for (const String& line : expressions) {
+      Calculate(line, result);
+    }
+  });
+
+  std::vector<CalculateProgram> programs(expressions.size());
+
+  for (size_t i = 0; i < expressions.size(); ++i) {
+    RulesCalculate.compile(RulesCalculate_t::preProces(expressions[i]), programs[i]);
+  }
+
+  bench.run("RulesCalculate.evaluate (compiled)", programs.size(), [&]() {
+    const double slotValues[CALCULATE_NR_SLOTS] = { 0.0 };
+    double result;
+
+    for (const CalculateProgram& program : programs) {
+      RulesCalculate.evaluate(program, slotValues, result);
+    }
+  });
+}
@@ -0,0 +1,118 @@
+#include "benchmark.h"
+
+#include <FS.h>
+
+#include <atomic>
+#include <chrono>
+#include <new>
+
+/*********************************************************************************************\
+* Count heap allocations
+\*********************************************************************************************/
+namespace {
+std::atomic<uint64_t> allocationCount(0);
+}
+
+void* operator new(size_t size) {
+  ++allocationCount;
+
+  void *p = malloc(size == 0 ? 1 : size);
+
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+uint64_t getAllocationCount() {
+  return allocationCount;
+}
+
+/*********************************************************************************************\
+* Benchmark
+\*********************************************************************************************/
+void Benchmark::run(const char *name, size_t nrOps, const std::function<void()>& function) {
+  typedef std::chrono::steady_clock clock;
+
+  const clock::duration minDuration = _quick ? clock::duration::zero() : std::chrono::milliseconds(200);
+
+  // Warm up, e.g. to fill caches
+  function();
+
+  uint64_t runs = 0;
+  const uint64_t allocationsStart = getAllocationCount();
+  const clock::time_point start   = clock::now();
+  clock::duration elapsed;
+
+  do {
+    function();
+    ++runs;
+    elapsed = clock::now() - start;
+  } while (elapsed < minDuration);
+
+  const double ops = static_cast<double>(runs) * nrOps;
+
+  printf("%-40s %10.1f ns/op %8.2f allocs/op\n",
+         name,
+         std::chrono::duration<double, std::nano>(elapsed).count() / ops,
+         (getAllocationCount() - allocationsStart) / ops);
+}
+
+void Benchmark::fail(const std::string& message) {
+  printf("FAILED: %s\n", message.c_str());
+  _failed = true;
+}
+
+std::vector<std::string> Benchmark::readLines(const char *fileName) {
+  std::vector<std::string> lines;
+  String path(F("data/"));
+
+  path += fileName;
+  fs::File file = SPIFFS.open(path, "r");
+
+  if (!file) {
+    fail(std::string("Cannot open ") + path.c_str());
+    return lines;
+  }
+  std::string line;
+
+  while (file.available() > 0) {
+    const int c = file.read();
+
+    if ((c == '\n') || (c < 0)) {
+      if (!line.empty() && (line[0] != '#')) {
+        lines.push_back(line);
+      }
+      line.clear();
+    } else if (c != '\r') {
+      line += static_cast<char>(c);
+    }
+  }
+
+  if (!line.empty() && (line[0] != '#')) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/*********************************************************************************************\
+* Usage: host_benchmark [--quick]
+* Run from the tools/host_benchmark directory, to find the data files.
+\*********************************************************************************************/
+int main(int argc, char *argv[]) {
+  const bool quick = (argc > 1) && (strcmp(argv[1], "--quick") == 0);
+  Benchmark  bench(quick);
+
+  bench_crc(bench);
+  bench_parser(bench);
+
+  return bench.failed() ? 1 : 0;
+}
@@ -0,0 +1,53 @@
+#ifndef HOST_BENCHMARK_BENCHMARK_H
+#define HOST_BENCHMARK_BENCHMARK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/*********************************************************************************************\
+* Minimal benchmark runner for the host build.
+* Each benchmark is run for about 0.2 sec (a single run with --quick)
+* and reports the time and number of heap allocations per operation.
+\*********************************************************************************************/
+class Benchmark {
+public:
+
+  explicit Benchmark(bool quick) : _quick(quick) {}
+
+  // Run the function repeatedly, each call performs nrOps operations.
+  void run(const char                   *name,
+           size_t                        nrOps,
+           const std::function<void()>& function);
+
+  // Mark the benchmark run as failed, e.g. when a result is not as expected.
+  void fail(const std::string& message);
+
+  bool failed() const {
+    return _failed;
+  }
+
+  bool quick() const {
+    return _quick;
+  }
+
+  // Read all non-empty lines not starting with '#' from a file in the data directory.
+  std::vector<std::string> readLines(const char *fileName);
+
+private:
+
+  bool _quick;
+  bool _failed = false;
+};
+
+// Number of heap allocations since the start of the process.
+uint64_t getAllocationCount();
+
+// Benchmark suites
+void bench_crc(Benchmark& bench);
+void bench_parser(Benchmark& bench);
+
+#endif // HOST_BENCHMARK_BENCHMARK_H
@@ -0,0 +1,198 @@
+#include "host_stubs.h"
+
+#include "../../src/_Plugin_Helper.h"
+#include "../../src/src/Commands/GPIO.h"
+#include "../../src/src/DataStructs/Caches.h"
+#include "../../src/src/DataStructs/ExtraTaskSettingsStruct.h"
+#include "../../src/src/DataStructs/SettingsStruct.h"
+#include "../../src/src/ESPEasyCore/ESPEasyRules.h"
+#include "../../src/src/ESPEasyCore/ESPEasy_Log.h"
+#include "../../src/src/Globals/RamTracker.h"
+#include "../../src/src/Globals/RuntimeData.h"
+#include "../../src/src/Helpers/Convert.h"
+#include "../../src/src/Helpers/ESPEasy_Storage.h"
+#include "../../src/src/Helpers/Misc.h"
+#include "../../src/src/Helpers/StringConverter.h"
+
+/*********************************************************************************************\
+* Globals of the firmware
+\*********************************************************************************************/
+Caches Cache;
+ExtraTaskSettingsStruct ExtraTaskSettings;
+SettingsStruct Settings;
+
+
+/*********************************************************************************************\
+* Simulated tasks
+\*********************************************************************************************/
+namespace {
+struct HostTask {
+  String  name;
+  String  valueNames[VARS_PER_TASK];
+  uint8_t valueCount = 0;
+  uint8_t decimals   = 2;
+  float   values[VARS_PER_TASK] = { 0 };
+};
+
+HostTask hostTasks[TASKS_MAX];
+}
+
+void host_addTask(taskIndex_t taskIndex, const char *name, const char *valueNames, uint8_t decimals) {
+  if (!validTaskIndex(taskIndex)) { return; }
+  HostTask& task = hostTasks[taskIndex];
+
+  task.name       = name;
+  task.decimals   = decimals;
+  task.valueCount = 0;
+
+  String names(valueNames);
+
+  while (task.valueCount < VARS_PER_TASK) {
+    const int comma = names.indexOf(',');
+
+    task.valueNames[task.valueCount++] = names.substring(0, comma < 0 ? names.length() : comma);
+
+    if (comma < 0) { break; }
+    names = names.substring(comma + 1);
+  }
+  Settings.TaskDeviceEnabled[taskIndex] = true;
+
+  // See Caches::updateTaskCaches()
+  Cache.taskIndexName.clear();
+  Cache.taskIndexValueName.clear();
+  Cache.templateCache.clear();
+  ExtraTaskSettings.clear();
+}
+
+void host_setTaskValue(taskIndex_t taskIndex, uint8_t valueNr, float value) {
+  if (validTaskIndex(taskIndex) && (valueNr < VARS_PER_TASK)) {
+    hostTasks[taskIndex].values[valueNr] = value;
+  }
+}
+
+/*********************************************************************************************\
+* Replacements of firmware functions not built for the host
+\*********************************************************************************************/
+
+// Globals/Plugins.cpp
+bool validTaskIndex(taskIndex_t index) {
+  return index < TASKS_MAX;
+}
+
+bool validDeviceIndex(deviceIndex_t index) {
+  return index < TASKS_MAX;
+}
+
+deviceIndex_t getDeviceIndex_from_TaskIndex(taskIndex_t taskIndex) {
+  // Each simulated task uses its own device
+  if (validTaskIndex(taskIndex) && Settings.TaskDeviceEnabled[taskIndex]) {
+    return taskIndex;
+  }
+  return INVALID_DEVICE_INDEX;
+}
+
+bool PluginCall(uint8_t Function, struct EventStruct *event, String& str) {
+  // Simulated tasks have no plugin specific config values.
+  return false;
+}
+
+// Helpers/ESPEasy_Storage.cpp
+String LoadTaskSettings(taskIndex_t TaskIndex) {
+  if (ExtraTaskSettings.TaskIndex == TaskIndex) {
+    return EMPTY_STRING;
+  }
+  ExtraTaskSettings.clear();
+
+  if (validTaskIndex(TaskIndex)) {
+    const HostTask& task = hostTasks[TaskIndex];
+
+    ExtraTaskSettings.TaskIndex = TaskIndex;
+    safe_strncpy(ExtraTaskSettings.TaskDeviceName, task.name, sizeof(ExtraTaskSettings.TaskDeviceName));
+
+    for (uint8_t i = 0; i < task.valueCount; ++i) {
+      safe_strncpy(ExtraTaskSettings.TaskDeviceValueNames[i], task.valueNames[i], sizeof(ExtraTaskSettings.TaskDeviceValueNames[i]));
+      ExtraTaskSettings.TaskDeviceValueDecimals[i] = task.decimals;
+    }
+  }
+  return EMPTY_STRING;
+}
+
+// Helpers/Misc.cpp
+String getTaskDeviceName(taskIndex_t TaskIndex) {
+  return validTaskIndex(TaskIndex) ? hostTasks[TaskIndex].name : EMPTY_STRING;
+}
+
+// Helpers/_Plugin_Helper.cpp
+int getValueCountForTask(taskIndex_t taskIndex) {
+  return validTaskIndex(taskIndex) ? hostTasks[taskIndex].valueCount : 0;
+}
+
+int checkDeviceVTypeForTask(struct EventStruct *event) {
+  // Simulated tasks have no configurable output type.
+  return -1;
+}
+
+// Helpers/StringConverter.cpp
+String formatUserVar(taskIndex_t TaskIndex, uint8_t rel_index, bool& isvalid) {
+  isvalid = validTaskIndex(TaskIndex) && (rel_index < hostTasks[TaskIndex].valueCount);
+
+  if (!isvalid) {
+    return EMPTY_STRING;
+  }
+  const HostTask& task = hostTasks[TaskIndex];
+
+  return doubleToString(task.values[rel_index], task.decimals);
+}
+
+bool safe_strncpy(char *dest, const String& source, size_t max_size) {
+  return safe_strncpy(dest, source.c_str(), max_size);
+}
+
+bool safe_strncpy(char *dest, const char *source, size_t max_size) {
+  if ((max_size < 1) || (dest == nullptr) || (source == nullptr)) { return false; }
+  strncpy(dest, source, max_size - 1);
+  dest[max_size - 1] = 0;
+  return strlen(source) < max_size;
+}
+
+// System variables (%sysname%, %v1% etc.) and standard conversions (%c_...%) are not replaced.
+void parseSystemVariables(String& s, bool useURLencode) {}
+
+void parseStandardConversions(String& s, bool useURLencode) {}
+
+bool GetArgv(const char *string, String& argvString, unsigned int argc, char separator) {
+  return false;
+}
+
+// ESPEasyCore/ESPEasyRules.cpp
+// String commands ({substring:...} etc.) are not replaced.
+void parse_string_commands(String& line) {}
+
+// Commands/GPIO.cpp
+bool getGPIOPinStateValues(String& str) {
+  return false;
+}
+
+// ESPEasyCore/ESPEasy_Log.cpp
+// Logging is disabled, as the benchmark should not measure output.
+bool loglevelActiveFor(uint8_t logLevel) {
+  return false;
+}
+
+void addLog(uint8_t loglevel, const __FlashStringHelper *str) {}
+
+void addLog(uint8_t logLevel, const char *line) {}
+
+void addLog(uint8_t loglevel, const String& string) {}
+
+// Globals/RamTracker.cpp
+void checkRAM(const __FlashStringHelper *descr) {}
+
+void checkRAM(const String& descr) {}
+
+// ESPEasy_common.h
+String getUnknownString() {
+  return F("Unknown");
+}
+
+const String EMPTY_STRING;
@@ -0,0 +1,24 @@
+#ifndef HOST_BENCHMARK_HOST_STUBS_H
+#define HOST_BENCHMARK_HOST_STUBS_H
+
+#include "../../src/ESPEasy_common.h"
+
+#include "../../src/src/DataTypes/TaskIndex.h"
+
+/*********************************************************************************************\
+* Simulated tasks for the host build.
+* Functions of the firmware not built for the host (plugins, settings files, system variables)
+* are replaced in host_stubs.cpp and use these tasks.
+\*********************************************************************************************/
+
+// Add an enabled task with up to VARS_PER_TASK value names, separated by a comma.
+void host_addTask(taskIndex_t taskIndex,
+                  const char *name,
+                  const char *valueNames,
+                  uint8_t     decimals);
+
+void host_setTaskValue(taskIndex_t taskIndex,
+                       uint8_t     valueNr,
+                       float       value);
+
+#endif // HOST_BENCHMARK_HOST_STUBS_H
@@ -0,0 +1,30 @@
+#include <Arduino.h>
+#include <FS.h>
+
+#include <chrono>
+#include <thread>
+
+namespace {
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+}
+
+fs::FS SPIFFS;
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {}
+
+char* dtostrf(double number, signed char width, unsigned char prec, char *s) {
+  sprintf(s, "%*.*f", width, prec, number);
+  return s;
+}
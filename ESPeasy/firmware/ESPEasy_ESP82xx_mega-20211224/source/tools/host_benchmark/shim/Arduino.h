@@ -0,0 +1,82 @@
+#ifndef HOST_SHIM_ARDUINO_H
+#define HOST_SHIM_ARDUINO_H
+
+// Host (Linux) replacement of the Arduino core, for the host benchmark.
+// Neither ESP8266 nor ESP32 is defined, so platform specific code is left out.
+
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "WString.h"
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define PROGMEM
+#define PGM_P                const char *
+#define PSTR(s)              (s)
+#define pgm_read_byte(addr)  (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr)  (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+#define pgm_read_float(addr) (*reinterpret_cast<const float *>(addr))
+#define strlen_P             strlen
+#define strcmp_P             strcmp
+#define strncmp_P            strncmp
+#define strcasecmp_P         strcasecmp
+#define memcpy_P             memcpy
+#define snprintf_P           snprintf
+#define strncpy_P            strncpy
+#define sprintf_P            sprintf
+
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+#ifndef PI
+# define PI 3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+
+using std::min;
+using std::max;
+
+#define bitRead(value, bit)            (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)             ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)           ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define isDigit(c) (isdigit(static_cast<unsigned char>(c)) != 0)
+#define isAlpha(c) (isalpha(static_cast<unsigned char>(c)) != 0)
+#define isAlphaNumeric(c) (isalnum(static_cast<unsigned char>(c)) != 0)
+#define isSpace(c) (isspace(static_cast<unsigned char>(c)) != 0)
+#define isHexadecimalDigit(c) (isxdigit(static_cast<unsigned char>(c)) != 0)
+
+char* dtostrf(double number, signed char width, unsigned char prec, char *s);
+
+// Time since the start of the process.
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long ms);
+void          yield();
+
+#endif // HOST_SHIM_ARDUINO_H
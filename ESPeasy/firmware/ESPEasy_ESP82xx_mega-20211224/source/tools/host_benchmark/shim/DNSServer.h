@@ -0,0 +1,7 @@
+#ifndef HOST_SHIM_DNSSERVER_H
+#define HOST_SHIM_DNSSERVER_H
+
+// Only the type is needed to build the host benchmark.
+class DNSServer {};
+
+#endif // HOST_SHIM_DNSSERVER_H
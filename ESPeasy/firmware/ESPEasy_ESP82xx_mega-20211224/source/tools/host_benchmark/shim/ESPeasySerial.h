@@ -0,0 +1,21 @@
+#ifndef HOST_SHIM_ESPEASYSERIAL_H
+#define HOST_SHIM_ESPEASYSERIAL_H
+
+// Only the types are needed to build the host benchmark, see lib/ESPEasySerial/ESPeasySerial.h
+
+// Keep value assigned as it is used in scripts and stored in the Settings.TaskDevicePort
+enum class ESPEasySerialPort {
+  not_set      = 0,
+  sc16is752    = 1,
+  serial0      = 2,
+  serial0_swap = 3,
+  serial1      = 4,
+  serial2      = 5,
+  software     = 6,
+
+  MAX_SERIAL_TYPE
+};
+
+class ESPeasySerial {};
+
+#endif // HOST_SHIM_ESPEASYSERIAL_H
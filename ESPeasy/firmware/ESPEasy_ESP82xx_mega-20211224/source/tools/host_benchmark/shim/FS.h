@@ -0,0 +1,159 @@
+#ifndef HOST_SHIM_FS_H
+#define HOST_SHIM_FS_H
+
+// Host (Linux) version of the Arduino file system File, backed by stdio.
+// Paths are relative to the working directory of the benchmark.
+
+#include <Arduino.h>
+
+namespace fs {
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class File {
+public:
+
+  File() {}
+
+  explicit File(FILE *file, const char *path) : _file(file), _name(path) {}
+
+  File(const File&)            = delete;
+  File& operator=(const File&) = delete;
+
+  File(File&& other) : _file(other._file), _name(other._name) {
+    other._file = nullptr;
+  }
+
+  File& operator=(File&& other) {
+    if (this != &other) {
+      close();
+      _file       = other._file;
+      _name       = other._name;
+      other._file = nullptr;
+    }
+    return *this;
+  }
+
+  ~File() {
+    close();
+  }
+
+  size_t write(uint8_t c) {
+    return write(&c, 1);
+  }
+
+  size_t write(const uint8_t *buf, size_t size) {
+    return _file ? fwrite(buf, 1, size, _file) : 0;
+  }
+
+  size_t print(const String& str) {
+    return write(reinterpret_cast<const uint8_t *>(str.c_str()), str.length());
+  }
+
+  size_t println(const String& str) {
+    return print(str) + write('\n');
+  }
+
+  int read() {
+    return _file ? fgetc(_file) : -1;
+  }
+
+  size_t read(uint8_t *buf, size_t size) {
+    return _file ? fread(buf, 1, size, _file) : 0;
+  }
+
+  int peek() {
+    if (!_file) { return -1; }
+    const int c = fgetc(_file);
+
+    if (c != EOF) { ungetc(c, _file); }
+    return c;
+  }
+
+  int available() {
+    return static_cast<int>(size() - position());
+  }
+
+  void flush() {
+    if (_file) { fflush(_file); }
+  }
+
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+    return _file && (fseek(_file, pos, mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END)) == 0);
+  }
+
+  size_t position() const {
+    return _file ? ftell(_file) : 0;
+  }
+
+  size_t size() const {
+    if (!_file) { return 0; }
+    const long pos = ftell(_file);
+
+    fseek(_file, 0, SEEK_END);
+    const long res = ftell(_file);
+
+    fseek(_file, pos, SEEK_SET);
+    return res;
+  }
+
+  void close() {
+    if (_file) {
+      fclose(_file);
+      _file = nullptr;
+    }
+  }
+
+  const char* name() const {
+    return _name.c_str();
+  }
+
+  operator bool() const {
+    return _file != nullptr;
+  }
+
+private:
+
+  FILE  *_file = nullptr;
+  String _name;
+};
+
+class FS {
+public:
+
+  File open(const String& path, const char *mode) {
+    return File(fopen(path.c_str(), openMode(mode)), path.c_str());
+  }
+
+  bool exists(const String& path) {
+    FILE *f = fopen(path.c_str(), "rb");
+
+    if (f) { fclose(f); }
+    return f != nullptr;
+  }
+
+  bool remove(const String& path) {
+    return ::remove(path.c_str()) == 0;
+  }
+
+  bool rename(const String& pathFrom, const String& pathTo) {
+    return ::rename(pathFrom.c_str(), pathTo.c_str()) == 0;
+  }
+
+private:
+
+  static const char* openMode(const char *mode) {
+    if (strcmp(mode, "w") == 0) { return "wb"; }
+    if (strcmp(mode, "a") == 0) { return "ab"; }
+    if (strcmp(mode, "r+") == 0) { return "r+b"; }
+    return "rb";
+  }
+};
+} // namespace fs
+
+extern fs::FS SPIFFS;
+
+#endif // HOST_SHIM_FS_H
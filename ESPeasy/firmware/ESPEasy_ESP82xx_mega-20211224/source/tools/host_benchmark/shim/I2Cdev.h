@@ -0,0 +1,7 @@
+#ifndef HOST_SHIM_I2CDEV_H
+#define HOST_SHIM_I2CDEV_H
+
+// Only the type is needed to build the host benchmark.
+class I2Cdev {};
+
+#endif // HOST_SHIM_I2CDEV_H
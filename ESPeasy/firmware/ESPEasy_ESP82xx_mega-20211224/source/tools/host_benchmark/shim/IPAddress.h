@@ -0,0 +1,49 @@
+#ifndef HOST_SHIM_IPADDRESS_H
+#define HOST_SHIM_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+
+  IPAddress() {}
+
+  IPAddress(uint8_t first_octet, uint8_t second_octet, uint8_t third_octet, uint8_t fourth_octet) {
+    _address[0] = first_octet;
+    _address[1] = second_octet;
+    _address[2] = third_octet;
+    _address[3] = fourth_octet;
+  }
+
+  IPAddress(uint32_t address) {
+    memcpy(_address, &address, sizeof(_address));
+  }
+
+  operator uint32_t() const {
+    uint32_t res;
+
+    memcpy(&res, _address, sizeof(res));
+    return res;
+  }
+
+  uint8_t operator[](int index) const {
+    return _address[index];
+  }
+
+  uint8_t& operator[](int index) {
+    return _address[index];
+  }
+
+  String toString() const {
+    char buf[16];
+
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+    return String(buf);
+  }
+
+private:
+
+  uint8_t _address[4] = { 0 };
+};
+
+#endif // HOST_SHIM_IPADDRESS_H
@@ -0,0 +1,6 @@
+#ifndef HOST_SHIM_SPI_H
+#define HOST_SHIM_SPI_H
+
+// Not used in the host benchmark, only needed by ESPEasy_common.h
+
+#endif // HOST_SHIM_SPI_H
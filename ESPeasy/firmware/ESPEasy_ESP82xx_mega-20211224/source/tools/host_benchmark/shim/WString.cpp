@@ -0,0 +1,190 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <strings.h>
+
+const String emptyString;
+
+namespace {
+std::string toBase(unsigned long long value, unsigned char base, bool negative) {
+  if ((base < 2) || (base > 36)) { base = 10; }
+  char buf[72];
+  char *p = buf + sizeof(buf);
+
+  *--p = 0;
+
+  do {
+    const unsigned digit = value % base;
+    *--p   = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value != 0);
+
+  if (negative) { *--p = '-'; }
+  return p;
+}
+
+std::string fromDouble(double value, unsigned char decimalPlaces) {
+  char buf[64];
+
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  return buf;
+}
+}
+
+String::String(unsigned char value, unsigned char base) : _s(toBase(value, base, false)) {}
+
+String::String(int value, unsigned char base)
+  : _s((base == 10) ? toBase(value < 0 ? -static_cast<long long>(value) : value, 10, value < 0)
+                    : toBase(static_cast<unsigned int>(value), base, false)) {}
+
+String::String(unsigned int value, unsigned char base) : _s(toBase(value, base, false)) {}
+
+String::String(long value, unsigned char base)
+  : _s((base == 10) ? toBase(value < 0 ? -static_cast<long long>(value) : value, 10, value < 0)
+                    : toBase(static_cast<unsigned long>(value), base, false)) {}
+
+String::String(unsigned long value, unsigned char base) : _s(toBase(value, base, false)) {}
+
+String::String(long long value) : _s(std::to_string(value)) {}
+
+String::String(unsigned long long value) : _s(std::to_string(value)) {}
+
+String::String(float value, unsigned char decimalPlaces) : _s(fromDouble(value, decimalPlaces)) {}
+
+String::String(double value, unsigned char decimalPlaces) : _s(fromDouble(value, decimalPlaces)) {}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  return (_s.length() == s._s.length()) && (strcasecmp(_s.c_str(), s._s.c_str()) == 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset + prefix._s.length() > _s.length()) { return false; }
+  return _s.compare(offset, prefix._s.length(), prefix._s) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix._s.length() > _s.length()) { return false; }
+  return _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0;
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy_writable_char;
+
+  if (index >= _s.length()) {
+    dummy_writable_char = 0;
+    return dummy_writable_char;
+  }
+  return _s[index];
+}
+
+void String::toCharArray(char *buf, unsigned int bufsize, unsigned int index) const {
+  if ((bufsize == 0) || (buf == nullptr)) { return; }
+
+  if (index >= _s.length()) {
+    buf[0] = 0;
+    return;
+  }
+  unsigned int n = bufsize - 1;
+
+  if (n > _s.length() - index) { n = _s.length() - index; }
+  memcpy(buf, _s.c_str() + index, n);
+  buf[n] = 0;
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  const size_t pos = _s.find(ch, fromIndex);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  if (fromIndex >= _s.length()) { return -1; }
+  const size_t pos = _s.find(str._s, fromIndex);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char ch) const {
+  const size_t pos = _s.rfind(ch);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(char ch, unsigned int fromIndex) const {
+  const size_t pos = _s.rfind(ch, fromIndex);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str) const {
+  const size_t pos = _s.rfind(str._s);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::lastIndexOf(const String& str, unsigned int fromIndex) const {
+  const size_t pos = _s.rfind(str._s, fromIndex);
+
+  return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    const unsigned int tmp = endIndex;
+    endIndex   = beginIndex;
+    beginIndex = tmp;
+  }
+  String res;
+
+  if (beginIndex >= _s.length()) { return res; }
+
+  if (endIndex > _s.length()) { endIndex = _s.length(); }
+  res._s.assign(_s, beginIndex, endIndex - beginIndex);
+  return res;
+}
+
+void String::replace(char find, char replace) {
+  for (char& c : _s) {
+    if (c == find) { c = replace; }
+  }
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (find._s.empty()) { return; }
+  size_t pos = 0;
+
+  while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+    _s.replace(pos, find._s.length(), replace._s);
+    pos += replace._s.length();
+  }
+}
+
+void String::remove(unsigned int index) {
+  if (index < _s.length()) { _s.erase(index); }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index < _s.length()) { _s.erase(index, count); }
+}
+
+void String::toLowerCase() {
+  for (char& c : _s) { c = static_cast<char>(tolower(static_cast<unsigned char>(c))); }
+}
+
+void String::toUpperCase() {
+  for (char& c : _s) { c = static_cast<char>(toupper(static_cast<unsigned char>(c))); }
+}
+
+void String::trim() {
+  const size_t first = _s.find_first_not_of(" \t\r\n\f\v");
+
+  if (first == std::string::npos) {
+    _s.clear();
+    return;
+  }
+  const size_t last = _s.find_last_not_of(" \t\r\n\f\v");
+
+  _s.erase(last + 1);
+  _s.erase(0, first);
+}
@@ -0,0 +1,222 @@
+#ifndef HOST_SHIM_WSTRING_H
+#define HOST_SHIM_WSTRING_H
+
+// Host (Linux) version of the Arduino String class.
+// Only the part of the API used by the sources built in the host benchmark.
+// Storage is a std::string, so allocations are those of the host C++ library
+// (small string optimization of 15 chars, ESP8266 core: 11 chars).
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+class __FlashStringHelper;
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper *>(pstr_pointer))
+#define F(string_literal)   (FPSTR(string_literal))
+
+class String {
+public:
+
+  String() {}
+
+  String(const char *cstr) {
+    if (cstr != nullptr) { _s = cstr; }
+  }
+
+  String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+  String(const String& str)     = default;
+  String(String&& str) noexcept = default;
+
+  explicit String(char c) : _s(1, c) {}
+
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value);
+  explicit String(unsigned long long value);
+  explicit String(float value, unsigned char decimalPlaces = 2);
+  explicit String(double value, unsigned char decimalPlaces = 2);
+
+  String& operator=(const String& rhs) = default;
+  String& operator=(String&& rhs)      = default;
+
+  String& operator=(const char *cstr) {
+    if (cstr == nullptr) { _s.clear(); } else { _s = cstr; }
+    return *this;
+  }
+
+  String& operator=(const __FlashStringHelper *str) {
+    return *this = reinterpret_cast<const char *>(str);
+  }
+
+  String& operator=(char c) {
+    _s.assign(1, c);
+    return *this;
+  }
+
+  // Numerical values, like the ESP8266 core
+  String& operator=(int value)           { return *this = String(value); }
+  String& operator=(unsigned int value)  { return *this = String(value); }
+  String& operator=(long value)          { return *this = String(value); }
+  String& operator=(unsigned long value) { return *this = String(value); }
+  String& operator=(float value)         { return *this = String(value); }
+  String& operator=(double value)        { return *this = String(value); }
+
+  bool reserve(unsigned int size) {
+    _s.reserve(size);
+    return true;
+  }
+
+  unsigned int length() const {
+    return _s.length();
+  }
+
+  bool isEmpty() const {
+    return _s.empty();
+  }
+
+  const char* c_str() const {
+    return _s.c_str();
+  }
+
+  char* begin() {
+    return &_s[0];
+  }
+
+  char* end() {
+    return &_s[0] + _s.length();
+  }
+
+  const char* begin() const {
+    return c_str();
+  }
+
+  const char* end() const {
+    return c_str() + _s.length();
+  }
+
+  // concatenate
+  bool concat(const String& str)            { _s += str._s; return true; }
+  bool concat(const char *cstr)             { if (cstr != nullptr) { _s += cstr; } return true; }
+  bool concat(const char *cstr, unsigned int length) { _s.append(cstr, length); return true; }
+  bool concat(const __FlashStringHelper *str) { return concat(reinterpret_cast<const char *>(str)); }
+  bool concat(char c)                       { _s += c; return true; }
+  bool concat(unsigned char num)            { return concat(String(num)); }
+  bool concat(int num)                      { return concat(String(num)); }
+  bool concat(unsigned int num)             { return concat(String(num)); }
+  bool concat(long num)                     { return concat(String(num)); }
+  bool concat(unsigned long num)            { return concat(String(num)); }
+  bool concat(long long num)                { return concat(String(num)); }
+  bool concat(unsigned long long num)       { return concat(String(num)); }
+  bool concat(float num)                    { return concat(String(num)); }
+  bool concat(double num)                   { return concat(String(num)); }
+
+  template<typename T>
+  String& operator+=(const T& rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  // comparison
+  int compareTo(const String& s) const { return _s.compare(s._s); }
+  bool equals(const String& s) const   { return _s == s._s; }
+  bool equals(const char *cstr) const  { return _s == (cstr == nullptr ? "" : cstr); }
+  bool equalsIgnoreCase(const String& s) const;
+  bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+  bool startsWith(const String& prefix, unsigned int offset) const;
+  bool endsWith(const String& suffix) const;
+
+  bool operator==(const String& rhs) const { return equals(rhs); }
+  bool operator==(const char *cstr) const  { return equals(cstr); }
+  bool operator!=(const String& rhs) const { return !equals(rhs); }
+  bool operator!=(const char *cstr) const  { return !equals(cstr); }
+  bool operator<(const String& rhs) const  { return compareTo(rhs) < 0; }
+  bool operator>(const String& rhs) const  { return compareTo(rhs) > 0; }
+
+  // character access
+  char charAt(unsigned int index) const {
+    return index < _s.length() ? _s[index] : 0;
+  }
+
+  void setCharAt(unsigned int index, char c) {
+    if (index < _s.length()) { _s[index] = c; }
+  }
+
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index);
+
+  void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const;
+
+  // search
+  int indexOf(char ch, unsigned int fromIndex = 0) const;
+  int indexOf(const String& str, unsigned int fromIndex = 0) const;
+  int lastIndexOf(char ch) const;
+  int lastIndexOf(char ch, unsigned int fromIndex) const;
+  int lastIndexOf(const String& str) const;
+  int lastIndexOf(const String& str, unsigned int fromIndex) const;
+
+  String substring(unsigned int beginIndex) const {
+    return substring(beginIndex, _s.length());
+  }
+
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  // modification
+  void replace(char find, char replace);
+  void replace(const String& find, const String& replace);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  void clear() { _s.clear(); }
+
+  // parsing/conversion
+  long   toInt() const    { return atol(_s.c_str()); }
+  float  toFloat() const  { return static_cast<float>(toDouble()); }
+  double toDouble() const { return atof(_s.c_str()); }
+
+private:
+
+  std::string _s;
+};
+
+extern const String emptyString;
+
+class StringSumHelper : public String {
+public:
+
+  using String::String;
+
+  StringSumHelper(const String& s) : String(s) {}
+};
+
+template<typename T>
+StringSumHelper operator+(const String& lhs, const T& rhs) {
+  StringSumHelper res(lhs);
+
+  res.concat(rhs);
+  return res;
+}
+
+inline StringSumHelper operator+(char lhs, const String& rhs) {
+  StringSumHelper res(lhs);
+
+  res.concat(rhs);
+  return res;
+}
+
+inline StringSumHelper operator+(const char *lhs, const String& rhs) {
+  StringSumHelper res(lhs);
+
+  res.concat(rhs);
+  return res;
+}
+
+#endif // HOST_SHIM_WSTRING_H
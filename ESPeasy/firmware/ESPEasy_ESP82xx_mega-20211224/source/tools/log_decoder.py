@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# Decode a log dump of an ESPEasy node.
+#
+# Capture the dump via the web interface, e.g.:
+#   curl http://<node>/logdump > log.txt
+#   python3 tools/log_decoder.py log.txt
+#
+# Each line is a hex encoded log record:
+#   [length (2 bytes)][log level][timestamp (4 bytes)][message]
+# When bit 7 of the log level is set, the message is a format ID plus arguments
+# (see src/src/DataStructs/LogFormat.h), which is formatted here.
+# The format strings are read from LogFormat.h, so use the source of the same build.
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+DEFERRED_FORMAT = 0x80
+
+LOG_LEVELS = {
+    1: "Error",
+    2: "Info",
+    3: "Debug",
+    4: "Debug More",
+    9: "Debug dev",
+}
+
+DEFAULT_FORMAT_HEADER = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    "..", "src", "src", "DataStructs", "LogFormat.h")
+
+
+def read_formats(header_file):
+    """Return the format strings in LOG_FORMAT_LIST, the index is the format ID."""
+    with open(header_file, "r") as f:
+        content = f.read()
+    start = content.find("#define LOG_FORMAT_LIST")
+    if start < 0:
+        raise ValueError("LOG_FORMAT_LIST not found in " + header_file)
+    # The list ends at the first line not ending with a backslash
+    lines = []
+    for line in content[start:].splitlines():
+        lines.append(line)
+        if not line.rstrip().endswith("\\"):
+            break
+    entries = re.findall(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', "\n".join(lines))
+    return [bytes(fmt, "utf-8").decode("unicode_escape") for _, fmt in entries]
+
+
+class ArgReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 2  # Skip format ID
+
+    def next(self):
+        """Return (type, bytes) or None when no argument is left."""
+        if self.pos >= len(self.data):
+            return None
+        arg_type = chr(self.data[self.pos])
+        self.pos += 1
+        if arg_type in "udfI":
+            size = 4
+        elif arg_type == "M":
+            size = 6
+        elif arg_type == "s":
+            if self.pos >= len(self.data):
+                return None
+            size = self.data[self.pos]
+            self.pos += 1
+        else:
+            self.pos = len(self.data)
+            return None
+        if self.pos + size > len(self.data):
+            self.pos = len(self.data)
+            return None
+        value = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return arg_type, value
+
+
+def format_arg(arg_type, value, conversion, precision):
+    if arg_type == "u":
+        number = struct.unpack("<I", value)[0]
+        return "%x" % number if conversion == "x" else str(number)
+    if arg_type == "d":
+        return str(struct.unpack("<i", value)[0])
+    if arg_type == "f":
+        return "%.*f" % (precision, struct.unpack("<f", value)[0])
+    if arg_type == "s":
+        return value.decode("utf-8", "replace")
+    if arg_type == "I":
+        return ".".join(str(b) for b in value)
+    if arg_type == "M":
+        return ":".join("%02X" % b for b in value)
+    return "?"
+
+
+SPECIFIER = re.compile(r"%(%|(0?)(\d*)(?:\.(\d*))?(.))")
+
+
+def format_message(formats, data):
+    if len(data) < 2:
+        return ""
+    format_id = data[0] | (data[1] << 8)
+    if format_id >= len(formats):
+        return "Unknown log format %d" % format_id
+    reader = ArgReader(data)
+
+    def replace(match):
+        if match.group(1) == "%":
+            return "%"
+        zero_pad, width, precision, conversion = match.group(2, 3, 4, 5)
+        arg = reader.next()
+        if arg is None:
+            return "?"
+        value = format_arg(arg[0], arg[1], conversion, int(precision or 2))
+        return value.rjust(int(width or 0), "0" if zero_pad else " ")
+
+    return SPECIFIER.sub(replace, formats[format_id])
+
+
+def decode_record(formats, record):
+    if len(record) < 7:
+        raise ValueError("record too short")
+    length, level, timestamp = struct.unpack("<HBI", record[:7])
+    message = record[7:7 + length]
+    if level & DEFERRED_FORMAT:
+        level &= ~DEFERRED_FORMAT
+        text = format_message(formats, message)
+    else:
+        text = message.decode("utf-8", "replace")
+    return timestamp, LOG_LEVELS.get(level, str(level)), text
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an ESPEasy log dump (/logdump)")
+    parser.add_argument("dump", nargs="?", default="-", help="log dump file, default stdin")
+    parser.add_argument("--formats", default=DEFAULT_FORMAT_HEADER,
+                        help="LogFormat.h of the build which created the dump")
+    args = parser.parse_args()
+
+    formats = read_formats(args.formats)
+    source = sys.stdin if args.dump == "-" else open(args.dump, "r")
+    with source:
+        for line in source:
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                timestamp, level, text = decode_record(formats, bytes.fromhex(line))
+            except ValueError as e:
+                print("Invalid record (%s): %s" % (e, line), file=sys.stderr)
+                continue
+            print("%d : %s : %s" % (timestamp, level, text))
+
+
+if __name__ == "__main__":
+    main()